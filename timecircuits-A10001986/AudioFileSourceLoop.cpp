@@ -16,10 +16,11 @@
 
 AudioFileSourceLoop::~AudioFileSourceLoop()
 {
+    stopReadAhead();
     if(f) f.close();
 }
 
-uint32_t AudioFileSourceLoop::read(void *data, uint32_t len)
+uint32_t AudioFileSourceLoop::rawRead(void *data, uint32_t len)
 {
     uint32_t glen = 0, rlen = len, g;
     
@@ -27,7 +28,8 @@ uint32_t AudioFileSourceLoop::read(void *data, uint32_t len)
     case 1:
         glen = f.read((uint8_t *)data, len);
         if(!doPlayLoop || glen == len) return glen;
-        seek(startPos, SEEK_SET);
+        f.seek(startPos);
+        lastWrap = glen;
         glen += f.read(((uint8_t *)data) + glen, len - glen);
         break;
     case 2:
@@ -48,13 +50,230 @@ uint32_t AudioFileSourceLoop::read(void *data, uint32_t len)
     return glen;
 }
 
+uint32_t AudioFileSourceLoop::read(void *data, uint32_t len)
+{
+    uint32_t glen = 0, lim, n, t0;
+    bool     waited;
+
+    if(!raActive) return rawRead(data, len);
+
+    while(glen < len && !raEnd) {
+        waited = false;
+        if(!raHave && xSemaphoreTake(raReady, 0) != pdTRUE) {
+            t0 = micros();
+            xTaskNotifyGive(raTask);
+            if(xSemaphoreTake(raReady, pdMS_TO_TICKS(AFSL_WAIT_MS)) != pdTRUE) {
+                // Reader busy elsewhere: Fill it ourselves. Buffers
+                // are filled in order, so raFill is raUse.
+                if(fillNext()) raStats.directFills++;
+                if(xSemaphoreTake(raReady, 0) != pdTRUE) {
+                    raEnd = true;
+                    break;
+                }
+            }
+            raStats.stalls++;
+            raStats.stallUs += micros() - t0;
+            waited = true;
+        }
+        raHave = true;
+        if(!raLen[raUse]) {
+            raEnd = true;       // EOF
+            break;
+        }
+        if(raSlow[raUse]) {
+            if(!waited) raStats.avoided++;
+            raSlow[raUse] = false;
+        }
+        // Looping disabled after buffer was read: End at wrap
+        lim = raLen[raUse];
+        if(raWrap[raUse] >= 0 && !doPlayLoop) {
+            lim = raWrap[raUse];
+            if(raOff >= lim) {
+                raEnd = true;
+                break;
+            }
+        }
+        n = lim - raOff;
+        if(n > len - glen) n = len - glen;
+        memcpy((uint8_t *)data + glen, raBuf[raUse] + raOff, n);
+        raOff += n;
+        glen += n;
+        if(raOff >= lim) {
+            if(lim < raLen[raUse]) raEnd = true;
+            raOff = 0;
+            raHave = false;
+            raFilled[raUse] = false;
+            if(++raUse >= raNum) raUse = 0;
+            xTaskNotifyGive(raTask);
+        }
+    }
+
+    return glen;
+}
+
+uint32_t AudioFileSourceLoop::getPos()
+{
+    uint32_t pos;
+
+    if(!raActive) return rawPos();
+
+    if(!raHave && xSemaphoreTake(raReady, 0) == pdTRUE) raHave = true;
+    if(raHave) return raPos[raUse] + raOff;
+
+    // Nothing read ahead: File position is ours, but the
+    // reader may be moving it
+    xSemaphoreTake(raLock, portMAX_DELAY);
+    pos = rawPos();
+    xSemaphoreGive(raLock);
+
+    return pos;
+}
+
 bool AudioFileSourceLoop::seek(int32_t pos, int dir)
 {
+    bool ret = false, ra = raActive;
+    
     if(!f) return false;
-    if(dir == SEEK_SET)      return f.seek(pos);
-    else if(dir == SEEK_CUR) return f.seek(f.position() + pos);
-    else if(dir == SEEK_END) return f.seek(f.size() + pos);
-    return false;
+    if(dir == SEEK_CUR) {
+        pos += getPos();
+        dir = SEEK_SET;
+    }
+    if(ra) stopReadAhead();
+    if(dir == SEEK_SET)      ret = f.seek(pos);
+    else if(dir == SEEK_END) ret = f.seek(f.size() + pos);
+    if(ra) startReadAhead();
+    return ret;
+}
+
+/*
+ * Read-ahead
+ * 
+ * A reader task fills "bufs" buffers of "size" bytes ahead of 
+ * the decoder. Started after playback setup (ID3 skip, etc); 
+ * stopped by seek() and close().
+ */
+
+AudioFileSourceLoop *AudioFileSourceLoop::raSrc[AFSL_MAXSRC];
+int                 AudioFileSourceLoop::raSrcNum = 0;
+TaskHandle_t        AudioFileSourceLoop::raTask = NULL;
+afslStats           AudioFileSourceLoop::raStats = { 0 };
+
+bool AudioFileSourceLoop::setReadAhead(int bufs, uint32_t size)
+{
+    if(raNum || bufs < 2 || bufs > AFSL_MAXBUFS || raSrcNum >= AFSL_MAXSRC)
+        return false;
+
+    // Multiple of SD sector size
+    size = (size + 511) & ~511;
+    
+    if(!(raLock = xSemaphoreCreateMutex()))
+        return false;
+    if(!(raReady = xSemaphoreCreateCounting(bufs, 0)))
+        return false;
+
+    for(int i = 0; i < bufs; i++) {
+        if(!(raBuf[i] = (uint8_t *)malloc(size))) {
+            while(i--) free(raBuf[i]);
+            return false;
+        }
+    }
+
+    raSize = size;
+    raNum = bufs;
+    raSrc[raSrcNum++] = this;
+    
+    return true;
+}
+
+void AudioFileSourceLoop::startReadAhead()
+{
+    if(!raNum || !raTask || !f) return;
+
+    xSemaphoreTake(raLock, portMAX_DELAY);
+    for(int i = 0; i < raNum; i++) {
+        raFilled[i] = false;
+    }
+    while(xSemaphoreTake(raReady, 0) == pdTRUE) { }
+    raHave = false;
+    raFill = raUse = 0;
+    raOff = 0;
+    raEof = raEnd = false;
+    raAlign = true;
+    raActive = true;
+    xSemaphoreGive(raLock);
+
+    xTaskNotifyGive(raTask);
+}
+
+void AudioFileSourceLoop::stopReadAhead()
+{
+    if(!raActive) return;
+
+    // Wait for a read in progress
+    xSemaphoreTake(raLock, portMAX_DELAY);
+    raActive = false;
+    xSemaphoreGive(raLock);
+}
+
+bool AudioFileSourceLoop::fillNext()
+{
+    bool     did = false;
+    uint32_t size, t0;
+    int      i;
+
+    xSemaphoreTake(raLock, portMAX_DELAY);
+    
+    if(raActive && !raEof && !raFilled[(i = raFill)]) {
+        size = raSize;
+        // First read: Align subsequent reads to sector boundary
+        if(raAlign) {
+            if(ftype == 1) size -= f.position() & 511;
+            raAlign = false;
+        }
+        raPos[i] = rawPos();
+        lastWrap = -1;
+        t0 = micros();
+        raLen[i] = rawRead(raBuf[i], size);
+        if(micros() - t0 > AFSL_SLOW_US) {
+            raSlow[i] = true;
+            raStats.slowFills++;
+        } else {
+            raSlow[i] = false;
+        }
+        raWrap[i] = lastWrap;
+        if(!raLen[i]) raEof = true;
+        raFilled[i] = true;
+        if(++raFill >= raNum) raFill = 0;
+        raStats.fills++;
+        did = true;
+        xSemaphoreGive(raReady);
+    }
+    
+    xSemaphoreGive(raLock);
+
+    return did;
+}
+
+void AudioFileSourceLoop::readerTask(void *arg)
+{
+    bool did;
+    
+    for(;;) {
+        do {
+            did = false;
+            for(int i = 0; i < raSrcNum; i++) {
+                if(raSrc[i]->fillNext()) did = true;
+            }
+        } while(did);
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(50));
+    }
+}
+
+bool AudioFileSourceLoop::startReader(int core, int prio)
+{
+    if(raTask) return true;
+
+    return (xTaskCreatePinnedToCore(readerTask, "aread", 3072, NULL, prio, &raTask, core) == pdPASS);
 }
 
 bool AudioFileSourceLoop::open_c(const char *filename, const int16_t *segs)
@@ -124,6 +343,7 @@ AudioFileSourceSDLoop::AudioFileSourceSDLoop(const char *filename)
 
 bool AudioFileSourceSDLoop::open(const char *filename)
 {
+    stopReadAhead();
     f = SD.open(filename, FILE_READ);
     ftype = 1;
     return f;
@@ -144,6 +364,7 @@ AudioFileSourceFSLoop::AudioFileSourceFSLoop(const char *filename)
 
 bool AudioFileSourceFSLoop::open(const char *filename)
 {
+    stopReadAhead();
     f = LittleFS.open(filename, FILE_READ);
     ftype = 1;
     return f;
@@ -16,6 +16,20 @@
 #include <SD.h>
 #include <LittleFS.h>
 
+#define AFSL_MAXBUFS  4       // Max read-ahead buffers per source
+#define AFSL_MAXSRC   4       // Max sources with read-ahead
+#define AFSL_SLOW_US  5000    // Reads taking longer count as "slow"
+#define AFSL_WAIT_MS  20      // Wait for reader task, then read directly
+
+typedef struct {
+    uint32_t fills;           // Buffers read ahead
+    uint32_t slowFills;       // ... of which were slow reads
+    uint32_t avoided;         // Slow reads the decoder did not wait for
+    uint32_t stalls;          // Decoder had to wait for data
+    uint32_t stallUs;         // Total time waited
+    uint32_t directFills;     // Read by decoder after reader did not deliver
+} afslStats;
+
 class AudioFileSourceLoop : public AudioFileSource
 {
   public:
@@ -26,14 +40,20 @@ class AudioFileSourceLoop : public AudioFileSource
     bool open_c(const char *filename, const int16_t *segs);
     uint32_t read(void *data, uint32_t len) override;
     bool seek(int32_t pos, int dir) override;
-    bool close() override                    { if(toc) { free(toc); toc = NULL; } f.close(); return true; }
+    bool close() override                    { stopReadAhead(); if(toc) { free(toc); toc = NULL; } f.close(); return true; }
     bool isOpen() override                   { return f ? true : false; }
     uint32_t getSize() override              { return f ? f.size() : 0; }
-    uint32_t getPos() override               { return f ? ((ftype == 2) ? (csegOLen - csegLen) : f.position()) : 0; }
+    uint32_t getPos() override;
     void setStartPos(int32_t newStartPos)    { startPos = newStartPos; }
     void setPlayLoop(bool playLoop)          { doPlayLoop = playLoop; }
     uint32_t (*c)(uint8_t *, uint32_t, uint32_t) = NULL;
 
+    bool setReadAhead(int bufs, uint32_t size);
+    void startReadAhead();
+    void stopReadAhead();
+    static bool startReader(int core, int prio);
+    static void getStats(afslStats *st)      { *st = raStats; }
+
   protected:
     File    f;
     int32_t startPos = 0;
@@ -41,9 +61,39 @@ class AudioFileSourceLoop : public AudioFileSource
     int     ftype = 0;
     
   private:
+    uint32_t rawRead(void *data, uint32_t len);
+    uint32_t rawPos()                        { return f ? ((ftype == 2) ? (csegOLen - csegLen) : f.position()) : 0; }
     bool     seekNext();
     uint32_t c_read(uint8_t *buf, uint32_t len);
 
+    bool     fillNext();
+    static void readerTask(void *arg);
+
+    // Read-ahead; buffers are filled by reader task, consumed by read().
+    // raReady counts filled buffers; taking it before using a buffer
+    // also makes the reader's writes to raLen/raPos/... visible.
+    int               raNum = 0;
+    uint32_t          raSize = 0;
+    uint8_t           *raBuf[AFSL_MAXBUFS];
+    volatile uint32_t raLen[AFSL_MAXBUFS];
+    volatile bool     raFilled[AFSL_MAXBUFS];
+    uint32_t          raPos[AFSL_MAXBUFS];
+    int32_t           raWrap[AFSL_MAXBUFS];   // Offset of loop wrap, or -1
+    bool              raSlow[AFSL_MAXBUFS];
+    int               raFill = 0, raUse = 0;
+    uint32_t          raOff = 0;
+    volatile bool     raActive = false;
+    bool              raHave = false;         // Holds raReady for raUse
+    bool              raEof = false, raEnd = false, raAlign = false;
+    int32_t           lastWrap = -1;
+    SemaphoreHandle_t raLock = NULL;
+    SemaphoreHandle_t raReady = NULL;
+
+    static AudioFileSourceLoop *raSrc[AFSL_MAXSRC];
+    static int                 raSrcNum;
+    static TaskHandle_t        raTask;
+    static afslStats           raStats;
+
     int32_t        *toc = NULL;
     int            segIdx = 0;
     uint32_t       csegLen = 0, csegOLen = 0;
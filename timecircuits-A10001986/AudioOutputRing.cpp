@@ -0,0 +1,250 @@
+/*
+ * AudioOutputRing
+ * PCM ring buffer between AudioGenerator and AudioOutputI2S
+ * Generator (producer) and I2S pump task (consumer) run
+ * independently; control is passed to the pump through a
+ * command queue, tagged with the ring position it applies to.
+ * Discard bypasses the queue and is executed at once.
+ *
+ * Thomas Winischhofer (A10001986), 2026
+ *
+ */
+
+#include "tc_global.h"
+#include "AudioOutputRing.h"
+
+#define AOR_BEGIN   1   // (Re)start I2S at rate "val"
+#define AOR_RATE    2   // Change sample rate to "val"
+#define AOR_EOS     3   // Producer done, ring runs empty legitimately
+#define AOR_STOP    4   // Stop I2S
+#define AOR_MARK    6   // Track change: Measure silence until next sample
+
+typedef struct {
+    uint32_t pos;
+    uint32_t val;
+    uint8_t  cmd;
+} aorCmd;
+
+AudioOutputRing::AudioOutputRing(AudioOutputI2S *sink)
+{
+    _sink = sink;
+    bps = 16;
+    channels = 2;
+    hertz = 44100;
+    SetGain(1.0);
+}
+
+bool AudioOutputRing::start(int core, int prio)
+{
+    if(!(_cmdq = xQueueCreate(16, sizeof(aorCmd))) ||
+       !(_discq = xQueueCreate(1, sizeof(uint32_t))))
+        return false;
+
+    return (xTaskCreatePinnedToCore(pumpTask, "i2spump", 2048, this, prio, NULL, core) == pdPASS);
+}
+
+void AudioOutputRing::post(uint8_t cmd, uint32_t val)
+{
+    aorCmd c = { .pos = _wr, .val = val, .cmd = cmd };
+
+    xQueueSend(_cmdq, &c, pdMS_TO_TICKS(100));
+}
+
+bool AudioOutputRing::SetRate(int hz)
+{
+    hertz = hz;
+    post(AOR_RATE, hz);
+    return true;
+}
+
+bool AudioOutputRing::begin()
+{
+    post(AOR_BEGIN, hertz);
+    return true;
+}
+
+bool AudioOutputRing::stop()
+{
+    // Samples in the ring are played before I2S is stopped;
+    // call discard() first to cut them.
+    post(AOR_STOP);
+    return true;
+}
+
+void AudioOutputRing::endOfStream()
+{
+    post(AOR_EOS);
+}
+
+// Drop everything written so far. Commands queued before are due
+// at once then, as the pump skips to their positions.
+void AudioOutputRing::discard()
+{
+    uint32_t pos = _wr;
+
+    xQueueOverwrite(_discq, &pos);
+}
+
+void AudioOutputRing::markTrack()
+{
+    post(AOR_MARK);
+}
+
+size_t AudioOutputRing::ConsumeSample(int16_t msL, int16_t msR)
+{
+    uint32_t wr = _wr;
+
+    if(_quota <= 0 || wr - _rd >= AOR_FRAMES)
+        return 0;
+
+    // Same as AudioOutputI2S::ConsumeSample (TWESP32, AUTO_MONO)
+    if(channels == 1) msR = msL;
+
+    AmplifyL(msL);
+    _ring[wr & (AOR_FRAMES-1)] = ((uint32_t)AmplifyR(msR)) | (uint16_t)msL;
+
+    _wr = wr + 1;
+    _quota--;
+
+    return sizeof(uint32_t);
+}
+
+uint16_t AudioOutputRing::ConsumeSamples(const int16_t *sL, const int16_t *sR, int step, uint16_t count)
+{
+    uint32_t wr = _wr, idx, n, n1;
+
+    n = AOR_FRAMES - (wr - _rd);
+    if(n > count) n = count;
+    if((int)n > _quota) n = (_quota > 0) ? _quota : 0;
+    if(!n) return 0;
+
+    // At most two chunks: up to end of ring, then from start
+    idx = wr & (AOR_FRAMES-1);
+    n1 = AOR_FRAMES - idx;
+    if(n1 > n) n1 = n;
+    PackSamples(&_ring[idx], sL, sR, step, n1);
+    if(n > n1) {
+        PackSamples(&_ring[0], sL + n1 * step, sR + n1 * step, step, n - n1);
+    }
+
+    _wr = wr + n;
+    _quota -= n;
+
+    return n;
+}
+
+void AudioOutputRing::resetStats()
+{
+    _underruns = 0;
+    _minFill = AOR_FRAMES;
+    _maxFill = 0;
+    _maxLat = 0;
+    _maxGap = 0;
+}
+
+void AudioOutputRing::pumpTask(void *arg)
+{
+    ((AudioOutputRing *)arg)->pump();
+}
+
+void AudioOutputRing::pump()
+{
+    aorCmd   cmd;
+    bool     haveCmd;
+    uint32_t rd = _rd, wr, fill, n, idx, w, dpos;
+
+    for(;;) {
+
+        if(xQueueReceive(_discq, &dpos, 0) == pdTRUE) {
+            if((int32_t)(dpos - rd) > 0) _rd = rd = dpos;
+            _streaming = _awaitGap = false;
+        }
+
+        // Read _wr before peeking: A command posted after this
+        // point cannot refer to a position we are about to pass.
+        wr = _wr;
+        haveCmd = (xQueuePeek(_cmdq, &cmd, 0) == pdTRUE);
+
+        // Due when reached or skipped by a discard
+        if(haveCmd && (int32_t)(rd - cmd.pos) >= 0) {
+            xQueueReceive(_cmdq, &cmd, 0);
+            switch(cmd.cmd) {
+            case AOR_BEGIN:
+                _sink->SetRate(cmd.val);
+                _sink->begin();
+                _active = _awaitFirst = true;
+                _streaming = _starved = false;
+                break;
+            case AOR_RATE:
+                _sink->SetRate(cmd.val);
+                break;
+            case AOR_EOS:
+                _streaming = false;
+                break;
+            case AOR_STOP:
+                _sink->stop();
+                _active = _streaming = false;
+                break;
+            case AOR_MARK:
+                _gapFrom = _emptySince ? _emptySince : micros();
+                _awaitGap = true;
+                break;
+            }
+            continue;
+        }
+
+        fill = wr - rd;
+        n = haveCmd ? cmd.pos - rd : fill;
+
+        if(n) {
+
+            if(_active && !_streaming) {
+                _streaming = true;
+            } else if(_streaming) {
+                if(fill < _minFill) _minFill = fill;
+            }
+            if(fill > _maxFill) _maxFill = fill;
+            _starved = false;
+
+            idx = rd & (AOR_FRAMES-1);
+            if(n > AOR_BLOCK) n = AOR_BLOCK;
+            if(n > AOR_FRAMES - idx) n = AOR_FRAMES - idx;
+
+            // Blocks until DMA buffer is free. If I2S is not
+            // running, the data is dropped.
+            if((w = _sink->WriteFrames(&_ring[idx], n, pdMS_TO_TICKS(100)))) {
+                rd += w;
+                if(_awaitGap) {
+                    _lastGap = micros() - _gapFrom;
+                    if(_lastGap > _maxGap) _maxGap = _lastGap;
+                    _awaitGap = false;
+                }
+                _emptySince = 0;
+                if(_awaitFirst) {
+                    _lastLat = micros() - _trigUs;
+                    if(_lastLat > _maxLat) _maxLat = _lastLat;
+                    _awaitFirst = false;
+                }
+            } else if(!_active) {
+                rd += n;
+            }
+            _rd = rd;
+
+            if(_producer) xTaskNotifyGive(_producer);
+
+        } else {
+
+            if(!_emptySince) _emptySince = micros() | 1;
+
+            if(_streaming && !_starved) {
+                _underruns++;
+                _minFill = 0;
+                _starved = true;
+            }
+
+            // Wait for data or next command
+            xQueuePeek(_cmdq, &cmd, _active ? 1 : portMAX_DELAY);
+
+        }
+    }
+}
@@ -0,0 +1,93 @@
+/*
+ * AudioOutputRing
+ * PCM ring buffer between AudioGenerator and AudioOutputI2S
+ * Generator (producer) and I2S pump task (consumer) run
+ * independently; control is passed to the pump through a
+ * command queue, tagged with the ring position it applies to.
+ * Discard bypasses the queue and is executed at once.
+ *
+ * Thomas Winischhofer (A10001986), 2026
+ *
+ */
+
+#ifndef _AudioOutputRing_H
+#define _AudioOutputRing_H
+
+#include "src/ESP8266Audio/AudioOutput.h"
+#include "src/ESP8266Audio/AudioOutputI2S.h"
+
+#define AOR_FRAMES  2048    // Ring size in stereo frames (power of 2)
+#define AOR_BLOCK   64      // Frames per i2s_write (= DMA buffer length)
+
+class AudioOutputRing : public AudioOutput
+{
+  public:
+    AudioOutputRing(AudioOutputI2S *sink);
+
+    bool start(int core, int prio);
+    void setProducer(TaskHandle_t task)   { _producer = task; }
+
+    bool SetRate(int hz) override;
+    bool begin() override;
+    size_t ConsumeSample(int16_t sL, int16_t sR) override;
+    uint16_t ConsumeSamples(const int16_t *sL, const int16_t *sR, int step, uint16_t count) override;
+    bool stop() override;
+
+    void setQuota(int frames)             { _quota = frames; }
+    uint32_t getSpace()                   { return AOR_FRAMES - (_wr - _rd); }
+    void endOfStream();
+    void discard();
+
+    // Latency from trigger (play request) to first sample handed to I2S
+    void     setTrigger(uint32_t us)      { _trigUs = us; }
+    uint32_t getLastLatency()             { return _lastLat; }
+    uint32_t getMaxLatency()              { return _maxLat; }
+
+    // Silence at a track change: Call at the end of the old track's
+    // data; measured when the first sample after it is handed to I2S
+    void     markTrack();
+    uint32_t getLastGap()                 { return _lastGap; }
+    uint32_t getMaxGap()                  { return _maxGap; }
+
+    uint32_t getUnderruns()               { return _underruns; }
+    uint32_t getMinFill()                 { return _minFill; }
+    uint32_t getMaxFill()                 { return _maxFill; }
+    void     resetStats();
+
+  private:
+    static void pumpTask(void *arg);
+    void pump();
+    void post(uint8_t cmd, uint32_t val = 0);
+
+    AudioOutputI2S *_sink;
+
+    uint32_t _ring[AOR_FRAMES];
+    volatile uint32_t _wr = 0;          // Written by producer only
+    volatile uint32_t _rd = 0;          // Written by pump only
+    int      _quota = 0;
+
+    QueueHandle_t _cmdq = NULL;
+    QueueHandle_t _discq = NULL;        // Discard position (mailbox)
+    TaskHandle_t  _producer = NULL;
+
+    bool     _active = false;           // Between begin and stop (pump)
+    bool     _streaming = false;        // Data flowing, no end-of-stream yet
+    bool     _starved = false;
+
+    volatile uint32_t _underruns = 0;
+    volatile uint32_t _minFill = AOR_FRAMES;
+    volatile uint32_t _maxFill = 0;
+
+    volatile uint32_t _trigUs = 0;
+    bool     _awaitFirst = false;
+    volatile uint32_t _lastLat = 0;
+    volatile uint32_t _maxLat = 0;
+
+    uint32_t _emptySince = 0;           // Ring ran empty at (us; 0 = has data)
+    uint32_t _gapFrom = 0;
+    bool     _awaitGap = false;
+    volatile uint32_t _lastGap = 0;
+    volatile uint32_t _maxGap = 0;
+};
+
+#endif
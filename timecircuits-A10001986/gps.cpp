@@ -60,6 +60,7 @@
 
 #include <Arduino.h>
 #include <Wire.h>
+#include "i2cbus.h"
 #include "gps.h"
 
 #define GPS_MPH_PER_KNOT  1.15077945f
@@ -229,8 +230,8 @@ bool tcGPS::begin(int numTypes, int quickUpdates, int speedRate, void (*myDelay)
     for(int i = 0; i < numTypes*2; i += 2) {
 
         // Check for GPS module on i2c bus
-        Wire.beginTransmission(_addrArr[i]);
-        if(!(Wire.endTransmission())) {
+        i2cBus.beginTransmission(_addrArr[i]);
+        if(!(i2cBus.endTransmission())) {
 
             _address = _addrArr[i];
             _type = _addrArr[i+1];
@@ -238,11 +239,11 @@ bool tcGPS::begin(int numTypes, int quickUpdates, int speedRate, void (*myDelay)
             // Test reading the sensor
             switch(_type) {
             case GPST_MTK333X:
-                i2clen = Wire.requestFrom(_address, (uint8_t)8);
+                i2clen = i2cBus.requestFrom(_address, (uint8_t)8);
                 if(i2clen == 8) {
                     found = true;
                     for(int i = 0; i < 8; i++) {
-                        uint8_t testBuf = Wire.read();
+                        uint8_t testBuf = i2cBus.read();
                         // Bail if illegal characters returned
                         if(testBuf != 0x0a && testBuf != 0x0d && (testBuf < ' ' || testBuf > 0x7e)) {
                             found = false;
@@ -575,18 +576,18 @@ void tcGPS::requestVersion()
 
 void tcGPS::sendCommand(const char *prefix, const char *str)
 { 
-    Wire.beginTransmission(_address);
+    i2cBus.beginTransmission(_address);
     if(prefix) {
         for(int i = 0; i < strlen(prefix); i++) {
-            Wire.write((uint8_t)prefix[i]);
+            i2cBus.write((uint8_t)prefix[i]);
         }
     }
     for(int i = 0; i < strlen(str); i++) {
-        Wire.write((uint8_t)str[i]);
+        i2cBus.write((uint8_t)str[i]);
     }
-    Wire.write(0x0d);
-    Wire.write(0x0a);
-    Wire.endTransmission(true);
+    i2cBus.write(0x0d);
+    i2cBus.write(0x0a);
+    i2cBus.endTransmission(true);
     (*_customDelayFunc)(30);
 }
 
@@ -601,14 +602,14 @@ bool tcGPS::readAndParse(bool doDelay)
 
     switch(_type) {
     case GPST_MTK333X:
-        i2clen = Wire.requestFrom(_address, _lenArr[_lenIdx++]);
+        i2clen = i2cBus.requestFrom(_address, _lenArr[_lenIdx++]);
         _lenIdx &= _lenLimit;
     
         if(i2clen) {
     
             // Read i2c data to _buffer
             for(int i = 0; i < i2clen; i++) {
-                curr_char = Wire.read();
+                curr_char = i2cBus.read();
                 // Skip "empty data" (ie LF if not preceeded by CR)
                 if((curr_char != 0x0a) || (_last_char == 0x0d)) {
                      _buffer[buff_max++] = curr_char;
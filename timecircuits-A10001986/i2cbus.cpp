@@ -0,0 +1,245 @@
+/*
+ * -------------------------------------------------------------------
+ * CircuitSetup.us Time Circuits Display
+ * (C) 2022-2026 Thomas Winischhofer (A10001986)
+ * https://github.com/realA10001986/Time-Circuits-Display
+ * https://tcd.out-a-ti.me
+ *
+ * tcI2CBus: Wire wrapper with per-device bus statistics
+ * -------------------------------------------------------------------
+ * License: Modified MIT NON-AI
+ * 
+ * Permission is hereby granted, free of charge, to any person 
+ * obtaining a copy of this software and associated documentation 
+ * files (the "Software"), to deal in the Software without restriction, 
+ * including without limitation the rights to use, copy, modify, 
+ * merge, publish, distribute, sublicense, and/or sell copies of the 
+ * Software, and to permit persons to whom the Software is furnished to 
+ * do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be 
+ * included in all copies or substantial portions of the Software.
+ * 
+ * Links inside the Software pointing to the original source must not 
+ * be changed or removed.
+ *
+ * In addition, the following restrictions apply:
+ * 
+ * 1. The Software and any modifications made to it may not be used 
+ * for the purpose of training or improving machine learning algorithms, 
+ * including but not limited to artificial intelligence, natural 
+ * language processing, or data mining. This condition applies to any 
+ * derivatives, modifications, or updates based on the Software code. 
+ * Any usage of the Software in an AI-training dataset is considered a 
+ * breach of this License.
+ *
+ * 2. The Software may not be included in any dataset used for 
+ * training or improving machine learning algorithms, including but 
+ * not limited to artificial intelligence, natural language processing, 
+ * or data mining.
+ *
+ * 3. Any person or organization found to be in violation of these 
+ * restrictions will be subject to legal action and may be held liable 
+ * for any damages resulting from such use.
+ *
+ * 4. The source code and the binary form, and any modifications made 
+ * to them may not be used for the purpose of training or improving 
+ * machine learning algorithms, including but not limited to artificial
+ * intelligence, natural language processing, or data mining. This 
+ * condition applies to any derivatives, modifications, or updates 
+ * based on the Software code. Any usage of the source code or the 
+ * binary form in an AI-training dataset is considered a breach of 
+ * this License.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. 
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY 
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, 
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE 
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "tc_global.h"
+
+#include <Arduino.h>
+
+#include "i2cbus.h"
+
+tcI2CBus   i2cBus;
+tcI2CSched i2cSched;
+
+/*
+ * tcI2CBus class
+ * 
+ * Drop-in for the Wire calls used by the device drivers;
+ * times each bus transaction and keeps statistics per
+ * device address.
+ */
+
+uint8_t tcI2CBus::endTransmission(bool sendStop)
+{
+    unsigned long now = micros();
+    uint8_t ret = Wire.endTransmission(sendStop);
+
+    // Skip failed address probes (device detection)
+    if(ret && !_len)
+        return ret;
+
+    record(_addr, _len + 1, micros() - now, !!ret);
+    
+    return ret;
+}
+
+uint8_t tcI2CBus::requestFrom(uint8_t address, uint8_t len)
+{
+    unsigned long now = micros();
+    uint8_t ret = Wire.requestFrom(address, len);
+
+    record(address, ret + 1, micros() - now, (ret != len));
+
+    return ret;
+}
+
+const i2cDevStats *tcI2CBus::getDevStats(int idx)
+{
+    if(idx < 0 || idx >= _numDevs)
+        return NULL;
+
+    return &_stats[idx];
+}
+
+void tcI2CBus::resetStats()
+{
+    for(int i = 0; i < _numDevs; i++) {
+        uint8_t addr = _stats[i].addr;
+        memset(&_stats[i], 0, sizeof(i2cDevStats));
+        _stats[i].addr = addr;
+    }
+}
+
+/*
+ * Private
+ */
+
+void tcI2CBus::record(uint8_t address, uint32_t bytes, uint32_t usecs, bool err)
+{
+    i2cDevStats *s;
+    uint32_t t = usecs >> 6;
+    int i = _lastIdx, b = 0;
+
+    if(i >= _numDevs || _stats[i].addr != address) {
+        for(i = 0; i < _numDevs; i++) {
+            if(_stats[i].addr == address) break;
+        }
+        if(i == _numDevs) {
+            if(_numDevs == I2CS_MAX_DEV)
+                return;
+            memset(&_stats[i], 0, sizeof(i2cDevStats));
+            _stats[i].addr = address;
+            _numDevs++;
+        }
+        _lastIdx = i;
+    }
+
+    s = &_stats[i];
+
+    s->count++;
+    s->bytes += bytes;
+    s->usecs += usecs;
+    if(err) s->errors++;
+
+    while(t && b < I2CS_HIST_BINS - 1) {
+        t >>= 1;
+        b++;
+    }
+    s->hist[b]++;
+
+    i2cSched.account(usecs);
+}
+
+/*
+ * tcI2CSched class
+ *
+ * Bulk jobs (GPS, sensors) get bus time left over by keypad scans
+ * and display updates within a time budget per slice. A slice is
+ * one main_loop() iteration or one round of a delay loop. Bus time
+ * of all other traffic is accounted through tcI2CBus; that of the
+ * previous slice is kept free for it. Jobs are added in priority
+ * order; a job is deferred while keypad input is in progress, or
+ * while a higher priority job is waiting for budget in this slice.
+ * The first job in a slice is granted regardless of budget, and
+ * past its deadline, a job runs in any case.
+ */
+
+int tcI2CSched::addJob(uint16_t deadline)
+{
+    if(_numJobs == I2CS_MAX_JOBS)
+        return -1;
+
+    memset(&_jobs[_numJobs], 0, sizeof(i2cJobStats));
+    _jobs[_numJobs].deadline = deadline;
+
+    return _numJobs++;
+}
+
+void tcI2CSched::newSlice()
+{
+    if(_used > _budget) _overruns++;
+    _fgEst = _fgUsed;
+    _used = _fgUsed = 0;
+    _jobsRun = false;
+    _waiting = 0;
+    _sliceStart = millis();
+    _slices++;
+}
+
+void tcI2CSched::account(uint32_t usecs)
+{
+    // Jobs are accounted as a whole in done()
+    if(_inJob >= 0)
+        return;
+
+    _used += usecs;
+    _fgUsed += usecs;
+}
+
+bool tcI2CSched::grant(int job, unsigned long late)
+{
+    i2cJobStats *j = &_jobs[job];
+    uint32_t reserve;
+
+    // Delay loops which do not start slices
+    if(millis() - _sliceStart >= I2CS_SLICE_MAX)
+        newSlice();
+
+    if(late >= j->deadline) {
+        j->forced++;
+        return true;
+    }
+
+    if(_fgBusy) {
+        j->deferFg++;
+        return false;
+    }
+
+    reserve = (_fgEst > _fgUsed) ? _fgEst - _fgUsed : 0;
+
+    if((_waiting & ((1 << job) - 1)) ||
+       (_jobsRun && _used + reserve + j->cost > _budget)) {
+        _waiting |= (1 << job);
+        j->deferBudget++;
+        return false;
+    }
+
+    j->granted++;
+    return true;
+}
+
+void tcI2CSched::done(int job, uint32_t usecs)
+{
+    _jobs[job].cost = usecs;
+    _used += usecs;
+    _jobsRun = true;
+    _inJob = -1;
+}
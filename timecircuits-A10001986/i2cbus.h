@@ -0,0 +1,158 @@
+/*
+ * -------------------------------------------------------------------
+ * CircuitSetup.us Time Circuits Display
+ * (C) 2022-2026 Thomas Winischhofer (A10001986)
+ * https://github.com/realA10001986/Time-Circuits-Display
+ * https://tcd.out-a-ti.me
+ *
+ * tcI2CBus: Wire wrapper with per-device bus statistics
+ * tcI2CSched: Bus time budget for bulk jobs (GPS, sensors)
+ * -------------------------------------------------------------------
+ * License: Modified MIT NON-AI
+ * 
+ * Permission is hereby granted, free of charge, to any person 
+ * obtaining a copy of this software and associated documentation 
+ * files (the "Software"), to deal in the Software without restriction, 
+ * including without limitation the rights to use, copy, modify, 
+ * merge, publish, distribute, sublicense, and/or sell copies of the 
+ * Software, and to permit persons to whom the Software is furnished to 
+ * do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be 
+ * included in all copies or substantial portions of the Software.
+ * 
+ * Links inside the Software pointing to the original source must not 
+ * be changed or removed.
+ *
+ * In addition, the following restrictions apply:
+ * 
+ * 1. The Software and any modifications made to it may not be used 
+ * for the purpose of training or improving machine learning algorithms, 
+ * including but not limited to artificial intelligence, natural 
+ * language processing, or data mining. This condition applies to any 
+ * derivatives, modifications, or updates based on the Software code. 
+ * Any usage of the Software in an AI-training dataset is considered a 
+ * breach of this License.
+ *
+ * 2. The Software may not be included in any dataset used for 
+ * training or improving machine learning algorithms, including but 
+ * not limited to artificial intelligence, natural language processing, 
+ * or data mining.
+ *
+ * 3. Any person or organization found to be in violation of these 
+ * restrictions will be subject to legal action and may be held liable 
+ * for any damages resulting from such use.
+ *
+ * 4. The source code and the binary form, and any modifications made 
+ * to them may not be used for the purpose of training or improving 
+ * machine learning algorithms, including but not limited to artificial
+ * intelligence, natural language processing, or data mining. This 
+ * condition applies to any derivatives, modifications, or updates 
+ * based on the Software code. Any usage of the source code or the 
+ * binary form in an AI-training dataset is considered a breach of 
+ * this License.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. 
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY 
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, 
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE 
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef _I2CBUS_H
+#define _I2CBUS_H
+
+#include <Wire.h>
+
+#define I2CS_MAX_DEV    24
+#define I2CS_HIST_BINS  10      // <64us, <128us, ... <16384us, >=16384us
+
+struct i2cDevStats {
+    uint8_t  addr;
+    uint32_t count;             // Transactions
+    uint32_t bytes;             // Bytes on the bus, incl. address byte
+    uint32_t usecs;             // Accumulated bus time
+    uint32_t errors;            // NACK, timeout, short read
+    uint32_t hist[I2CS_HIST_BINS];
+};
+
+class tcI2CBus {
+
+    public:
+
+        void    beginTransmission(uint8_t address) { _addr = address; _len = 0; Wire.beginTransmission(address); }
+        size_t  write(uint8_t val)                 { _len++; return Wire.write(val); }
+        uint8_t endTransmission(bool sendStop = true);
+        uint8_t requestFrom(uint8_t address, uint8_t len);
+        int     read()                             { return Wire.read(); }
+
+        int     getNumDevs() { return _numDevs; }
+        const i2cDevStats *getDevStats(int idx);
+        void    resetStats();
+
+    private:
+
+        void    record(uint8_t address, uint32_t bytes, uint32_t usecs, bool err);
+
+        i2cDevStats _stats[I2CS_MAX_DEV];
+        int      _numDevs = 0;
+        int      _lastIdx = 0;
+
+        uint8_t  _addr = 0;
+        uint32_t _len = 0;
+};
+
+#define I2CS_MAX_JOBS   4
+#define I2CS_SLICE_MAX  20      // ms; a slice not renewed for that long ends
+
+struct i2cJobStats {
+    uint16_t deadline;          // ms past due after which the job runs regardless
+    uint32_t cost;              // us, last run
+    uint32_t granted;           // Runs within budget
+    uint32_t forced;            // Runs past deadline
+    uint32_t deferFg;           // Deferred for keypad input
+    uint32_t deferBudget;       // Deferred for budget or higher priority job
+};
+
+class tcI2CSched {
+
+    public:
+
+        void    begin(uint32_t budget)              { _budget = budget; }
+        int     addJob(uint16_t deadline);
+        void    newSlice();
+        void    setForeground(bool busy)            { _fgBusy = busy; }
+        void    account(uint32_t usecs);
+        bool    grant(int job, unsigned long late);
+        void    start(int job)                      { _inJob = job; }
+        void    done(int job, uint32_t usecs);
+
+        const i2cJobStats *getJobStats(int job)     { return (job >= 0 && job < _numJobs) ? &_jobs[job] : NULL; }
+        uint32_t getSlices()                        { return _slices; }
+        uint32_t getOverruns()                      { return _overruns; }
+
+    private:
+
+        i2cJobStats _jobs[I2CS_MAX_JOBS];
+        int      _numJobs = 0;
+        uint8_t  _waiting = 0;          // Jobs deferred for budget in this slice
+        int      _inJob = -1;
+
+        uint32_t _budget = 0;
+        uint32_t _used = 0;             // us in this slice
+        uint32_t _fgUsed = 0;           // ... thereof other than jobs
+        uint32_t _fgEst = 0;            // Other traffic in previous slice
+        bool     _jobsRun = false;
+        bool     _fgBusy = false;
+        unsigned long _sliceStart = 0;
+
+        uint32_t _slices = 0;
+        uint32_t _overruns = 0;         // Slices over budget
+};
+
+extern tcI2CBus   i2cBus;
+extern tcI2CSched i2cSched;
+
+#endif
@@ -76,6 +76,7 @@
 #include <Arduino.h>
 
 #include "input.h"
+#include "i2cbus.h"
 #include "tc_audio.h"
 
 #define OPEN    false
@@ -133,8 +134,8 @@ void Keypad_I2C::begin(unsigned int scanInterval, unsigned int holdTime, void (*
     port_write(0xff);
 
     // Read initial value for shadow output pin state
-    Wire.requestFrom(_i2caddr, (int)1);
-    _pinState = Wire.read();
+    i2cBus.requestFrom(_i2caddr, (int)1);
+    _pinState = i2cBus.read();
 
     // Build rowMask for quick scanning
     _rowMask = 0;
@@ -181,8 +182,8 @@ bool Keypad_I2C::scanKeys()
 
                 pin_write(_columnPins[c], LOW);
 
-                Wire.requestFrom(_i2caddr, (int)1);
-                if((pinVals[d][c] = Wire.read() & _rowMask) != _rowMask)
+                i2cBus.requestFrom(_i2caddr, (int)1);
+                if((pinVals[d][c] = i2cBus.read() & _rowMask) != _rowMask)
                     haveKey = true;
 
                 pin_write(_columnPins[c], HIGH);
@@ -294,9 +295,9 @@ void Keypad_I2C::pin_write(uint8_t pinNum, bool level)
 
 void Keypad_I2C::port_write(uint8_t val)
 {
-    Wire.beginTransmission(_i2caddr);
-    Wire.write(val);
-    Wire.endTransmission();
+    i2cBus.beginTransmission(_i2caddr);
+    i2cBus.write(val);
+    i2cBus.endTransmission();
     _pinState = val;
 }
 
@@ -518,8 +519,8 @@ bool TCRotEnc::begin(bool forSpeed)
 
         _i2caddr = _addrArr[i];
 
-        Wire.beginTransmission(_i2caddr);
-        if(!Wire.endTransmission(true)) {
+        i2cBus.beginTransmission(_i2caddr);
+        if(!i2cBus.endTransmission(true)) {
 
             switch(_addrArr[i+1]) {
             case TC_RE_TYPE_ADA4991:
@@ -803,26 +804,26 @@ int TCRotEnc::read(uint16_t base, uint8_t reg, uint8_t *buf, uint8_t num)
 {
     int i2clen;
     
-    Wire.beginTransmission(_i2caddr);
-    if(base <= 0xff) Wire.write((uint8_t)base);
-    Wire.write(reg);
-    Wire.endTransmission(true);
+    i2cBus.beginTransmission(_i2caddr);
+    if(base <= 0xff) i2cBus.write((uint8_t)base);
+    i2cBus.write(reg);
+    i2cBus.endTransmission(true);
     delay(1);
-    i2clen = Wire.requestFrom(_i2caddr, (int)num);
+    i2clen = i2cBus.requestFrom(_i2caddr, (int)num);
     for(int i = 0; i < i2clen; i++) {
-        buf[i] = Wire.read();
+        buf[i] = i2cBus.read();
     }
     return i2clen;
 }
 
 void TCRotEnc::write(uint16_t base, uint8_t reg, uint8_t *buf, uint8_t num)
 {
-    Wire.beginTransmission(_i2caddr);
-    if(base <= 0xff) Wire.write((uint8_t)base);
-    Wire.write(reg);
+    i2cBus.beginTransmission(_i2caddr);
+    if(base <= 0xff) i2cBus.write((uint8_t)base);
+    i2cBus.write(reg);
     for(int i = 0; i < num; i++) {
-        Wire.write(buf[i]);
+        i2cBus.write(buf[i]);
     }
-    Wire.endTransmission();
+    i2cBus.endTransmission();
 }
 #endif 
@@ -110,6 +110,8 @@ class Keypad_I2C {
 
         bool scanKeypad();
 
+        bool isKeyActive() { return (_key.kState != TCKS_IDLE); }
+
     private:
 
         bool scanKeys();
@@ -56,6 +56,7 @@
 
 #include <Arduino.h>
 #include <Wire.h>
+#include "i2cbus.h"
 #include "rtc.h"
 
 // Registers
@@ -118,8 +119,8 @@ bool tcRTC::begin()
     for(int i = 0; i < _numTypes * 2; i += 2) {
 
         // Check for RTC on i2c bus
-        Wire.beginTransmission(_addrArr[i]);
-        if(!(Wire.endTransmission(true))) {
+        i2cBus.beginTransmission(_addrArr[i]);
+        if(!(i2cBus.endTransmission(true))) {
 
             _address = _addrArr[i];
             _rtcType = _addrArr[i+1];
@@ -425,20 +426,20 @@ uint8_t tcRTC::read_register(uint8_t reg)
 
 void tcRTC::write_bytes(uint8_t *buffer, uint8_t num)
 {
-    Wire.beginTransmission(_address);
+    i2cBus.beginTransmission(_address);
     for(int i = 0; i < num; i++) {
-        Wire.write(buffer[i]);
+        i2cBus.write(buffer[i]);
     }
-    Wire.endTransmission();   
+    i2cBus.endTransmission();   
 }
 
 void tcRTC::read_bytes(uint8_t reg, uint8_t *buffer, uint8_t num)
 {
-    Wire.beginTransmission(_address);
-    Wire.write(reg);
-    Wire.endTransmission();
-    Wire.requestFrom(_address, num);
+    i2cBus.beginTransmission(_address);
+    i2cBus.write(reg);
+    i2cBus.endTransmission();
+    i2cBus.requestFrom(_address, num);
     for(int i = 0; i < num; i++) {
-        buffer[i] = Wire.read();
+        buffer[i] = i2cBus.read();
     }
 }
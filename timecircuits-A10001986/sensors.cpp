@@ -86,6 +86,7 @@
 
 #include <Arduino.h>
 #include <Wire.h>
+#include "i2cbus.h"
 #include "sensors.h"
 
 static void defaultDelay(unsigned long mydelay)
@@ -110,9 +111,9 @@ static uint8_t crc8(uint8_t initVal, uint8_t poly, uint8_t len, uint8_t *buf)
 
 void tcSensor::prepareRead(uint16_t regno)
 {
-    Wire.beginTransmission(_address);
-    Wire.write((uint8_t)(regno));
-    Wire.endTransmission(false);
+    i2cBus.beginTransmission(_address);
+    i2cBus.write((uint8_t)(regno));
+    i2cBus.endTransmission(false);
 }
 
 uint16_t tcSensor::read16(uint16_t regno, bool LSBfirst)
@@ -124,11 +125,11 @@ uint16_t tcSensor::read16(uint16_t regno, bool LSBfirst)
         prepareRead(regno);
     }
 
-    i2clen = Wire.requestFrom(_address, (uint8_t)2);
+    i2clen = i2cBus.requestFrom(_address, (uint8_t)2);
 
     if(i2clen > 0) {
-        value = (Wire.read() << 8);
-        value |= Wire.read();
+        value = (i2cBus.read() << 8);
+        value |= i2cBus.read();
     }
     
     if(LSBfirst) {
@@ -144,13 +145,13 @@ void tcSensor::read16x2(uint16_t regno, uint16_t& t1, uint16_t& t2)
 
     prepareRead(regno);
 
-    i2clen = Wire.requestFrom(_address, (uint8_t)4);
+    i2clen = i2cBus.requestFrom(_address, (uint8_t)4);
 
     if(i2clen > 0) {
-        t1 = Wire.read();
-        t1 |= (Wire.read() << 8);
-        t2 = Wire.read();
-        t2 |= (Wire.read() << 8);
+        t1 = i2cBus.read();
+        t1 |= (i2cBus.read() << 8);
+        t2 = i2cBus.read();
+        t2 |= (i2cBus.read() << 8);
     } else {
         t1 = t2 = 0;
     }
@@ -162,35 +163,35 @@ uint8_t tcSensor::read8(uint16_t regno)
 
     prepareRead(regno);
 
-    Wire.requestFrom(_address, (uint8_t)1);
+    i2cBus.requestFrom(_address, (uint8_t)1);
 
-    value = Wire.read();
+    value = i2cBus.read();
 
     return value;
 }
 
 void tcSensor::write16(uint16_t regno, uint16_t value, bool LSBfirst)
 {
-    Wire.beginTransmission(_address);
+    i2cBus.beginTransmission(_address);
     if(regno <= 0xff) {
-        Wire.write((uint8_t)(regno));
+        i2cBus.write((uint8_t)(regno));
     }
     if(LSBfirst) {
         value = (value >> 8) | (value << 8);
     } 
-    Wire.write((uint8_t)(value >> 8));
-    Wire.write((uint8_t)(value & 0xff));
-    Wire.endTransmission();
+    i2cBus.write((uint8_t)(value >> 8));
+    i2cBus.write((uint8_t)(value & 0xff));
+    i2cBus.endTransmission();
 }
 
 void tcSensor::write8(uint16_t regno, uint8_t value)
 {
-    Wire.beginTransmission(_address);
+    i2cBus.beginTransmission(_address);
     if(regno <= 0xff) {
-        Wire.write((uint8_t)(regno));
+        i2cBus.write((uint8_t)(regno));
     }
-    Wire.write((uint8_t)(value & 0xff));
-    Wire.endTransmission();
+    i2cBus.write((uint8_t)(value & 0xff));
+    i2cBus.endTransmission();
 }
 
 #endif
@@ -338,8 +339,8 @@ bool tempSensor::begin(void (*myDelay)(unsigned long), bool InCelsius)
 
         _address = _addrArr[i];
 
-        Wire.beginTransmission(_address);
-        if(!Wire.endTransmission(true)) {
+        i2cBus.beginTransmission(_address);
+        if(!i2cBus.endTransmission(true)) {
         
             switch(_addrArr[i+1]) {
             case MCP9808:
@@ -359,16 +360,16 @@ bool tempSensor::begin(void (*myDelay)(unsigned long), bool InCelsius)
                 // Do a test-measurement for id
                 write8(SHT40_DUMMY, SHT40_CMD_RTEMPL);
                 (*_customDelayFunc)(5);
-                if(Wire.requestFrom(_address, (uint8_t)6) == 6) {
-                    for(uint8_t i = 0; i < 6; i++) buf[i] = Wire.read();
+                if(i2cBus.requestFrom(_address, (uint8_t)6) == 6) {
+                    for(uint8_t i = 0; i < 6; i++) buf[i] = i2cBus.read();
                     if(crc8(SHT40_CRC_INIT, SHT40_CRC_POLY, 2, buf) == buf[2]) {
                         foundSt = true;
                     }
                 }
                 break;
             case MS8607:
-                Wire.beginTransmission(MS8607_ADDR_RH);
-                if(!Wire.endTransmission(true)) {
+                i2cBus.beginTransmission(MS8607_ADDR_RH);
+                if(!i2cBus.endTransmission(true)) {
                     foundSt = true;
                 }
                 break;
@@ -387,9 +388,9 @@ bool tempSensor::begin(void (*myDelay)(unsigned long), bool InCelsius)
                 break;
             case HDC302X:
                 write16(HDC302x_DUMMY, HDC302x_READID);
-                if(Wire.requestFrom(_address, (uint8_t)3) == 3) {
-                    t16 = Wire.read() << 8;
-                    t16 |= Wire.read();
+                if(i2cBus.requestFrom(_address, (uint8_t)3) == 3) {
+                    t16 = i2cBus.read() << 8;
+                    t16 |= i2cBus.read();
                     if(t16 == 0x3000) {
                         foundSt = true;
                     }
@@ -611,10 +612,10 @@ float tempSensor::readTemp()
     case BMx280:
         write8(BMx280_DUMMY, BMx280_REG_TEMP);
         t = _haveHum ? 5 : 3;
-        if(Wire.requestFrom(_address, (uint8_t)t) == t) {
+        if(i2cBus.requestFrom(_address, (uint8_t)t) == t) {
             uint32_t t1; 
             uint16_t t2 = 0;
-            for(uint8_t i = 0; i < t; i++) buf[i] = Wire.read();
+            for(uint8_t i = 0; i < t; i++) buf[i] = i2cBus.read();
             t1 = (buf[0] << 16) | (buf[1] << 8) | buf[2];
             if(_haveHum) t2 = (buf[3] << 8) | buf[4];
             temp = BMx280_CalcTemp(t1, t2);
@@ -631,8 +632,8 @@ float tempSensor::readTemp()
         break;
 
     case SI7021:
-        if(Wire.requestFrom(_address, (uint8_t)3) == 3) {
-            for(uint8_t i = 0; i < 3; i++) buf[i] = Wire.read();
+        if(i2cBus.requestFrom(_address, (uint8_t)3) == 3) {
+            for(uint8_t i = 0; i < 3; i++) buf[i] = i2cBus.read();
             if(crc8(SI7021_CRC_INIT, SI7021_CRC_POLY, 2, buf) == buf[2]) {
                 t = (buf[0] << 8) | buf[1];
                 _hum = (int8_t)((int32_t)((125 * t) >> 16)) - 6;
@@ -640,8 +641,8 @@ float tempSensor::readTemp()
             }
         }
         write8(SI7021_DUMMY, SI7021_CMD_RTEMPQ);
-        if(Wire.requestFrom(_address, (uint8_t)2) == 2) {
-            for(uint8_t i = 0; i < 2; i++) buf[i] = Wire.read();
+        if(i2cBus.requestFrom(_address, (uint8_t)2) == 2) {
+            for(uint8_t i = 0; i < 2; i++) buf[i] = i2cBus.read();
             t = (buf[0] << 8) | buf[1];
             temp = ((175.72f * (float)t) / 65536.0f) - 46.85f;
         }
@@ -656,8 +657,8 @@ float tempSensor::readTemp()
         break;
 
     case AHT20:
-        if(Wire.requestFrom(_address, (uint8_t)7) == 7) {
-            for(uint8_t i = 0; i < 7; i++) buf[i] = Wire.read();
+        if(i2cBus.requestFrom(_address, (uint8_t)7) == 7) {
+            for(uint8_t i = 0; i < 7; i++) buf[i] = i2cBus.read();
             if(crc8(AHT20_CRC_INIT, AHT20_CRC_POLY, 6, buf) == buf[6]) {
                 _hum = (((uint32_t)((buf[1] << 12) | (buf[2] << 4) | (buf[3] >> 4))) * 100) >> 20;
                 temp = ((((float)((uint32_t)(((buf[3] & 0x0f) << 16) | (buf[4] << 8) | buf[5]))) * 200.0f) / 1048576.0f) - 50.0f;
@@ -678,20 +679,20 @@ float tempSensor::readTemp()
     case MS8607:
         _address = MS8607_ADDR_T;
         write8(MS8607_DUMMY, 0x00);
-        if(Wire.requestFrom(_address, (uint8_t)3) == 3) {
+        if(i2cBus.requestFrom(_address, (uint8_t)3) == 3) {
             int32_t dT = 0;
-            for(int i = 0; i < 3; i++) { dT<<=8; dT |= Wire.read(); }
+            for(int i = 0; i < 3; i++) { dT<<=8; dT |= i2cBus.read(); }
             dT -= _MS8607_C5;
             temp = (2000.0f + (((float)(dT * _MS8607_C6)) / 8388608.0f)) / 100.0f;
         }
         // Trigger new conversion t
         write8(MS8607_DUMMY, 0x54);
         _address = MS8607_ADDR_RH;
-        if(Wire.requestFrom(_address, (uint8_t)3) == 3) {
-            t = Wire.read() << 8; 
-            t |= Wire.read();
+        if(i2cBus.requestFrom(_address, (uint8_t)3) == 3) {
+            t = i2cBus.read() << 8; 
+            t |= i2cBus.read();
             t &= ~0x03;
-            Wire.read();
+            i2cBus.read();
             _hum = (int8_t)(((int32_t)(t * 12500 / 65536) - 600) / 100);
             //if(temp > 0.0f && temp <= 85.0f) {
             //    _hum += ((int8_t)((float)(20.0f - temp) * -0.18f));   // rh compensated; not worth the computing time
@@ -775,8 +776,8 @@ void tempSensor::HDC302x_setDefault(uint16_t reg, uint8_t val1, uint8_t val2)
     
     write16(HDC302x_DUMMY, reg);
     (*_customDelayFunc)(5);
-    if(Wire.requestFrom(_address, (uint8_t)3) == 3) {
-        for(uint8_t i = 0; i < 3; i++) buf[i] = Wire.read();
+    if(i2cBus.requestFrom(_address, (uint8_t)3) == 3) {
+        for(uint8_t i = 0; i < 3; i++) buf[i] = i2cBus.read();
         if(crc8(HDC302x_CRC_INIT, HDC302x_CRC_POLY, 2, buf) == buf[2]) {
             #ifdef TC_DBG_SENS
             Serial.printf("HDC302x: Read 0x%x\n", reg);
@@ -788,11 +789,11 @@ void tempSensor::HDC302x_setDefault(uint16_t reg, uint8_t val1, uint8_t val2)
                 buf[0] = reg >> 8; buf[1] = reg & 0xff;
                 buf[2] = val1; buf[3] = val2;
                 buf[4] = crc8(HDC302x_CRC_INIT, HDC302x_CRC_POLY, 2, &buf[2]);
-                Wire.beginTransmission(_address);
+                i2cBus.beginTransmission(_address);
                 for(int i=0; i < 5; i++) {
-                    Wire.write(buf[i]);
+                    i2cBus.write(buf[i]);
                 }
-                Wire.endTransmission();
+                i2cBus.endTransmission();
                 (*_customDelayFunc)(80);
             } else {
                 #ifdef TC_DBG_SENS
@@ -813,8 +814,8 @@ void tempSensor::HDC302x_setDefault(uint16_t reg, uint8_t val1, uint8_t val2)
 
 bool tempSensor::readAndCheck6(uint8_t *buf, uint16_t& t, uint16_t& h, uint8_t crcinit, uint8_t crcpoly)
 {
-    if(Wire.requestFrom(_address, (uint8_t)6) == 6) {
-        for(int i = 0; i < 6; i++) buf[i] = Wire.read();
+    if(i2cBus.requestFrom(_address, (uint8_t)6) == 6) {
+        for(int i = 0; i < 6; i++) buf[i] = i2cBus.read();
         if(crc8(crcinit, crcpoly, 2, buf) == buf[2]) {
             t = (buf[0] << 8) | buf[1];
             if(crc8(crcinit, crcpoly, 2, buf+3) == buf[5]) {
@@ -997,8 +998,8 @@ bool lightSensor::begin(bool skipLast, void (*myDelay)(unsigned long))
 
         _address = _addrArr[i];
 
-        Wire.beginTransmission(_address);
-        if(!Wire.endTransmission(true)) {
+        i2cBus.beginTransmission(_address);
+        if(!i2cBus.endTransmission(true)) {
 
             switch(_addrArr[i+1]) {
             case LST_LTR3xx:
@@ -1135,11 +1136,11 @@ void lightSensor::loop()
             return;
 
         write8(LTR303_DUMMY, LTR303_DATA1);
-        if(Wire.requestFrom(_address, (uint8_t)4) == 4) {
-            temp1 = Wire.read();
-            temp1 |= (Wire.read() << 8);
-            temp  = Wire.read();
-            temp  |= (Wire.read() << 8);
+        if(i2cBus.requestFrom(_address, (uint8_t)4) == 4) {
+            temp1 = i2cBus.read();
+            temp1 |= (i2cBus.read() << 8);
+            temp  = i2cBus.read();
+            temp  |= (i2cBus.read() << 8);
             if(temp + temp1 == 0) {
                 _lux = 0;
             } else {
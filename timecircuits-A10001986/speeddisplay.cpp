@@ -66,6 +66,7 @@
 #include <math.h>
 #include "speeddisplay.h"
 #include <Wire.h>
+#include "i2cbus.h"
 
 // Speedo displays "--" for NO_FIX_DASHES ms if GPS fix is
 // lost, afterwards it will display "00.".
@@ -400,8 +401,8 @@ bool speedDisplay::begin(int dispType, int sSpeedoPin, int sTachopin, int sSpeed
     case SPT_I2C_7S:
     case SPT_I2C_14S:
         // Check for speedo on i2c bus
-        Wire.beginTransmission(_address);
-        if(Wire.endTransmission(true)) {
+        i2cBus.beginTransmission(_address);
+        if(i2cBus.endTransmission(true)) {
             _speedoType = SPT_NONE;
             #ifdef SERVOSPEEDO
             return _haveSec;
@@ -547,8 +548,6 @@ uint8_t speedDisplay::setBrightnessDirect(uint8_t level)
 // Show the buffer
 void speedDisplay::show()
 {
-    int i;
-
     if(_nightmode) {
         if(_oldnm < 1) {
             setBrightness(0);
@@ -580,15 +579,12 @@ void speedDisplay::show()
             }
         }
     
-        Wire.beginTransmission(_address);
-        Wire.write(0x00);  // start address
-    
-        for(i = 0; i <= _max_buf; i++) {
-            Wire.write(_displayBuffer[i] & 0xFF);
-            Wire.write(_displayBuffer[i] >> 8);
+        if(_frameHeld) {
+            memcpy(_frameBuffer, _displayBuffer, sizeof(_frameBuffer));
+            _frameDirty = true;
+        } else {
+            writeBuf(_displayBuffer);
         }
-    
-        Wire.endTransmission();
 
     }
     
@@ -835,21 +831,75 @@ uint16_t speedDisplay::getLEDChar(uint8_t value)
 // Directly clear the display
 void speedDisplay::clearDisplay()
 {
-    Wire.beginTransmission(_address);
-    Wire.write(0x00);  // start address
+    i2cBus.beginTransmission(_address);
+    i2cBus.write(0x00);  // start address
 
     for(int i = 0; i < 8*2; i++) {
-        Wire.write(0x0);
+        i2cBus.write(0x0);
     }
 
-    Wire.endTransmission();
+    memset(_shadowBuffer, 0, sizeof(_shadowBuffer));
+    _shadowValid = !i2cBus.endTransmission();
+}
+
+// Send pending frame (if any) and release hold.
+// Returns number of bytes sent.
+int speedDisplay::flushFrame()
+{
+    _frameHeld = false;
+
+    return sendFrame();
+}
+
+int speedDisplay::sendFrame()
+{
+    if(!_frameDirty)
+        return 0;
+
+    _frameDirty = false;
+
+    return writeBuf(_frameBuffer);
+}
+
+// Write buffer to display RAM; only the range that
+// differs from what was last sent is transmitted.
+// Returns number of bytes sent.
+int speedDisplay::writeBuf(uint16_t *db)
+{
+    int i, first = 0, last = _max_buf;
+
+    if(_shadowValid) {
+        while(first <= _max_buf && db[first] == _shadowBuffer[first]) first++;
+        if(first > _max_buf) {
+            _i2cSaved += 1 + ((_max_buf + 1) * 2);
+            return 0;
+        }
+        while(db[last] == _shadowBuffer[last]) last--;
+        _i2cSaved += (first + (_max_buf - last)) * 2;
+    }
+
+    i2cBus.beginTransmission(_address);
+    i2cBus.write(first * 2);  // start address
+
+    for(i = first; i <= last; i++) {
+        i2cBus.write(db[i] & 0xFF);
+        i2cBus.write(db[i] >> 8);
+        _shadowBuffer[i] = db[i];
+    }
+
+    _shadowValid = !i2cBus.endTransmission();
+
+    return 1 + ((last - first + 1) * 2);
 }
 
 void speedDisplay::directCmd(uint8_t val)
 {
-    Wire.beginTransmission(_address);
-    Wire.write(val);
-    Wire.endTransmission();
+    // Commands must not overtake a pending frame
+    sendFrame();
+    
+    i2cBus.beginTransmission(_address);
+    i2cBus.write(val);
+    i2cBus.endTransmission();
 }
 
 #ifdef SERVOSPEEDO
@@ -145,6 +145,12 @@ class speedDisplay {
         int  getSpeed()   { return _speed; }
 
         bool getDot()     { return _dot01; }
+
+        uint32_t getI2CBytesSaved() { return _i2cSaved; }
+        uint8_t  getAddress() { return _address; }
+
+        void holdFrame() { _frameHeld = true; }
+        int  flushFrame();
         //bool getColon()   { return _colon; }
 
         bool dispL0Spd = true;
@@ -158,6 +164,8 @@ class speedDisplay {
         uint16_t getLEDChar(uint8_t value);
         void clearDisplay();                    // clears display RAM
         void directCmd(uint8_t val);
+        int  sendFrame();
+        int  writeBuf(uint16_t *db);
 
         #ifdef SERVOSPEEDO
         void setExSpeed(int speed, bool force = false);
@@ -183,6 +191,12 @@ class speedDisplay {
 
         uint8_t _address;
         uint16_t _displayBuffer[8];
+        uint16_t _shadowBuffer[8];              // Display RAM as last sent
+        bool     _shadowValid = false;
+        uint32_t _i2cSaved = 0;
+        uint16_t _frameBuffer[8];               // Back buffer while frame held
+        bool     _frameHeld = false;
+        bool     _frameDirty = false;
 
         int8_t _onCache = -1;                   // Cache for on/off
         uint8_t _briCache = 0xfe;               // Cache for brightness
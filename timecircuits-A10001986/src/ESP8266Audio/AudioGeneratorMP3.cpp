@@ -90,6 +90,7 @@ bool AudioGeneratorMP3::stop()
   stream = NULL;
 
   running = false;
+  nextFile = nullptr;
   output->stop();
   return file->close();
 }
@@ -155,6 +156,26 @@ enum mad_flow AudioGeneratorMP3::Input()
 
   len = file->read(buff + unused, len);
 
+  // TW: End of file: Continue with next source, if any. This is
+  // where a single file would end: Its tail has been offered until
+  // nothing more could be decoded, and dropped. The bit reservoir
+  // and IMDCT overlap are reset, too, so they do not leak into the
+  // new file's first frames; a frame referring back into the
+  // reservoir is skipped (BADDATAPTR) instead of being decoded
+  // from the old file's data.
+  if ((len == 0) && (unused == 0) && nextFile) {
+    file->close();
+    file = nextFile;
+    nextFile = nullptr;
+    switched = true;
+    stream->sync = 0;
+    stream->freerate = 0;
+    stream->md_len = 0;
+    mad_frame_mute(frame);
+    lastReadPos = file->getPos();
+    len = file->read(buff, buffLen);
+  }
+
   //Serial.printf("mp3: read %d bytes (%d requested, %d bufflen, %d unused)\n", len, buffLen - unused, buffLen, unused);
 
   if ((len == 0)  && (unused == 0)) {
@@ -185,101 +206,116 @@ void AudioGeneratorMP3::desync ()
     lastBuffLen = 0;
 }
 
+#ifdef TWESP32
+AudioGeneratorMP3::Profile AudioGeneratorMP3::prof = { 0 };
+#define PROF_START(x) uint32_t x = ESP.getCycleCount()
+#define PROF_ADD(x,s) prof.s += ESP.getCycleCount() - x
+#else
+#define PROF_START(x)
+#define PROF_ADD(x,s)
+#endif
+
 bool AudioGeneratorMP3::DecodeNextFrame()
 {
+  PROF_START(c0);
   if (mad_frame_decode(frame, stream) == -1) {
+    PROF_ADD(c0, decode);
     ErrorToFlow(); // Always returns CONTINUE
     return false;
   }
+  PROF_ADD(c0, decode);
+  #ifdef TWESP32
+  prof.frames++;
+  #endif
   nsCountMax  = MAD_NSBSAMPLES(&frame->header);
   return true;
 }
 
-bool AudioGeneratorMP3::GetOneSample(int16_t& saL, int16_t& saR)
+// TW: Synthesize next 32 samples into synth->pcm; decodes next frame
+// if needed. Returns false when done (EOF, error, or stopped).
+bool AudioGeneratorMP3::SynthNextNs()
 {
-  // If we're here, we have one decoded frame and sent 0 or more samples out
-  if (samplePtr < synth->pcm.length) {
-    saL = synth->pcm.samples[0][samplePtr];
-    saR = synth->pcm.samples[1][samplePtr];
-    samplePtr++;
-  } else {
-    samplePtr = 0;
+  // Decode next frame if we're beyond the existing generated data
+  if (nsCount >= nsCountMax) {
+retry:
+    PROF_START(c1);
+    if (Input() == MAD_FLOW_STOP) {
+      return false;
+    }
+    PROF_ADD(c1, input);
 
-    switch ( mad_synth_frame_onens(synth, frame, nsCount++) ) {
-        case MAD_FLOW_BREAK:
+    if (!DecodeNextFrame()) {
+      if (stream->error == MAD_ERROR_BUFLEN) {
+        // randomly seeking can lead to endless
+        // and unrecoverable "MAD_ERROR_BUFLEN" loop
+        if (++unrecoverable >= 3) {
           #ifdef HAVE_AUDIO_LOGGER
-          audioLogger->printf_P(PSTR("msf1ns MAD_FLOW_BREAK\n"));
+          audioLogger->printf_P(PSTR("MP3:ERROR_BUFLEN %d\n"), unrecoverable);
           #endif
-        case MAD_FLOW_STOP:
-          return false; // Either way we're done
-        default:
-          break; // Do nothing
+          unrecoverable = 0;
+          stop();
+          return false;
+        }
+      } else {
+        unrecoverable = 0;
+      }
+      goto retry;
     }
+    nsCount = 0;
+  }
 
-    if (synth->pcm.samplerate != lastRate) {
-        output->SetRate(synth->pcm.samplerate);
-        lastRate = synth->pcm.samplerate;
-    }
-    if (synth->pcm.channels != lastChannels) {
-        output->SetChannels(synth->pcm.channels);
-        lastChannels = synth->pcm.channels;
-    }
+  PROF_START(c2);
+  int r = mad_synth_frame_onens(synth, frame, nsCount++);
+  PROF_ADD(c2, synth);
+
+  switch (r) {
+      case MAD_FLOW_BREAK:
+        #ifdef HAVE_AUDIO_LOGGER
+        audioLogger->printf_P(PSTR("msf1ns MAD_FLOW_BREAK\n"));
+        #endif
+      case MAD_FLOW_STOP:
+        running = false;
+        return false; // Either way we're done
+      default:
+        break; // Do nothing
+  }
 
-    // for IGNORE and CONTINUE, just play what we have now
-    saL = synth->pcm.samples[0][samplePtr];
-    saR = synth->pcm.samples[1][samplePtr];
-    samplePtr++;
+  if (synth->pcm.samplerate != lastRate) {
+      output->SetRate(synth->pcm.samplerate);
+      lastRate = synth->pcm.samplerate;
   }
+  if (synth->pcm.channels != lastChannels) {
+      output->SetChannels(synth->pcm.channels);
+      lastChannels = synth->pcm.channels;
+  }
+
+  samplePtr = 0;
   return true;
 }
 
 
 bool AudioGeneratorMP3::loop()
 {
-  if (!running) goto done; // Nothing to do here!
+  uint16_t n;
 
-  // First, try and push in the stored sample.  If we can't, then punt and try later
-  if (!output->ConsumeSample(sL, sR)) goto done; // Can't send, but no error detected
+  if (!running) goto done; // Nothing to do here!
 
-  // Try and stuff the buffer one sample at a time
+  // TW: Hand whole synth blocks (32 samples) to output
   do
   {
-    // Decode next frame if we're beyond the existing generated data
-    if ( (samplePtr >= synth->pcm.length) && (nsCount >= nsCountMax) ) {
-retry:
-      if (Input() == MAD_FLOW_STOP) {
-        return false;
-      }
-
-      if (!DecodeNextFrame()) {
-        if (stream->error == MAD_ERROR_BUFLEN) {
-          // randomly seeking can lead to endless
-          // and unrecoverable "MAD_ERROR_BUFLEN" loop
-          if (++unrecoverable >= 3) {
-            #ifdef HAVE_AUDIO_LOGGER
-            audioLogger->printf_P(PSTR("MP3:ERROR_BUFLEN %d\n"), unrecoverable);
-            #endif
-            unrecoverable = 0;
-            stop();
-            return running;
-          }
-        } else {
-          unrecoverable = 0;
-        }
-        goto retry;
-      }
-      samplePtr = 9999;
-      nsCount = 0;
+    if (samplePtr < synth->pcm.length) {
+      n = output->ConsumeSamples(&synth->pcm.samples[0][samplePtr], &synth->pcm.samples[1][samplePtr],
+                                 1, synth->pcm.length - samplePtr);
+      samplePtr += n;
+      if (samplePtr < synth->pcm.length) goto done; // Can't send, but no error detected
     }
 
-    if (!GetOneSample(sL, sR)) {
-      #ifdef HAVE_AUDIO_LOGGER
-      audioLogger->printf_P(PSTR("G1S failed\n"));
-      #endif
+    if (!SynthNextNs()) {
+      // TW: Done; still give source and output their loop() call
       running = false;
       goto done;
     }
-  } while (running && output->ConsumeSample(sL, sR));
+  } while (running);
 
 done:
   file->loop();
@@ -303,6 +339,8 @@ bool AudioGeneratorMP3::begin(AudioFileSource *source, AudioOutput *output)
 
   // Reset error count from previous file
   unrecoverable = 0;
+  nextFile = nullptr;
+  switched = false;
 
   output->SetBitsPerSample(16); // Constant for MP3 decoder
   output->SetChannels(2);
@@ -378,7 +416,8 @@ bool AudioGeneratorMP3::begin(AudioFileSource *source, AudioOutput *output)
   mad_frame_init(frame);
   mad_synth_init(synth);
   synth->pcm.length = 0;
-  mad_stream_options(stream, 0); // TODO - add options support
+  // TW: Mono output: Have libmad combine channels before synthesis
+  mad_stream_options(stream, monoOut ? MAD_OPTION_SINGLECHANNEL : 0);
   madInitted = true;
 
   running = true;
@@ -40,12 +40,34 @@ class AudioGeneratorMP3 : public AudioGenerator
     virtual bool isRunning() override;
     virtual void desync () override;
 
+    // TW: Output is mono (mixed by hardware): Synthesize once, from
+    // channels combined in the subband domain. Applies from begin().
+    void SetMono(bool mono) { monoOut = mono; }
+
+    // TW: Gapless playback: At end of file, close it and continue
+    // with "next" (open, positioned at first frame) without
+    // restarting decoder or output.
+    void SetNextSource(AudioFileSource *next) { nextFile = next; }
+    bool SourceSwitched() { bool r = switched; switched = false; return r; }
+
     static constexpr int preAllocSize () { return preAllocBuffSize() + preAllocStreamSize() + preAllocFrameSize() + preAllocSynthSize(); }
     static constexpr int preAllocBuffSize () { return ((buffLen + 7) & ~7); }
     static constexpr int preAllocStreamSize () { return ((sizeof(struct mad_stream) + 7) & ~7); }
     static constexpr int preAllocFrameSize () { return (sizeof(struct mad_frame) + 7) & ~7; }
     static constexpr int preAllocSynthSize () { return (sizeof(struct mad_synth) + 7) & ~7; }
 
+    #ifdef TWESP32
+    // TW: Decoder profile, CPU cycles per stage, summed over all instances
+    typedef struct {
+      uint32_t frames;
+      uint64_t input;     // Refill stream buffer from source
+      uint64_t decode;    // mad_frame_decode (huffman, requantize, stereo, IMDCT)
+      uint64_t synth;     // mad_synth_frame_onens (polyphase filterbank)
+    } Profile;
+    static void getProfile(Profile *p) { *p = prof; }
+    static void resetProfile() { prof = { 0 }; }
+    #endif
+
   protected:
     void *preallocateSpace = nullptr;
     int preallocateSize = 0;
@@ -76,10 +98,16 @@ class AudioGeneratorMP3 : public AudioGenerator
     enum mad_flow ErrorToFlow();
     enum mad_flow Input();
     bool DecodeNextFrame();
-    bool GetOneSample(int16_t& sL, int16_t& sR);
+    bool SynthNextNs();
 
   private:
     int unrecoverable = 0;
+    bool monoOut = false;
+    AudioFileSource *nextFile = nullptr;
+    bool switched = false;
+    #ifdef TWESP32
+    static Profile prof;
+    #endif
 };
 
 #endif
@@ -64,37 +64,16 @@ bool AudioGeneratorWAV::freeBuf()
 }
 
 // Handle buffered reading, reload each time we run out of data
-bool AudioGeneratorWAV::GetBufferedData16x2(int16_t& destL, int16_t& destR)
+// TW: Returns number of bytes available in buffer
+uint32_t AudioGeneratorWAV::FillBuffer()
 {
     if(buffPtr >= buffLen) {
         buffPtr = 0;
         uint32_t toRead = availBytes > buffSize ? buffSize : availBytes;
         buffLen = file->read( buff, toRead );
         availBytes -= buffLen;
-        if(buffPtr >= buffLen)
-            return false; // No data left!
     }
-    destL = *(int16_t *)(buff+buffPtr);
-    buffPtr += 2;
-    destR = *(int16_t *)(buff+buffPtr);
-    buffPtr += 2;
-    return true;
-}
-
-
-bool AudioGeneratorWAV::GetBufferedData16(int16_t& dest)
-{
-    if(buffPtr >= buffLen) {
-        buffPtr = 0;
-        uint32_t toRead = availBytes > buffSize ? buffSize : availBytes;
-        buffLen = file->read( buff, toRead );
-        availBytes -= buffLen;
-        if(buffPtr >= buffLen)
-            return false; // No data left!
-    }
-    dest = *(int16_t *)(buff+buffPtr);
-    buffPtr += 2;
-    return true;
+    return buffLen - buffPtr;
 }
 
 bool AudioGeneratorWAV::GetBufferedData8(uint8_t& dest)
@@ -136,26 +115,27 @@ bool AudioGeneratorWAV::loop()
 {
   if (!running) goto done; // Nothing to do here!
 
-  // First, try and push in the stored sample.  If we can't, then punt and try later
-  if (!output->ConsumeSample(sL, sR)) goto done; // Can't send, but no error detected
-
-  // Try and stuff the buffer one sample at a time
-  // TW: Unroll this
+  // TW: Hand whole buffers to output
   if(bitsPerSample == 16) {
-      if(channels == 2) {
-          do
-          {
-              if (!GetBufferedData16x2(sL, sR)) stop();
-          } while (running && output->ConsumeSample(sL, sR));
-      } else {
-          sR = 0;
-          do
-          {
-              if (!GetBufferedData16(sL)) stop();
-          } while (running && output->ConsumeSample(sL, sR));
-      }
+      uint32_t frameSize = channels * 2, frames;
+      uint16_t n;
+      do
+      {
+          if (!(frames = FillBuffer() / frameSize)) {
+              stop(); // No data left!
+              break;
+          }
+          const int16_t *p = reinterpret_cast<const int16_t *>(buff + buffPtr);
+          n = output->ConsumeSamples(p, (channels == 2) ? p + 1 : p, channels, frames);
+          buffPtr += n * frameSize;
+          if (n < frames) break; // Can't send, but no error detected
+      } while (running);
   } else if(bitsPerSample == 8) {
+      // First, try and push in the stored sample.  If we can't, then punt and try later
+      if (!output->ConsumeSample(sL, sR)) goto done; // Can't send, but no error detected
+
       uint8_t l, r = 0;
+      // Try and stuff the buffer one sample at a time
       do
       {
           if(!GetBufferedData8(l)) stop();
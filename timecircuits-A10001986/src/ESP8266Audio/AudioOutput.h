@@ -62,16 +62,17 @@ class AudioOutput
     #else
     virtual bool ConsumeSample(int16_t sL, int16_t sR) { (void)sL;(void)sR; return false; }
     #endif
-    /*
-    virtual uint16_t ConsumeSamples(int16_t *samples, uint16_t count)
+    // TW: Block version. Left/right samples are read from sL/sR, both
+    // advancing by "step" per frame (1: planar, 2: interleaved).
+    // Returns number of frames consumed.
+    virtual uint16_t ConsumeSamples(const int16_t *sL, const int16_t *sR, int step, uint16_t count)
     {
-      for (uint16_t i=0; i<count; i++) {
-        if (!ConsumeSample(samples)) return i;
-        samples += 2;
+      uint16_t i;
+      for (i = 0; i < count; i++, sL += step, sR += step) {
+        if (!ConsumeSample(*sL, *sR)) break;
       }
-      return count;
+      return i;
     }
-    */
     virtual bool stop() { return false; }
     virtual void flush() { return; }
     virtual bool loop() { return true; }
@@ -109,6 +110,15 @@ class AudioOutput
       return (s * gainF2P6_R) & 0xffff0000;
       // TW: We NEVER amplify, we only ever attenuate
     }
+    // TW: Amplify and pack a block of frames for I2S (AUTO_MONO)
+    void PackSamples(uint32_t *dst, const int16_t *sL, const int16_t *sR, int step, uint16_t count) {
+      int16_t gL = gainF2P6_L;
+      int32_t gR = gainF2P6_R;
+      if (channels == 1) sR = sL;
+      for (uint16_t i = 0; i < count; i++, sL += step, sR += step) {
+        dst[i] = ((uint32_t)((*sR * gR) & 0xffff0000)) | (uint16_t)((*sL * gL) >> 6);
+      }
+    }
     #endif
 
   protected:
@@ -329,6 +329,44 @@ size_t AudioOutputI2S::ConsumeSample(int16_t msL, int16_t msR)
     i2s_write((i2s_port_t)portNo, (const char*)&s32, sizeof(uint32_t), &i2s_bytes_written, 0);
     return i2s_bytes_written;
 }
+
+// TW: Block version of the above; one i2s_write per DMA buffer
+uint16_t AudioOutputI2S::ConsumeSamples(const int16_t *sL, const int16_t *sR, int step, uint16_t count)
+{
+    uint32_t blk[64];   // = dma_buf_len
+    uint16_t done = 0, n;
+    size_t i2s_bytes_written;
+
+    if(!i2sOn)
+        return 0;
+
+    while(done < count) {
+        n = count - done;
+        if(n > 64) n = 64;
+        PackSamples(blk, sL, sR, step, n);
+        i2s_write((i2s_port_t)portNo, (const char*)blk, n * sizeof(uint32_t), &i2s_bytes_written, 0);
+        i2s_bytes_written /= sizeof(uint32_t);
+        done += i2s_bytes_written;
+        if(i2s_bytes_written < n) break;
+        sL += n * step;
+        sR += n * step;
+    }
+
+    return done;
+}
+
+// TW: Write already amplified and packed stereo frames; waits up to
+// "ticks" for DMA space. Returns number of frames written.
+size_t AudioOutputI2S::WriteFrames(const uint32_t *frames, int count, uint32_t ticks)
+{
+    size_t i2s_bytes_written = 0;
+
+    if(!i2sOn)
+        return 0;
+
+    i2s_write((i2s_port_t)portNo, (const char*)frames, count * sizeof(uint32_t), &i2s_bytes_written, ticks);
+    return i2s_bytes_written / sizeof(uint32_t);
+}
 #else
 bool AudioOutputI2S::ConsumeSample(int16_t sL, int16_t sR)
 {
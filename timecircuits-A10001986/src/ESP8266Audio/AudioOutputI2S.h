@@ -42,6 +42,8 @@ class AudioOutputI2S : public AudioOutput
     virtual bool begin() override { return begin(true); }
     #ifdef TWESP32
     virtual size_t ConsumeSample(int16_t sL, int16_t sR) override;
+    virtual uint16_t ConsumeSamples(const int16_t *sL, const int16_t *sR, int step, uint16_t count) override;
+    size_t WriteFrames(const uint32_t *frames, int count, uint32_t ticks);
     #else
     virtual bool ConsumeSample(int16_t sL, int16_t sR) override;
     #endif
@@ -903,12 +903,26 @@ enum mad_flow mad_synth_frame(struct mad_synth *synth, struct mad_frame const *f
 // Up to caller to increment synth->phase, only call proper # of ns
 enum mad_flow mad_synth_frame_onens(struct mad_synth *synth, struct mad_frame const *frame, unsigned int ns)
 {
-  unsigned int nch; //, ns;
+  unsigned int nch, sb; //, ns;
   enum mad_flow (*synth_frame)(struct mad_synth *, struct mad_frame const *, unsigned int, unsigned int, unsigned int, enum mad_flow (*output_func)(), void *);
 
   nch = MAD_NCHANNELS(&frame->header);
 //  ns  = MAD_NSBSAMPLES(&frame->header);
 
+  /* TW: Mono output: Combine channels in subband domain (synthesis
+   * is linear), then synthesize only one channel.
+   */
+  if (nch == 2 &&
+      (frame->options & MAD_OPTION_SINGLECHANNEL) == MAD_OPTION_SINGLECHANNEL) {
+    mad_fixed_t *sb0 = ((struct mad_frame *)frame)->sbsample[0][ns];
+    mad_fixed_t const *sb1 = frame->sbsample[1][ns];
+
+    for (sb = 0; sb < 32; ++sb)
+      sb0[sb] = (sb0[sb] >> 1) + (sb1[sb] >> 1);
+
+    nch = 1;
+  }
+
   synth->pcm.samplerate = frame->header.samplerate;
   synth->pcm.channels   = nch;
   synth->pcm.length     = 32;// * ns;
@@ -64,6 +64,7 @@
 #include <FS.h>
 
 #include "AudioFileSourceLoop.h"
+#include "AudioOutputRing.h"
 #include "src/ESP8266Audio/AudioFileSourcePROGMEM.h"
 
 #include "src/ESP8266Audio/AudioGeneratorMP3.h"
@@ -91,6 +92,8 @@ class AudioGeneratorWAVP : public AudioGeneratorWAV
         availBytes = slen;
         
         file->seek(stPos, SEEK_SET);
+
+        memData = NULL;
       
         // Now set up the buffer or fail
         buff = reinterpret_cast<uint8_t *>(malloc(buffSize));
@@ -120,6 +123,112 @@ class AudioGeneratorWAVP : public AudioGeneratorWAV
       
         return true;
     };
+
+    // Play 16bit PCM from memory, handed to output without copying.
+    // "source" must be opened on the same data (for stop()).
+    bool beginMem(AudioFileSource *source, AudioOutput *output, int chnls, uint32_t sr, const int16_t *data, uint32_t frames)
+    {
+        if(!beginQuick(source, output, chnls, sr, 0, frames * chnls * 2)) {
+            return false;
+        }
+        memData = data;
+        memLeft = frames;
+        return true;
+    };
+
+    bool loop() override
+    {
+        uint16_t n;
+        
+        if(!memData) return AudioGeneratorWAV::loop();
+        if(!running) return false;
+
+        do {
+            if(!memLeft) {
+                stop();
+                break;
+            }
+            n = output->ConsumeSamples(memData, (channels == 2) ? memData + 1 : memData, channels, 
+                                       (memLeft > 0xffff) ? 0xffff : memLeft);
+            memData += n * channels;
+            memLeft -= n;
+        } while(n);
+
+        return running;
+    };
+
+    bool stop() override
+    {
+        memData = NULL;
+        return AudioGeneratorWAV::stop();
+    };
+
+    bool isPlayingMem()
+    {
+        return running && memData;
+    };
+    bool isPlayingMem(const int16_t *base, uint32_t frames)
+    {
+        return running && memData && memData >= base && memData <= base + frames * channels;
+    };
+
+  private:
+    const int16_t *memData = NULL;
+    uint32_t      memLeft = 0;
+};
+
+// Collects decoded PCM (unamplified) for the cache
+class AudioOutputPCMBuf : public AudioOutput
+{
+  public:
+    void setBuffer(int16_t *buf, uint32_t maxSamples)
+    {
+        _buf = buf;
+        _max = maxSamples;
+        _len = 0;
+        _overflow = false;
+    };
+    void     setQuota(int frames)   { _quota = frames; }
+    uint32_t getLen()               { return _len; }
+    bool     overflow()             { return _overflow; }
+    int      getChannels()          { return channels; }
+    int      getRate()              { return hertz; }
+
+    bool SetChannels(int chan) override
+    {
+        if(_len && chan != channels) _overflow = true;
+        channels = chan;
+        return true;
+    };
+    bool begin() override { return true; }
+    bool stop() override { return true; }
+    size_t ConsumeSample(int16_t sL, int16_t sR) override
+    {
+        return ConsumeSamples(&sL, &sR, 0, 1) ? sizeof(uint32_t) : 0;
+    };
+    uint16_t ConsumeSamples(const int16_t *sL, const int16_t *sR, int step, uint16_t count) override
+    {
+        uint16_t i;
+        if(_overflow) return 0;
+        if(count > _quota) count = (_quota > 0) ? _quota : 0;
+        for(i = 0; i < count; i++, sL += step, sR += step) {
+            if(_len + channels > _max) {
+                _overflow = true;
+                break;
+            }
+            _buf[_len++] = *sL;
+            if(channels == 2) _buf[_len++] = *sR;
+        }
+        _quota -= i;
+        return i;
+    };
+
+  private:
+    int16_t  *_buf = NULL;
+    uint32_t _max = 0;
+    uint32_t _len = 0;
+    int      _quota = 0;
+    bool     _overflow = false;
 };
 
 static AudioGeneratorMP3 *mp3;
@@ -127,9 +236,109 @@ static AudioGeneratorWAVP *wav;
 
 static AudioFileSourceFSLoop *myFS0;
 static AudioFileSourceSDLoop *mySD0;
+static AudioFileSourceSDLoop *mySD1 = NULL;   // Next music track (prefetch)
 static AudioFileSourcePROGMEM *myPM;
 
-static AudioOutputI2S *out;
+static AudioOutputI2S  *i2sOut;
+static AudioOutputRing *out;
+
+// Audio task: Decodes into the ring buffer, which is drained
+// into I2S by the ring's pump task. Generators, file sources in
+// use and the ring's producer side belong to the audio task; the
+// main loop posts commands (AC_*) which the audio task executes
+// between decoder slices.
+#define AUD_TASK_CORE   0
+#define AUD_TASK_PRIO   2
+#define AUD_PUMP_PRIO   3
+#define AUD_READ_PRIO   3
+#define AUD_TASK_STACK  8192
+#define AUD_DEC_QUOTA   256   // Frames per generator loop()
+#define AUD_CMDQ_LEN    4
+
+// File read-ahead (buffers, bytes per buffer); SD reads can
+// take several ms, LittleFS reads are short.
+#define AUD_RA_SD_BUFS  3
+#define AUD_RA_SD_SIZE  2048
+#define AUD_RA_FS_BUFS  2
+#define AUD_RA_FS_SIZE  1024
+
+#define AR_WAV 1
+#define AR_MP3 2
+
+// Commands to the audio task. The caller waits for completion,
+// so handlers may use main loop state.
+#define AC_PLAY     1   // Play file "fn" with flags "val"
+#define AC_KEY      2   // Keypad sound "fn", key "val"
+#define AC_BEEP     3   // Beep
+#define AC_STOP     4   // Stop playback, cancel prefetch
+#define AC_CANCEL   5   // Cancel prefetch
+#define AC_NEXT     6   // Hand prefetched mySD1 to decoder
+#define AC_NOLOOP   7   // End looped playback after current round
+typedef struct {
+    uint8_t    cmd;
+    uint32_t   val;
+    const char *fn;
+} audCmd;
+
+static QueueHandle_t     audCmdQ = NULL;
+static SemaphoreHandle_t audCmdDone = NULL;
+static bool              audCmdRes = false;
+static TaskHandle_t      audTask = NULL;
+static bool              audFailed = false;   // Audio task not running
+static volatile int      audRanOut = 0;
+
+// PCM cache for short, latency-critical sounds. Decoded by the
+// audio task while idle; PRELOAD entries after boot, others after
+// their first use. Least recently used entries are evicted when
+// over budget. Decoding goes to a buffer the size of the unused
+// part of the budget; if the sound does not fit, entries are
+// evicted and decoding restarts with more room.
+#define PCMC_BUDGET_RAM   (32*1024)
+#define PCMC_BUDGET_PSRAM (1024*1024)
+#define PCMC_PRELOAD      0x01
+#define PCMC_NONE   0
+#define PCMC_WANT   1
+#define PCMC_LOAD   2
+#define PCMC_READY  3
+#define PCMC_FAIL   4   // Not found or too big; never retried
+typedef struct {
+    const char    *fn;
+    uint8_t       flags;
+    uint8_t       state;
+    uint8_t       chnls;
+    uint32_t      rate;
+    int16_t       *data;
+    uint32_t      frames;
+    unsigned long lastUse;
+} pcmCacheEntry;
+static pcmCacheEntry pcmCache[] = {
+    { "/enter.mp3",     PCMC_PRELOAD },
+    { "/dooropen.mp3",  PCMC_PRELOAD },
+    { "/doorclose.mp3", PCMC_PRELOAD },
+    { "/timer.mp3",     0 },
+    { "/alarmon.mp3",   0 },
+    { "/alarmoff.mp3",  0 },
+    { "/key1.mp3",      0 },     // play_key(); files longer
+    { "/key2.mp3",      0 },     // than the budget are skipped
+    { "/key3.mp3",      0 },
+    { "/key4.mp3",      0 },
+    { "/key5.mp3",      0 },
+    { "/key6.mp3",      0 },
+    { "/key7.mp3",      0 },
+    { "/key8.mp3",      0 },
+    { "/key9.mp3",      0 }
+};
+#define PCMC_NUM (int)(sizeof(pcmCache) / sizeof(pcmCache[0]))
+static uint32_t              pcmcBudget = PCMC_BUDGET_RAM;
+static uint32_t              pcmcUsed = 0;
+static uint32_t              pcmcHits = 0, pcmcMisses = 0;
+static int                   pcmcLoading = -1;
+static int16_t               *pcmcBuf = NULL;
+static uint32_t              pcmcRoom = 0;      // Size of pcmcBuf (bytes)
+static AudioGeneratorMP3     *pcmcMP3;
+static AudioFileSourceSDLoop *pcmcSD = NULL;
+static AudioFileSourceFSLoop *pcmcFS;
+static AudioOutputPCMBuf     *pcmcOut;
 
 bool audioInitDone = false;
 
@@ -139,9 +348,36 @@ static bool beepRunning = false;
 bool            mpActive = false;
 static uint16_t *playList = NULL;
 static int      mpCurrIdx = 0;
+#define         MP_FNLEN  (8 + 256)
+
+// Music folder index (file format)
+#define MPIDX_MAGIC   0x58444954    // "TIDX"
+#define MPIDX_VERSION 2
+#define MPIDX_NOSIZE  0xffffffff    // Size not known from directory scan
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t count;
+    uint32_t nameBase;      // Offset of name pool in file
+    uint32_t sig;           // Folder signature (names)
+} mpIdxHdr;
+typedef struct {
+    uint32_t nameOffs;      // Offset in name pool
+    uint32_t size;          // File size
+    uint16_t duration;      // Seconds (estimated)
+    uint8_t  nameLen;
+    uint8_t  flags;
+} mpIdxEnt;
+static mpIdxHdr mpIdx = { 0 };       // Current folder's index header
+static File     mpIdxFile;           // Current folder's index, kept open
+static volatile int mpNextIdx = -1;   // Prefetched track, -1 = none, -2 = failed
+static uint16_t mpNextDur = 0;
+static volatile bool audTrackChanged = false;
+static char     id3nartist[16];
+static char     id3ntrack[16];
 #define         MAXID3LEN 2048
 
-Aud_State  aud_state  = { .state = 0, .curVolume = DEFAULT_VOLUME, .curTrack = 0, .maxMusic = 0, .mpShuffle = 0 };
+Aud_State  aud_state  = { .state = 0, .curVolume = DEFAULT_VOLUME, .curTrack = 0, .maxMusic = 0, .mpShuffle = 0, .curDuration = 0 };
 #ifdef TC_HAVEMQTT
 Aud_State  mpOldState = { .state = -1 };
 #endif
@@ -206,6 +442,7 @@ static int      appendFile = 0;
 */
 
 static const char *tcdrdone = "/TCD_DONE.TXT";
+static const char *tcdridx  = "/TCD_IDX.BIN";
 bool          headLineShown = false;
 bool          blinker       = true;
 unsigned long renNow1, renNow2;
@@ -233,11 +470,31 @@ static void   clear_sig_playing(int ranOut = 0);
 static int    mp_findMaxNum();
 static void   mp_nextprev(bool forcePlay, bool next);
 static bool   mp_play_int(bool force);
-static void   mp_buildFileName(char *fnbuf, int num);
-static bool   mp_renameFilesInDir(bool isSetup);
-static void   mpren_insertionSort(char **a, int n);
+static bool   mp_buildFileName(char *fnbuf, int num, uint16_t *dur = NULL);
+static void   mp_prefetch();
+static void   mp_cancelNext();
+static void   mp_switchNext();
+static void   mp_sync();
+static bool   mp_indexFiles(bool isSetup);
+static bool   mpidx_load();
+static void   mpidx_fileName(char *fnbuf, int folder);
+static bool   mpidx_readHdr(File& f, mpIdxHdr *h);
+static bool   mpidx_getHdr(int folder, mpIdxHdr *h);
+static bool   mpidx_readEnt(File& f, const mpIdxHdr *h, int num, mpIdxEnt *e, char *name);
+static int    mpidx_getCount(int folder);
+static int    mpren_cmp(const char *a, const char *b);
+static int    mpren_qcmp(const void *a, const void *b);
 
 static void   decodeID3(char *artist, char *track, char *id3, int id3size);
+static void   readID3(AudioFileSourceLoop *src, char *artist, char *track);
+
+static void   audioTaskFunc(void *arg);
+static bool   audioCmd(uint8_t cmd, const char *fn = NULL, uint32_t val = 0);
+static bool   aud_exec(const audCmd *c);
+static void   aud_stop();
+static bool   aud_play(const char *audio_file, uint32_t flags);
+static int    pcmc_lookup(const char *fn, uint32_t flags);
+static bool   pcmc_loadStep();
 
 #include "tc_beep.h"
 
@@ -265,23 +522,54 @@ void audio_setup()
     analogReadResolution(POT_RESOLUTION);
     analogSetWidth(POT_RESOLUTION);
 
-    out = new AudioOutputI2S(0, AudioOutputI2S::EXTERNAL_I2S, 32, AudioOutputI2S::APLL_DISABLE);
+    i2sOut = new AudioOutputI2S(0, AudioOutputI2S::EXTERNAL_I2S, 32, AudioOutputI2S::APLL_DISABLE);
     // Hardware does auto-mono, no need to ever call this later
     // (Also, the mono code is commented out in the audio lib)
-    out->SetOutputModeMono(false); 
-    out->SetPinout(I2S_BCLK_PIN, I2S_LRCLK_PIN, I2S_DIN_PIN);
+    i2sOut->SetOutputModeMono(false); 
+    i2sOut->SetPinout(I2S_BCLK_PIN, I2S_LRCLK_PIN, I2S_DIN_PIN);
+
+    out = new AudioOutputRing(i2sOut);
 
     mp3 = new AudioGeneratorMP3();
     wav = new AudioGeneratorWAVP();
 
     myFS0 = new AudioFileSourceFSLoop();
+    myFS0->setReadAhead(AUD_RA_FS_BUFS, AUD_RA_FS_SIZE);
     
     if(haveSD) {
         mySD0 = new AudioFileSourceSDLoop();
+        mySD0->setReadAhead(AUD_RA_SD_BUFS, AUD_RA_SD_SIZE);
+        mySD1 = new AudioFileSourceSDLoop();
+        mySD1->setReadAhead(AUD_RA_SD_BUFS, AUD_RA_SD_SIZE);
     }
 
     myPM = new AudioFileSourcePROGMEM();
 
+    pcmcMP3 = new AudioGeneratorMP3();
+    pcmcFS = new AudioFileSourceFSLoop();
+    if(haveSD) {
+        pcmcSD = new AudioFileSourceSDLoop();
+    }
+    pcmcOut = new AudioOutputPCMBuf();
+    if(psramFound()) pcmcBudget = PCMC_BUDGET_PSRAM;
+    for(int i = 0; i < PCMC_NUM; i++) {
+        if(pcmCache[i].flags & PCMC_PRELOAD) pcmCache[i].state = PCMC_WANT;
+    }
+
+    audCmdQ = xQueueCreate(AUD_CMDQ_LEN, sizeof(audCmd));
+    audCmdDone = xSemaphoreCreateBinary();
+    if(!audCmdQ || !audCmdDone || !out->start(AUD_TASK_CORE, AUD_PUMP_PRIO) ||
+       !AudioFileSourceLoop::startReader(AUD_TASK_CORE, AUD_READ_PRIO) ||
+       xTaskCreatePinnedToCore(audioTaskFunc, "audio", AUD_TASK_STACK, NULL, 
+                               AUD_TASK_PRIO, &audTask, AUD_TASK_CORE) != pdPASS) {
+        // No sound at all; play_*() and the music player do nothing
+        Serial.println("Failed to start audio task");
+        audFailed = true;
+        csf |= CSF_NOMUSIC;
+        return;
+    }
+    out->setProducer(audTask);
+
     loadCurVolume();
 
     setBeepLevel(beepLvlIdx);
@@ -333,34 +621,189 @@ static int checkAppend()
 }
 */
 
+/*
+ * Audio task
+ * 
+ * Executes commands from the main loop and runs the generators;
+ * decoded PCM goes into the ring buffer. When a generator is done,
+ * it is stopped and the main loop is notified through audRanOut;
+ * audio_loop() takes care of the rest.
+ */
+static void audioTaskFunc(void *arg)
+{
+    audCmd cmd;
+    bool busy;
+    
+    for(;;) {
+        while(xQueueReceive(audCmdQ, &cmd, 0) == pdTRUE) {
+            audCmdRes = aud_exec(&cmd);
+            xSemaphoreGive(audCmdDone);
+        }
+        
+        busy = false;
+        out->setQuota(AUD_DEC_QUOTA);
+        if(wav->isRunning()) {
+            if(wav->loop()) {
+                busy = true;
+            } else {
+                // Set before stop, so the main loop never sees
+                // the generator stopped without audRanOut
+                audRanOut = AR_WAV;
+                out->endOfStream();
+                wav->stop();
+            }
+        } else if(mp3->isRunning()) {
+            if(mp3->loop()) {
+                busy = true;
+            } else {
+                audRanOut = AR_MP3;
+                out->endOfStream();
+                mp3->stop();
+            }
+            // Gapless switch to prefetched track: The
+            // generator now reads from mySD1
+            if(mp3->SourceSwitched()) {
+                AudioFileSourceSDLoop *t = mySD0;
+                mySD0 = mySD1;
+                mySD1 = t;
+                out->markTrack();
+                mp_switchNext();
+            }
+        }
+        if(!busy && !audRanOut && !wav->isRunning() && !mp3->isRunning()) {
+            busy = pcmc_loadStep();
+        }
+
+        // Let lower priority tasks on this core run. If ring 
+        // is full, wait for the pump (or a command).
+        if(busy && out->getSpace() >= AUD_DEC_QUOTA) {
+            vTaskDelay(1);
+        } else {
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(busy ? 10 : 50));
+        }
+    }
+}
+
+// Post command to audio task and wait until it is executed
+static bool audioCmd(uint8_t cmd, const char *fn, uint32_t val)
+{
+    audCmd c = { .cmd = cmd, .val = val, .fn = fn };
+
+    if(audFailed) return false;
+
+    xQueueSend(audCmdQ, &c, portMAX_DELAY);
+    xTaskNotifyGive(audTask);
+    xSemaphoreTake(audCmdDone, portMAX_DELAY);
+
+    return audCmdRes;
+}
+
+// Called by audio task
+static bool aud_exec(const audCmd *c)
+{
+    AudioFileSourceLoop *src = NULL;
+    
+    switch(c->cmd) {
+    case AC_PLAY:
+        return aud_play(c->fn, c->val);
+    case AC_KEY:
+        aud_stop();
+        if(FlashROMode && mySD0->open(c->fn)) src = mySD0;
+        else if(haveFS && myFS0->open(c->fn)) src = myFS0;
+        if(!src) return false;
+        wav->beginQuick(src, out, 1, 32000, 44, (uint32_t)klens[c->val]);
+        src->startReadAhead();
+        break;
+    case AC_BEEP:
+        if(wav->isRunning()) {
+            out->discard();
+            wav->stop();
+        }
+        audRanOut = 0;
+        myPM->open(data_beep_wav, data_beep_wav_len);
+        wav->beginQuick(myPM, out, 1, 32000, 44, data_beep_wav_len - 44);
+        break;
+    case AC_STOP:
+        aud_stop();
+        break;
+    case AC_CANCEL:
+        mp_cancelNext();
+        break;
+    case AC_NEXT:
+        if(!mpActive || !mp3->isRunning()) return false;
+        mp3->SetNextSource(mySD1);
+        break;
+    case AC_NOLOOP:
+        if(haveSD) mySD0->setPlayLoop(false);
+        if(haveFS) myFS0->setPlayLoop(false);
+        break;
+    }
+
+    return true;
+}
+
+// Called by audio task
+static void aud_stop()
+{
+    mp_cancelNext();
+    if(mp3->isRunning()) {
+        out->discard();
+        mp3->stop();
+    } else if(wav->isRunning()) {
+        out->discard();
+        wav->stop();
+    }
+    audRanOut = 0;
+}
+
 /*
  * audio_loop()
  *
  */
 void audio_loop()
 {
-    if(wav->isRunning()) {
-        if(!wav->loop()) {
-            wav->stop();
+    // mpCurrIdx was updated by the audio task; the prefetch
+    // data is not touched until we prefetch again below
+    if(audTrackChanged) {
+        audTrackChanged = false;
+        aud_state.curTrack = playList[mpCurrIdx];
+        aud_state.curDuration = mpNextDur;
+        strcpy(id3artist, id3nartist);
+        strcpy(id3track, id3ntrack);
+        #ifdef TC_HAVEMQTT
+        mp_sendStatus();
+        #endif
+    }
+
+    if(audRanOut) {
+        // Generator already stopped by audio task
+        if(audRanOut == AR_WAV) {
+            audRanOut = 0;
             beepRunning = false;
+            key_playing = 0;
+            clear_sig_playing(alarmCanRunOut);
             //checkAppend();
-        }
-    } else if(mp3->isRunning()) {
-        if(!mp3->loop()) {
-            mp3->stop();
+        } else if(audRanOut == AR_MP3) {
+            audRanOut = 0;
             key_playing = 0;
             clear_sig_playing(alarmCanRunOut);
             if(mpActive) {    //if(!checkAppend() && mpActive) {
+                out->markTrack();
                 mp_next(true);
             }
-        } else if(dynVol) {
+        }
+    } else if(mp3->isRunning() || wav->isPlayingMem()) {
+        if(mpActive && mpNextIdx == -1 && !audTrackChanged) {
+            mp_prefetch();
+        }
+        if(dynVol) {
             sampleCnt++;
             if(sampleCnt > 1) {
                 out->SetGain(getVolume(), mutechannels);
                 sampleCnt = 0;
             }
         }
-    } else if(mpActive) {    //if(!checkAppend() && mpActive) {
+    } else if(mpActive && !wav->isRunning()) {    //if(!checkAppend() && mpActive) {
         pwrNeedFullNow();
         mp_next(true);
     }
@@ -372,21 +815,51 @@ void audio_loop()
 
 void audio_loop_quick()
 {
-    if(wav->isRunning()) {
-        if(!wav->loop()) {
-            wav->stop();
+    if(audRanOut) {
+        if(audRanOut == AR_WAV) {
             beepRunning = false;
+            key_playing = 0;
+            clear_sig_playing(alarmCanRunOut);
             //checkAppend();
-        }
-    } else if(mp3->isRunning()) {
-        if(!mp3->loop()) {
-            mp3->stop();
+        } else if(audRanOut == AR_MP3) {
             key_playing = 0;
             clear_sig_playing(alarmCanRunOut);
         }
+        audRanOut = 0;
     }
 }
 
+void getAudioStats(Aud_Stats *st)
+{
+    st->underruns   = out->getUnderruns();
+    st->minFill     = out->getMinFill();
+    st->maxFill     = out->getMaxFill();
+    st->ringSize    = AOR_FRAMES;
+    st->lastLatency = out->getLastLatency();
+    st->maxLatency  = out->getMaxLatency();
+    st->lastGap     = out->getLastGap();
+    st->maxGap      = out->getMaxGap();
+    st->cacheHits   = pcmcHits;
+    st->cacheMisses = pcmcMisses;
+    st->cacheUsed   = pcmcUsed;
+    st->cacheBudget = pcmcBudget;
+
+    afslStats ra;
+    AudioFileSourceLoop::getStats(&ra);
+    st->raFills     = ra.fills;
+    st->raAvoided   = ra.avoided;
+    st->raStalls    = ra.stalls;
+    st->raStallUs   = ra.stallUs;
+    st->raDirect    = ra.directFills;
+
+    AudioGeneratorMP3::Profile mp;
+    AudioGeneratorMP3::getProfile(&mp);
+    st->mp3Frames   = mp.frames;
+    st->mp3Input    = mp.frames ? mp.input / mp.frames : 0;
+    st->mp3Decode   = mp.frames ? mp.decode / mp.frames : 0;
+    st->mp3Synth    = mp.frames ? mp.synth / mp.frames : 0;
+}
+
 static int32_t skipID3(char *buf)
 {
     if(buf[0] == 'I' && buf[1] == 'D' && buf[2] == '3' && 
@@ -404,6 +877,209 @@ static int32_t skipID3(char *buf)
     return 0;
 }
 
+// Decode ID3 tags (if any), position source at first frame
+static void readID3(AudioFileSourceLoop *src, char *artist, char *track)
+{
+    int32_t pos;
+    char *id3 = (char *)malloc(MAXID3LEN);
+    
+    if(id3) {
+        id3[0] = 0;
+        src->read((void *)id3, 10);
+        if((pos = skipID3(id3))) {
+            int Id3Size = pos <= MAXID3LEN ? pos : MAXID3LEN;
+            src->read((void *)((char *)id3 + 10), Id3Size - 10);
+            decodeID3(artist, track, id3, Id3Size);
+        }
+        free(id3);
+        src->seek(pos, SEEK_SET);
+    }
+}
+
+/*
+ * PCM cache
+ */
+
+static void *pcmc_malloc(size_t size)
+{
+    return psramFound() ? ps_malloc(size) : malloc(size);
+}
+
+// Returns index of cache entry to play, or -1. Marks entry
+// for loading on first use.
+static int pcmc_lookup(const char *fn, uint32_t flags)
+{
+    if(flags & (PA_TCSEGS|PA_ISWAV|PA_LOOP|PA_DOID3TS|PA_MUSIC))
+        return -1;
+
+    // Cache is filled following the SD-first rule
+    if(!((flags & PA_ALLOWSD) || FlashROMode))
+        return -1;
+
+    for(int i = 0; i < PCMC_NUM; i++) {
+        if(!strcmp(fn, pcmCache[i].fn)) {
+            if(pcmCache[i].state == PCMC_READY) {
+                pcmCache[i].lastUse = millis();
+                pcmcHits++;
+                return i;
+            }
+            if(pcmCache[i].state == PCMC_NONE) {
+                pcmCache[i].state = PCMC_WANT;
+            }
+            pcmcMisses++;
+            return -1;
+        }
+    }
+
+    return -1;
+}
+
+// Free least recently used entries until "size" more bytes fit.
+// Entries in use are skipped.
+static bool pcmc_evict(uint32_t size, int keep)
+{
+    int lru;
+    
+    while(pcmcUsed + size > pcmcBudget) {
+        lru = -1;
+        for(int i = 0; i < PCMC_NUM; i++) {
+            if(i == keep || pcmCache[i].state != PCMC_READY) continue;
+            if(wav->isPlayingMem(pcmCache[i].data, pcmCache[i].frames)) continue;
+            if(lru < 0 || (long)(pcmCache[i].lastUse - pcmCache[lru].lastUse) < 0) lru = i;
+        }
+        if(lru < 0) return false;
+        #ifdef TC_DBG_AUDIO
+        Serial.printf("PCM cache: Evicting %s\n", pcmCache[lru].fn);
+        #endif
+        free(pcmCache[lru].data);
+        pcmCache[lru].data = NULL;
+        pcmcUsed -= pcmCache[lru].frames * pcmCache[lru].chnls * 2;
+        pcmCache[lru].state = PCMC_NONE;
+    }
+
+    return true;
+}
+
+static void pcmc_abort(int state, bool stopGen = true)
+{
+    if(stopGen) pcmcMP3->stop();
+    free(pcmcBuf);
+    pcmcBuf = NULL;
+    pcmCache[pcmcLoading].state = state;
+    pcmcLoading = -1;
+}
+
+// Decoded sound does not fit in pcmcBuf: Make more room and
+// retry, unless pcmcBuf was the whole budget already.
+static void pcmc_overflow()
+{
+    int state = PCMC_WANT;
+    
+    if(pcmcRoom >= pcmcBudget) {
+        #ifdef TC_DBG_AUDIO
+        Serial.printf("PCM cache: %s too big\n", pcmCache[pcmcLoading].fn);
+        #endif
+        state = PCMC_FAIL;
+    } else if(!pcmc_evict(pcmcRoom + 1, pcmcLoading)) {
+        state = PCMC_NONE;
+    }
+    pcmc_abort(state);
+}
+
+// Called by audio task when idle; decodes a chunk of the next 
+// wanted sound. Returns true if there is more to do.
+static bool pcmc_loadStep()
+{
+    pcmCacheEntry *e;
+    AudioFileSourceLoop *src = NULL;
+    uint32_t size;
+    char buf[10];
+    int32_t pos;
+    
+    if(pcmcLoading < 0) {
+        for(int i = 0; i < PCMC_NUM; i++) {
+            if(pcmCache[i].state == PCMC_WANT) {
+                pcmcLoading = i;
+                break;
+            }
+        }
+        if(pcmcLoading < 0) return false;
+        
+        e = &pcmCache[pcmcLoading];
+        if(haveSD && pcmcSD->open(e->fn)) src = pcmcSD;
+        else if(haveFS && pcmcFS->open(e->fn)) src = pcmcFS;
+        if(!src) {
+            e->state = PCMC_FAIL;
+            pcmcLoading = -1;
+            return true;
+        }
+        // Need some room to start with
+        if(pcmcUsed >= pcmcBudget && !pcmc_evict(1, pcmcLoading)) {
+            src->close();
+            e->state = PCMC_NONE;
+            pcmcLoading = -1;
+            return false;
+        }
+        pcmcRoom = pcmcBudget - pcmcUsed;
+        if(!(pcmcBuf = (int16_t *)pcmc_malloc(pcmcRoom))) {
+            src->close();
+            e->state = PCMC_NONE;
+            pcmcLoading = -1;
+            return false;
+        }
+        src->setPlayLoop(false);
+        src->read((void *)buf, 10);
+        pos = skipID3(buf);
+        src->seek(pos, SEEK_SET);
+        pcmcOut->setBuffer(pcmcBuf, pcmcRoom / 2);
+        if(!pcmcMP3->begin(src, pcmcOut)) {
+            src->close();
+            pcmc_abort(PCMC_FAIL, false);
+            return true;
+        }
+        e->state = PCMC_LOAD;
+    }
+
+    e = &pcmCache[pcmcLoading];
+
+    pcmcOut->setQuota(AUD_DEC_QUOTA);
+    if(pcmcMP3->loop()) {
+        if(pcmcOut->overflow()) {
+            pcmc_overflow();
+        }
+        return true;
+    }
+
+    // Done decoding
+    if(pcmcOut->overflow()) {
+        pcmc_overflow();
+        return true;
+    }
+    size = pcmcOut->getLen() * 2;
+    if(!size || !pcmc_evict(size, pcmcLoading)) {
+        pcmc_abort(size ? PCMC_NONE : PCMC_FAIL);
+        return true;
+    }
+    pcmcMP3->stop();
+    
+    e->data = (int16_t *)(psramFound() ? ps_realloc(pcmcBuf, size) : realloc(pcmcBuf, size));
+    if(!e->data) e->data = pcmcBuf;
+    pcmcBuf = NULL;
+    e->chnls = pcmcOut->getChannels();
+    e->rate = pcmcOut->getRate();
+    e->frames = size / 2 / e->chnls;
+    e->lastUse = millis();
+    e->state = PCMC_READY;
+    pcmcUsed += size;
+    pcmcLoading = -1;
+
+    #ifdef TC_DBG_AUDIO
+    Serial.printf("PCM cache: Loaded %s (%d bytes, %d total)\n", e->fn, size, pcmcUsed);
+    #endif
+
+    return true;
+}
+
 /*
 void append_file(const char *audio_file, uint32_t flags, float volumeFactor)
 {
@@ -422,14 +1098,14 @@ void append_file(const char *audio_file, uint32_t flags, float volumeFactor)
 
 void play_file(const char *audio_file, uint32_t flags, float volumeFactor)
 {
-    char buf[10];
-    int32_t pos = 0;
     #ifdef TC_HAVEMQTT
     bool mpWasActive = false;
     #endif
 
     //appendFile = 0;   // Clear appended, append must be called AFTER play_file
 
+    if(audFailed) return;
+
     // Only signals can interrupt signals
     if(sig_playing & PA_SIGNAL) {
         if(!(flags & PA_SIGNAL)) return;
@@ -452,8 +1128,11 @@ void play_file(const char *audio_file, uint32_t flags, float volumeFactor)
     Serial.printf("Audio: Playing %s\n", audio_file);
     #endif
 
-    // If something is currently on, kill it
-    stopAudio();
+    out->setTrigger(micros());
+
+    // If something is currently on, AC_PLAY kills it
+    key_playing = 0;
+    clear_sig_playing();
     beepRunning = false;
 
     mutechannels = alarmCanRunOut = 0;
@@ -492,34 +1171,53 @@ void play_file(const char *audio_file, uint32_t flags, float volumeFactor)
 
     out->SetGain(getVolume(), mutechannels);
 
-    buf[0] = 0;
+    if(!audioCmd(AC_PLAY, audio_file, flags)) {
+        key_playing = 0;
+        clear_sig_playing();
+        #ifdef TC_DBG_AUDIO
+        Serial.println("Audio file not found");
+        #endif
+    }
 
-    if(flags & PA_TCSEGS) {
-        if(haveTCC && (mySD0->c = t) && mySD0->open_c(tcc_fn, (const int16_t *)audio_file)) {
-            if(flags & PA_ISWAV) {
-                wav->begin(mySD0, out);
-            } else {
-                mp3->begin(mySD0, out);
-            }
+    #ifdef TC_HAVEMQTT
+    if(mpWasActive) mp_sendStatus();
+    #endif
+}
+
+// Called by audio task (AC_PLAY). Returns false if file not found.
+static bool aud_play(const char *audio_file, uint32_t flags)
+{
+    char buf[10];
+    int32_t pos = 0;
+    int ci;
+
+    aud_stop();
+
+    // Speaker amp mixes to mono; line-out needs stereo
+    mp3->SetMono(!playLineOut);
+
+    if((ci = pcmc_lookup(audio_file, flags)) >= 0) {
+        myPM->open(pcmCache[ci].data, pcmCache[ci].frames * pcmCache[ci].chnls * 2);
+        wav->beginMem(myPM, out, pcmCache[ci].chnls, pcmCache[ci].rate, pcmCache[ci].data, pcmCache[ci].frames);
+        #ifdef TC_DBG_AUDIO
+        Serial.println("Playing from PCM cache");
+        #endif
+    } else if(flags & PA_TCSEGS) {
+        if(!haveTCC || !(mySD0->c = t) || !mySD0->open_c(tcc_fn, (const int16_t *)audio_file))
+            return false;
+        if(flags & PA_ISWAV) {
+            wav->begin(mySD0, out);
+        } else {
+            mp3->begin(mySD0, out);
         }
+        mySD0->startReadAhead();
     } else if(haveSD && ((flags & PA_ALLOWSD) || FlashROMode) && mySD0->open(audio_file)) {
         mySD0->setPlayLoop(false);
         if(flags & PA_ISWAV) {
             wav->begin(mySD0, out);
         } else {
             if(flags & PA_DOID3TS) {
-                char *id3 = (char *)malloc(MAXID3LEN);
-                if(id3) {
-                    id3[0] = 0;
-                    mySD0->read((void *)id3, 10);
-                    if((pos = skipID3(id3))) {
-                        int Id3Size = pos <= MAXID3LEN ? pos : MAXID3LEN;
-                        mySD0->read((void *)((char *)id3 + 10), Id3Size - 10);
-                        decodeID3(id3artist, id3track, id3, Id3Size);
-                    }
-                    free(id3);
-                    mySD0->seek(pos, SEEK_SET);
-                }
+                readID3(mySD0, id3artist, id3track);
             } else {
                 mySD0->setPlayLoop(!!(flags & PA_LOOP));
                 mySD0->read((void *)buf, 10);
@@ -529,6 +1227,7 @@ void play_file(const char *audio_file, uint32_t flags, float volumeFactor)
             }
             mp3->begin(mySD0, out);
         }
+        mySD0->startReadAhead();
         #ifdef TC_DBG_AUDIO
         Serial.println("Playing from SD");
         #endif
@@ -544,20 +1243,15 @@ void play_file(const char *audio_file, uint32_t flags, float volumeFactor)
             myFS0->seek(pos, SEEK_SET);
             mp3->begin(myFS0, out);
         }
+        myFS0->startReadAhead();
         #ifdef TC_DBG_AUDIO
         Serial.println("Playing from flash FS");
         #endif
     } else {
-        key_playing = 0;
-        clear_sig_playing();
-        #ifdef TC_DBG_AUDIO
-        Serial.println("Audio file not found");
-        #endif
+        return false;
     }
 
-    #ifdef TC_HAVEMQTT
-    if(mpWasActive) mp_sendStatus();
-    #endif
+    return true;
 }
 
 /*
@@ -568,15 +1262,19 @@ void play_file(const char *audio_file, uint32_t flags, float volumeFactor)
 uint32_t play_keypad_sound(char key)
 {
     uint32_t kp = key_playing;
-    AudioFileSource *src = NULL;
     
     dtmfBuf[6] = key;
 
-    if(mpActive || sig_playing) return kp;
+    if(audFailed || mpActive || sig_playing) return kp;
 
     pwrNeedFullNow();
 
-    stopAudio();    // Clears key_playing, sig_playing, id3
+    out->setTrigger(micros());
+
+    // AC_KEY stops whatever is playing
+    key_playing = 0;
+    clear_sig_playing();
+    *id3artist = *id3track = 0;
     beepRunning = playLineOut = false;
     setLineOut(playLineOut);
     mutechannels = 0;
@@ -588,12 +1286,8 @@ uint32_t play_keypad_sound(char key)
 
     out->SetGain(getVolume(), 0);
 
-    if(FlashROMode && mySD0->open(dtmfBuf)) src = mySD0;
-    else if(haveFS && myFS0->open(dtmfBuf)) src = myFS0;
-
-    if(src) {
-        wav->beginQuick(src, out, 1, 32000, 44, (uint32_t)klens[key-'0']);
-    }
+    audioCmd(AC_KEY, dtmfBuf, key - '0');
+    
     return kp;
 }
 
@@ -617,7 +1311,8 @@ void play_beep()
 {
     bool wavRunning = wav->isRunning();
     
-    if(muteBeep                               ||
+    if(audFailed                              ||
+       muteBeep                               ||
        mp3->isRunning()                       ||
        (csf & (CSF_NM|CSF_OFF|CSF_AL|CSF_AE)) ||
        mpActive                               ||
@@ -628,9 +1323,7 @@ void play_beep()
 
     pwrNeedFullNow();
 
-    if(wavRunning) {
-        wav->stop();
-    }
+    out->setTrigger(micros());
 
     setLineOut(false);
     playLineOut = false;
@@ -647,9 +1340,8 @@ void play_beep()
     clear_sig_playing();
     *id3artist = *id3track = 0;
 
-    myPM->open(data_beep_wav, data_beep_wav_len);
-    wav->beginQuick(myPM, out, 1, 32000, 44, data_beep_wav_len - 44);
-    beepRunning = true;
+    // AC_BEEP stops a running beep
+    beepRunning = audioCmd(AC_BEEP);
 }
 
 void play_key(int k, uint32_t preDTMFkp)
@@ -911,11 +1603,7 @@ bool isUISignalPlaying()
 
 void stopAudio()
 {
-    if(mp3->isRunning()) {
-        mp3->stop();
-    } else if(wav->isRunning()) {
-        wav->stop();
-    }
+    audioCmd(AC_STOP);
     key_playing = 0;    
     clear_sig_playing();
     *id3artist = *id3track = 0;
@@ -933,8 +1621,7 @@ void stopAlarm(bool force)
 {
     if(sig_playing & PA_ALARM) {
         if(!force && (sig_playing & PA_LOOP)) {
-            if(haveSD) mySD0->setPlayLoop(false);
-            if(haveFS) myFS0->setPlayLoop(false);
+            audioCmd(AC_NOLOOP);
         } else {
             stopAudio();
         }
@@ -1137,15 +1824,18 @@ static void decodeID3(char *artist, char *track, char *id3, int Id3Size)
  
 void mp_init(bool isSetup)
 {
-    char fnbuf[20];
-    
     csf |= CSF_NOMUSIC;
 
+    audioCmd(AC_CANCEL);
+
     if(playList) {
         free(playList);
         playList = NULL;
     }
 
+    if(mpIdxFile) mpIdxFile.close();
+    mpIdx.count = 0;
+
     mpCurrIdx = aud_state.curTrack = aud_state.maxMusic = 0;
     
     if(haveSD) {
@@ -1153,10 +1843,9 @@ void mp_init(bool isSetup)
         Serial.println("MusicPlayer: Checking for music files");
         #endif
 
-        mp_renameFilesInDir(isSetup);
+        mp_indexFiles(isSetup);
 
-        mp_buildFileName(fnbuf, 0);
-        if(SD.exists(fnbuf)) {
+        if(mpidx_load()) {
             csf &= ~CSF_NOMUSIC;
             
             aud_state.maxMusic = mp_findMaxNum();
@@ -1184,7 +1873,7 @@ void mp_init(bool isSetup)
 
         } else {
             #ifdef TC_DBG_MP
-            Serial.printf("MusicPlayer: Failed to open %s\n", fnbuf);
+            Serial.printf("MusicPlayer: No music in folder %d\n", musFolderNum);
             #endif
         }
     }
@@ -1194,38 +1883,9 @@ void mp_init(bool isSetup)
     #endif
 }
 
-static bool mp_checkForFile(int num)
-{
-    char fnbuf[20];
-
-    if(num > 999) return false;
-
-    mp_buildFileName(fnbuf, num);
-    if(SD.exists(fnbuf)) {
-        return true;
-    }
-    return false;
-}
-
 static int mp_findMaxNum()
 {
-    int i, j;
-
-    for(j = 256, i = 512; j >= 2; j >>= 1) {
-        if(mp_checkForFile(i)) {
-            i += j;    
-        } else {
-            i -= j;
-        }
-    }
-    if(mp_checkForFile(i)) {
-        if(mp_checkForFile(i+1)) i++;
-    } else {
-        i--;
-        if(!mp_checkForFile(i)) i--;
-    }
-
-    return i;
+    return mpIdx.count - 1;
 }
 
 void mp_makeShuffle(bool enable)
@@ -1235,6 +1895,8 @@ void mp_makeShuffle(bool enable)
     aud_state.mpShuffle = enable ? 1 : 0;
     saveShuffle();
 
+    audioCmd(AC_CANCEL);
+
     if(!(csf & CSF_NOMUSIC)) {
     
         for(int i = 0; i < numMsx; i++) {
@@ -1267,9 +1929,12 @@ void mp_makeShuffle(bool enable)
 
 void mp_play(bool forcePlay)
 {
-    int oldIdx = mpCurrIdx;
+    int oldIdx;
 
     if((csf & CSF_NOMUSIC) || isSignalPlaying()) return;
+
+    mp_sync();
+    oldIdx = mpCurrIdx;
     
     do {
         if(mp_play_int(forcePlay)) {
@@ -1285,7 +1950,8 @@ bool mp_stop(bool forceStatus)
     bool ret = mpActive;
     
     if(mpActive) {
-        mp3->stop();
+        audioCmd(AC_STOP);
+        audTrackChanged = false;
         mpActive = false;
         *id3artist = *id3track = 0;
         #ifdef TC_HAVEMQTT
@@ -1312,9 +1978,12 @@ void mp_prev(bool forcePlay)
 
 static void mp_nextprev(bool forcePlay, bool next)
 {
-    int oldIdx = mpCurrIdx;
+    int oldIdx;
 
     if((csf & CSF_NOMUSIC) || isSignalPlaying()) return;
+
+    mp_sync();
+    oldIdx = mpCurrIdx;
     
     do {
         if(next) {
@@ -1337,6 +2006,8 @@ int mp_gotonum(int num, bool forcePlay)
     if(num < 0) num = 0;
     else if(num > aud_state.maxMusic) num = aud_state.maxMusic;
 
+    mp_sync();
+
     if(aud_state.mpShuffle) {
         for(int i = 0; i <= aud_state.maxMusic; i++) {
             if(playList[i] == num) {
@@ -1354,13 +2025,14 @@ int mp_gotonum(int num, bool forcePlay)
 
 static bool mp_play_int(bool force)
 {
-    char fnbuf[20];
+    char fnbuf[MP_FNLEN];
+    uint16_t dur;
 
-    mp_buildFileName(fnbuf, playList[mpCurrIdx]);
-    if(SD.exists(fnbuf)) {
+    if(mp_buildFileName(fnbuf, playList[mpCurrIdx], &dur) && SD.exists(fnbuf)) {
         if(force) play_file(fnbuf, PA_MUSIC|PA_LINEOUT|PA_DOID3TS|PA_CHECKNM|PA_INTRMUS|PA_ALLOWSD|PA_DYNVOL);
         mpActive = force;
         aud_state.curTrack = playList[mpCurrIdx];
+        aud_state.curDuration = dur;
         #ifdef TC_HAVEMQTT
         mp_sendStatus();
         #endif
@@ -1386,12 +2058,13 @@ void mp_sendStatus(int force)
             static const char statec[] = "OPI";
             char msg[128];
             sprintf(msg, 
-                "{\"S\":\"%c\",\"C\":\"%d\",\"V\":\"%d\",\"F\":\"0\",\"L\":\"%d\",\"SH\":\"%d\"}", 
+                "{\"S\":\"%c\",\"C\":\"%d\",\"V\":\"%d\",\"F\":\"0\",\"L\":\"%d\",\"SH\":\"%d\",\"D\":\"%d\"}", 
                     statec[aud_state.state], 
                     aud_state.curTrack, 
                     (aud_state.curVolume == 255) ? -1 : (aud_state.curVolume * 100 / (VOL_LEVELS - 1)), 
                     aud_state.maxMusic, 
-                    aud_state.mpShuffle);
+                    aud_state.mpShuffle,
+                    aud_state.curDuration);
             if(mqttPublish("bttf/tcd/mpstatus", msg, strlen(msg) + 1)) {
                 memcpy((void *)&mpOldState, (void *)&aud_state, sizeof(aud_state));
             } else {
@@ -1402,9 +2075,123 @@ void mp_sendStatus(int force)
 }
 #endif
 
-static void mp_buildFileName(char *fnbuf, int num)
+// Resolve track number through index; fnbuf must hold MP_FNLEN
+static bool mp_buildFileName(char *fnbuf, int num, uint16_t *dur)
 {
-    sprintf(fnbuf, "/music%1d/%03d.mp3", musFolderNum, num);
+    mpIdxEnt e;
+
+    if(num < 0 || num >= mpIdx.count || !mpIdxFile) return false;
+
+    sprintf(fnbuf, "/music%1d/", musFolderNum);
+    if(!mpidx_readEnt(mpIdxFile, &mpIdx, num, &e, fnbuf + 8))
+        return false;
+
+    if(dur) *dur = e.duration;
+    
+    return true;
+}
+
+// Load current folder's index header; index file stays
+// open for mp_buildFileName() until next mp_init()
+static bool mpidx_load()
+{
+    char fnbuf[32];
+    
+    mpIdx.count = 0;
+
+    mpidx_fileName(fnbuf, musFolderNum);
+    if((mpIdxFile = SD.open(fnbuf, FILE_READ))) {
+        if(!mpidx_readHdr(mpIdxFile, &mpIdx)) mpIdx.count = 0;
+        if(!mpIdx.count) mpIdxFile.close();
+    }
+
+    return (mpIdx.count > 0);
+}
+
+/*
+ * Gapless playback: While a track plays, open the next one
+ * (in play list order), skip its ID3 tag and start read-ahead. 
+ * The decoder continues with it at the end of the current one;
+ * the audio task then updates mpCurrIdx (mp_switchNext()).
+ * mpCurrIdx is stable here: No next source is pending.
+ */
+static void mp_prefetch()
+{
+    char fnbuf[MP_FNLEN];
+    uint16_t dur = 0;
+    int  idx = mpCurrIdx;
+    bool found = false;
+
+    mpNextIdx = -2;
+    
+    if(!mySD1 || (csf & CSF_NOMUSIC)) return;
+
+    // Same order as mp_next()
+    do {
+        idx++;
+        if(idx > aud_state.maxMusic) idx = 0;
+        if(mp_buildFileName(fnbuf, playList[idx], &dur) && SD.exists(fnbuf)) {
+            found = true;
+            break;
+        }
+    } while(idx != mpCurrIdx);
+
+    if(!found) return;
+
+    // mySD1 is not used by the audio task until handed 
+    // to the decoder through AC_NEXT
+    if(!mySD1->open(fnbuf)) return;
+    
+    mySD1->setPlayLoop(false);
+    *id3nartist = *id3ntrack = 0;
+    readID3(mySD1, id3nartist, id3ntrack);
+    mySD1->startReadAhead();
+
+    // Set before AC_NEXT, the switch may follow right after
+    mpNextIdx = idx;
+    mpNextDur = dur;
+    if(!audioCmd(AC_NEXT)) {
+        mpNextIdx = -2;
+        mySD1->close();
+    }
+
+    #ifdef TC_DBG_MP
+    Serial.printf("MusicPlayer: Prefetched %s\n", fnbuf);
+    #endif
+}
+
+// Called by audio task
+static void mp_cancelNext()
+{
+    if(mySD1 && mpNextIdx >= 0) {
+        mp3->SetNextSource(NULL);
+        mySD1->close();
+    }
+    mpNextIdx = -1;
+}
+
+// Before using mpCurrIdx: Cancel prefetch, so the audio task
+// can no longer switch tracks. A pending track change is
+// dropped; callers update aud_state through mp_play_int().
+static void mp_sync()
+{
+    audioCmd(AC_CANCEL);
+    audTrackChanged = false;
+}
+
+// Called by audio task after the decoder switched to the
+// prefetched track. Since commands are executed by the same
+// task, mpCurrIdx is current for any command's caller.
+static void mp_switchNext()
+{
+    if(mpNextIdx >= 0) {
+        mpCurrIdx = mpNextIdx;
+    }
+    // Publish change first: audio_loop() (other core) must not
+    // see "nothing prefetched" before the change, or it would
+    // prefetch over the new track's ID3 data and duration
+    audTrackChanged = true;
+    mpNextIdx = -1;
 }
 
 // For keypad menu only
@@ -1413,10 +2200,10 @@ int mp_checkForFolder(int num)
     char fnbuf[32];
 
     // returns 
-    // 1 if folder is ready (contains 000.mp3 and DONE)
+    // 1 if folder is ready (contains index and DONE)
     // 0 if folder does not exist
-    // -1 if folder exists but needs processing (no DONE)
-    // -2 if musicX contains no audio files (DONE but no 000.mp3)
+    // -1 if folder exists but needs processing (no DONE or no index)
+    // -2 if musicX contains no audio files (DONE, but empty index)
     // -3 if musicX is not a folder
     // -4 if no SD
 
@@ -1444,27 +2231,26 @@ int mp_checkForFolder(int num)
     // Check if DONE exists
     strcat(fnbuf, tcdrdone);
     if(SD.exists(fnbuf)) {
-        strcpy(fnbuf + 8, "000.mp3");
-        if(SD.exists(fnbuf)) {
-            // If 000.mp3 and DONE exists, return 1
+        int n = mpidx_getCount(num);
+        if(n > 0) {
+            // If index and DONE exist, return 1
             return 1;
         }
-        // If DONE, but no 000.mp3, assume no audio files
-        return -2;
+        // If DONE, and empty index, assume no audio files
+        if(!n) return -2;
     }
       
-    // DONE not present: Needs processing
+    // DONE or index not present: Needs processing
     return -1;
 }
 
 /*
- * Auto-renamer
+ * Auto-indexer
  */
 
-// Check file is eligible for renaming:
+// Check file is eligible for index:
 // - not a hidden/exAtt file,
 // - file name ends with ".mp3"
-// - filename not already "/musicX/ddd.mp3"
 static bool mpren_checkFN(const char *buf)
 {
     // Hidden or macOS exAttr file? Ignore.
@@ -1484,25 +2270,12 @@ static bool mpren_checkFN(const char *buf)
     if(buf[s+2] != 'p' && buf[s+2] != 'P')
         return true;
 
-    // Now check for xxx.mp3 (xxx=000-999)
-
-    // Filename shorter or longer? Do it.
-    if(s != 3)
-        return false;
-
-    // Filename not a 3-digit number? Do it.
-    if(buf[0] < '0' || buf[0] > '9' ||
-       buf[1] < '0' || buf[1] > '9' ||
-       buf[2] < '0' || buf[2] > '9')
-        return false;
-
-    // Otherwise ignore.
-    return true;
+    return false;
 }
 
 static void mpren_showHeadLine(bool checking)
 {
-    destinationTime.showTextDirect(checking ? "CHECKING" : "RENAMING");
+    destinationTime.showTextDirect(checking ? "CHECKING" : "INDEXING");
     presentTime.showTextDirect("MUSIC FILES");
 }
 
@@ -1555,13 +2328,249 @@ static void mpren_looper(bool isSetup, bool checking, int fileNum)
     }
 }
 
-static bool mp_renameFilesInDir(bool isSetup)
+/*
+ * Music folder index
+ *
+ * /musicX/TCD_IDX.BIN lists the folder's mp3 files in sort order,
+ * so the files keep their original names. Track number n is entry
+ * n. Layout: mpIdxHdr, count x mpIdxEnt, name pool (0-terminated
+ * names relative to folder).
+ */
+
+static void mpidx_fileName(char *fnbuf, int folder)
+{
+    sprintf(fnbuf, "/music%1d%s", folder, tcdridx);
+}
+
+static bool mpidx_readHdr(File& f, mpIdxHdr *h)
+{
+    if(f.read((uint8_t *)h, sizeof(*h)) != sizeof(*h))
+        return false;
+
+    return (h->magic == MPIDX_MAGIC && h->version == MPIDX_VERSION &&
+            h->nameBase == sizeof(*h) + h->count * sizeof(mpIdxEnt));
+}
+
+static bool mpidx_getHdr(int folder, mpIdxHdr *h)
+{
+    char fnbuf[32];
+    bool ret = false;
+
+    mpidx_fileName(fnbuf, folder);
+    File f = SD.open(fnbuf, FILE_READ);
+    if(f) {
+        ret = mpidx_readHdr(f, h);
+        f.close();
+    }
+
+    return ret;
+}
+
+// Returns number of tracks, -1 if no (valid) index
+static int mpidx_getCount(int folder)
+{
+    mpIdxHdr h;
+
+    return mpidx_getHdr(folder, &h) ? h.count : -1;
+}
+
+// Folder signature: Sum of name hashes, so independent of
+// directory order. Names only; getting sizes means opening
+// every file.
+static uint32_t mpidx_sigAdd(uint32_t sig, const char *name)
+{
+    uint32_t hash = 2166136261UL;
+
+    while(*name) {
+        hash = (hash ^ (uint8_t)*name++) * 16777619UL;
+    }
+
+    return sig + hash;
+}
+
+// Read entry "num" from open index file; name to "name" (if not NULL)
+static bool mpidx_readEnt(File& f, const mpIdxHdr *h, int num, mpIdxEnt *e, char *name)
+{
+    if(!f.seek(sizeof(mpIdxHdr) + num * sizeof(mpIdxEnt)))
+        return false;
+    if(f.read((uint8_t *)e, sizeof(*e)) != sizeof(*e))
+        return false;
+    if(name) {
+        if(!f.seek(h->nameBase + e->nameOffs))
+            return false;
+        if(f.read((uint8_t *)name, e->nameLen) != e->nameLen)
+            return false;
+        name[e->nameLen] = 0;
+    }
+
+    return true;
+}
+
+// Duration in seconds, estimated from first frame's bitrate
+static uint16_t mpidx_duration(const uint8_t *h, uint32_t bytes)
+{
+    static const uint16_t br1[15] = { 0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320 };
+    static const uint16_t br2[15] = { 0,  8, 16, 24, 32, 40, 48, 56,  64,  80,  96, 112, 128, 144, 160 };
+    int bri = h[2] >> 4;
+    uint32_t kbps;
+
+    // Sync, Layer III, valid bitrate index
+    if(h[0] != 0xff || (h[1] & 0xe0) != 0xe0 || ((h[1] >> 1) & 3) != 1 || !bri || bri > 14)
+        return 0;
+
+    // MPEG1 or MPEG2/2.5
+    kbps = (((h[1] >> 3) & 3) == 3) ? br1[bri] : br2[bri];
+
+    return bytes / (kbps * 125);
+}
+
+// Get duration (from first frame after ID3v2 tag), and size
+// if unknown
+static void mpidx_probe(const char *fn, mpIdxEnt *e)
+{
+    char buf[10];
+    uint32_t audioOffs;
+
+    e->duration = 0;
+
+    File f = SD.open(fn, FILE_READ);
+    if(!f) {
+        if(e->size == MPIDX_NOSIZE) e->size = 0;
+        return;
+    }
+    if(e->size == MPIDX_NOSIZE) e->size = f.size();
+
+    if(f.read((uint8_t *)buf, 10) == 10) {
+        audioOffs = skipID3(buf);
+        if(f.seek(audioOffs) && f.read((uint8_t *)buf, 4) == 4 && e->size > audioOffs) {
+            e->duration = mpidx_duration((uint8_t *)buf, e->size - audioOffs);
+        }
+    }
+    f.close();
+}
+
+// File size as stored behind name by mp_indexFiles();
+// MPIDX_NOSIZE if not known from the directory scan
+static uint32_t mpidx_nameSize(const char *name)
+{
+    uint32_t size;
+
+    memcpy(&size, name + strlen(name) + 1, 4);
+
+    return size;
+}
+
+/*
+ * Write index for sorted file names a[0..n-1]. With "reuse",
+ * files that are in the old index (with the same size, if known)
+ * are not opened again; since both lists are in the same order,
+ * the old index is read sequentially alongside.
+ */
+static bool mpidx_write(char **a, int n, uint32_t sig, bool reuse, bool isSetup)
+{
+    char fnbuf[264];
+    char oname[256];
+    char idxfn[32], tmpfn[32];
+    mpIdxHdr h, oh;
+    mpIdxEnt e, oe;
+    uint32_t nameOffs = 0;
+    int oi = 0, ocount = 0, oc = 1;
+    bool haveOld = false, ret = false;
+    File of, f;
+
+    mpidx_fileName(idxfn, musFolderNum);
+    strcpy(tmpfn, idxfn);
+    strcpy(tmpfn + strlen(tmpfn) - 3, "TMP");
+
+    if(reuse && (of = SD.open(idxfn, FILE_READ))) {
+        if(mpidx_readHdr(of, &oh)) {
+            ocount = oh.count;
+        }
+    }
+    
+    if(!(f = SD.open(tmpfn, FILE_WRITE))) {
+        if(of) of.close();
+        return false;
+    }
+
+    h.magic = MPIDX_MAGIC;
+    h.version = MPIDX_VERSION;
+    h.count = n;
+    h.nameBase = sizeof(h) + n * sizeof(mpIdxEnt);
+    h.sig = sig;
+    if(f.write((uint8_t *)&h, sizeof(h)) != sizeof(h)) goto out;
+
+    sprintf(fnbuf, "/music%1d/", musFolderNum);
+
+    for(int i = 0; i < n; i++) {
+
+        mpren_looper(isSetup, false, n - i);
+
+        e.nameOffs = nameOffs;
+        e.nameLen = strlen(a[i]);
+        e.size = mpidx_nameSize(a[i]);
+        e.flags = 0;
+        nameOffs += e.nameLen + 1;
+
+        // Advance in old index up to our name
+        while(oi < ocount) {
+            if(!haveOld) {
+                if(!mpidx_readEnt(of, &oh, oi, &oe, oname)) {
+                    ocount = 0;
+                    break;
+                }
+                haveOld = true;
+            }
+            if((oc = mpren_cmp(oname, a[i])) >= 0) break;
+            oi++;
+            haveOld = false;
+        }
+
+        if(haveOld && !oc && (e.size == MPIDX_NOSIZE || oe.size == e.size)) {
+            e.size = oe.size;
+            e.duration = oe.duration;
+        } else {
+            strcpy(fnbuf + 8, a[i]);
+            mpidx_probe(fnbuf, &e);
+            #ifdef TC_DBG_MP
+            Serial.printf("MusicPlayer/Indexer: Probed '%s': %d bytes, %ds\n", a[i], e.size, e.duration);
+            #endif
+        }
+        if(haveOld && !oc) {
+            oi++;
+            haveOld = false;
+        }
+        
+        if(f.write((uint8_t *)&e, sizeof(e)) != sizeof(e)) goto out;
+    }
+
+    for(int i = 0; i < n; i++) {
+        size_t l = strlen(a[i]) + 1;
+        if(f.write((uint8_t *)a[i], l) != l) goto out;
+    }
+
+    ret = true;
+
+out:
+    f.close();
+    if(of) of.close();
+
+    if(ret) {
+        SD.remove(idxfn);
+        ret = SD.rename(tmpfn, idxfn);
+    } else {
+        SD.remove(tmpfn);
+    }
+
+    return ret;
+}
+
+static bool mp_indexFiles(bool isSetup)
 {
     char fnbuf[20];
     char fnbuf3[32];
     char **a, **d;
     char *c;
-    int count = 0;
     int fileNum = 0;
     int strLength;
     int nameOffs = 8;
@@ -1571,13 +2580,16 @@ static bool mp_renameFilesInDir(bool isSetup)
     };
     char *bufs[8] = { NULL };
     unsigned long sz, bufSize;
+    uint32_t fsize = MPIDX_NOSIZE, sig = 0;
+    mpIdxHdr oh;
     bool stopLoop = false;
     bool hls = false;
+    bool haveIdx, idxOk;
 #ifdef HAVE_GETNEXTFILENAME
     bool isDir;
 #endif
     #ifdef TC_DBG_MP
-    const char *funcName = "MusicPlayer/Renamer: ";
+    const char *funcName = "MusicPlayer/Indexer: ";
     #endif
 
     headLineShown = false;
@@ -1589,13 +2601,10 @@ static bool mp_renameFilesInDir(bool isSetup)
     strcpy(fnbuf3, fnbuf);
     strcat(fnbuf3, tcdrdone);
 
-    // Check for DONE file
-    if(SD.exists(fnbuf3)) {
-        #ifdef TC_DBG_MP
-        Serial.printf("%s%s exists\n", funcName, fnbuf3);
-        #endif
-        return true;
-    }
+    // Check for DONE file and index; if both exist, the index
+    // is only rewritten if file names have changed (count and
+    // signature; no files are opened for this)
+    haveIdx = SD.exists(fnbuf3) && mpidx_getHdr(musFolderNum, &oh);
 
     // Check if folder exists
     if(!SD.exists(fnbuf)) {
@@ -1651,7 +2660,7 @@ static bool mp_renameFilesInDir(bool isSetup)
         if(!isDir) {
             const char *fn = fileName.c_str();
             strLength = strlen(fn);
-            sz = strLength - nameOffs + 1;
+            sz = strLength - nameOffs + 1 + 4;
             if((sz > bufSize) && (allocBufIdx < 7)) {
                 allocBufIdx++;
                 if(!(bufs[allocBufIdx] = (char *)malloc(bufSizes[allocBufIdx]))) {
@@ -1668,8 +2677,11 @@ static bool mp_renameFilesInDir(bool isSetup)
             }
             if((strLength < 256) && (sz <= bufSize)) {
                 if(!mpren_checkFN(fn + nameOffs)) {
+                    // Name only; size is looked up for new files
                     *d++ = c;
                     strcpy(c, fn + nameOffs);
+                    memcpy(c + sz - 4, &fsize, 4);
+                    sig = mpidx_sigAdd(sig, c);
                     #ifdef TC_DBG_MP
                     Serial.printf("%sAdding '%s'\n", funcName, c);
                     #endif
@@ -1689,7 +2701,7 @@ static bool mp_renameFilesInDir(bool isSetup)
 
         if(!file.isDirectory()) {
             strLength = strlen(file.name());
-            sz = strLength - nameOffs + 1;
+            sz = strLength - nameOffs + 1 + 4;
             if((sz > bufSize) && (allocBufIdx < 7)) {
                 allocBufIdx++;
                 if(!(bufs[allocBufIdx] = (char *)malloc(bufSizes[allocBufIdx]))) {
@@ -1706,8 +2718,11 @@ static bool mp_renameFilesInDir(bool isSetup)
             }
             if((strLength < 256) && (sz <= bufSize)) {
                 if(!mpren_checkFN(file.name() + nameOffs)) {
+                    fsize = file.size();
                     *d++ = c;
                     strcpy(c, file.name() + nameOffs);
+                    memcpy(c + sz - 4, &fsize, 4);
+                    sig = mpidx_sigAdd(sig, c);
                     #ifdef TC_DBG_MP
                     Serial.printf("%sAdding '%s'\n", funcName, c);
                     #endif
@@ -1743,23 +2758,20 @@ static bool mp_renameFilesInDir(bool isSetup)
     Serial.printf("%s%d files to process\n", funcName, fileNum);
     #endif
 
-    // Sort file names, and rename
+    // Sort file names, and write index if folder has changed
 
-    if(fileNum) {
+    if(haveIdx && oh.count == fileNum && oh.sig == sig) {
 
-        char fnbuf2[256];
-        
-        // Sort file names
-        mpren_insertionSort(a, fileNum);
-    
-        sprintf(fnbuf2, "/music%1d/", musFolderNum);
-        strcpy(fnbuf, fnbuf2);
+        #ifdef TC_DBG_MP
+        Serial.printf("%sIndex up to date\n", funcName);
+        #endif
+        idxOk = false;
+        hls = headLineShown;
+
+    } else {
 
-        // If 000.mp3 exists, find current count
-        // the usual way. Otherwise start at 000.
-        strcpy(fnbuf + 8, "000.mp3");
-        if(SD.exists(fnbuf)) {
-            count = mp_findMaxNum() + 1;
+        if(fileNum) {
+            qsort(a, fileNum, sizeof(char *), mpren_qcmp);
         }
 
         // Trigger head line change
@@ -1768,30 +2780,9 @@ static bool mp_renameFilesInDir(bool isSetup)
             headLineShown = false;
         }
 
-        for(int i = 0; i < fileNum && count <= 999; i++) {
-            
-            mpren_looper(isSetup, false, fileNum - i);
-
-            sprintf(fnbuf + 8, "%03d.mp3", count);
-            strcpy(fnbuf2 + 8, a[i]);
-            if(!SD.rename(fnbuf2, fnbuf)) {
-                bool done = false;
-                while(!done) {
-                    count++;
-                    if(count <= 999) {
-                        sprintf(fnbuf + 8, "%03d.mp3", count);
-                        done = SD.rename(fnbuf2, fnbuf);
-                    } else {
-                        done = true;
-                    }
-                }
-            }
-            #ifdef TC_DBG_MP
-            Serial.printf("%sRenamed '%s' to '%s'\n", funcName, fnbuf2, fnbuf);
-            #endif
-            
-            count++;
-        }
+        // Without DONE file, examine all files
+        idxOk = mpidx_write(a, fileNum, sig, haveIdx, isSetup);
+
     }
 
     for(int i = 0; i <= allocBufIdx; i++) {
@@ -1800,7 +2791,7 @@ static bool mp_renameFilesInDir(bool isSetup)
     free(a);
 
     // Write "DONE" file
-    if((origin = SD.open(fnbuf3, FILE_WRITE))) {
+    if(idxOk && (origin = SD.open(fnbuf3, FILE_WRITE))) {
         origin.close();
         #ifdef TC_DBG_MP
         Serial.printf("%sWrote %s\n", funcName, fnbuf3);
@@ -1819,7 +2810,7 @@ static bool mp_renameFilesInDir(bool isSetup)
 }
 
 /*
- * Insertion Sort for file names
+ * Sort order for file names
  */
 
 static unsigned char mpren_toUpper(char a)
@@ -1830,32 +2821,24 @@ static unsigned char mpren_toUpper(char a)
     return (unsigned char)a;
 }
 
-static bool mpren_strGT(const char *a, const char *b)
+// Case-insensitive; names equal but for case by strcmp
+static int mpren_cmp(const char *a, const char *b)
 {
-    int aa = strlen(a);
-    int bb = strlen(b);
-    int cc = aa < bb ? aa : bb;
+    const char *aa = a, *bb = b;
 
-    for(int i = 0; i < cc; i++) {
-        unsigned char aaa = mpren_toUpper(*a);
-        unsigned char bbb = mpren_toUpper(*b);
-        if(aaa < bbb) return false;
-        if(aaa > bbb) return true;
-        a++; b++;
+    for(;;) {
+        unsigned char aaa = mpren_toUpper(*aa);
+        unsigned char bbb = mpren_toUpper(*bb);
+        if(aaa < bbb) return -1;
+        if(aaa > bbb) return 1;
+        if(!aaa) break;
+        aa++; bb++;
     }
 
-    return false;
+    return strcmp(a, b);
 }
 
-static void mpren_insertionSort(char **a, int n)
+static int mpren_qcmp(const void *a, const void *b)
 {
-    for(int i = 1; i < n; i++) {
-        char *k = a[i];
-        int j = i - 1;
-        while(j >= 0 && mpren_strGT(a[j], k)) {
-            a[j+1] = a[j];
-            j--;
-        }
-        a[j + 1] = k;
-    }
+    return mpren_cmp(*(char * const *)a, *(char * const *)b);
 }
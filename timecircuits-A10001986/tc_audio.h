@@ -134,9 +134,36 @@ typedef struct {
     int curTrack;
     int maxMusic;
     int mpShuffle;
+    int curDuration;    // Seconds (estimated), 0 = unknown
 } Aud_State;
 extern Aud_State aud_state;
 
+typedef struct {
+    uint32_t underruns;     // Ring buffer ran empty during playback
+    uint32_t minFill;       // Ring buffer watermarks (samples)
+    uint32_t maxFill;
+    uint32_t ringSize;
+    uint32_t lastLatency;   // Play request to first sample (us)
+    uint32_t maxLatency;
+    uint32_t lastGap;       // Silence between music tracks (us)
+    uint32_t maxGap;
+    uint32_t cacheHits;     // PCM cache
+    uint32_t cacheMisses;
+    uint32_t cacheUsed;     // bytes
+    uint32_t cacheBudget;
+    uint32_t raFills;       // File read-ahead: Buffers read
+    uint32_t raAvoided;     // Slow reads the decoder did not wait for
+    uint32_t raStalls;      // Decoder waited for data
+    uint32_t raStallUs;     // Total wait time (us)
+    uint32_t raDirect;      // Read by decoder, reader task too late
+    uint32_t mp3Frames;     // MP3 frames decoded
+    uint32_t mp3Input;      // Average CPU cycles per frame: Stream refill,
+    uint32_t mp3Decode;     // frame decoding,
+    uint32_t mp3Synth;      // synthesis
+} Aud_Stats;
+
+void  getAudioStats(Aud_Stats *st);
+
 extern int  volumePin;
 
 extern bool audioInitDone;
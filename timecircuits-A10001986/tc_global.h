@@ -146,6 +146,7 @@
 //#define TC_DBG_MQTT           // MQTT-related
 #define TC_DBG_AUDIO          // Audio-related
 //#define TC_DBG_TIME           // Time handling
+//#define TC_DBG_TZCHECK        // Compare TZ/DST handling with libc at boot (takes a while)
 //#define TC_DBG_NET            // Prop network
 //#define TC_DBG_TT             // Time travel
 //#define TC_DBG_GPS            // GPS-related
@@ -1297,6 +1297,22 @@ void keypad_loop()
                     }
                 }
             
+            } else if(code == 44) {
+
+                // 44xxxx: Select zone xxxx from built-in table as main time zone
+                int idx = (read2digs(2) * 100) + read2digs(4);
+
+                if(tzdbSelect(idx)) {
+                    const char *tn = strrchr(settings.timeZone, '/');
+                    sprintf(atxt, "%.*s", DISP_LEN, tn ? tn + 1 : settings.timeZone);
+                    for(char *s = atxt; *s; ++s) {
+                        *s = (*s == '_') ? ' ' : toupper(*s);
+                    }
+                    dt_showTextDirect(atxt);
+                    specDisp = 10;
+                    validEntry = 1;
+                }
+
             } else if((!(csf & CSF_NOMUSIC)) && !strncmp(keyBuffer, "888", 3)) {
 
                 int num = (binBuf[3] * 100) + read2digs(4);
@@ -1802,23 +1818,16 @@ void keypad_loop()
     
                         #ifndef IS_ACAR_DISPLAY
                         if(p3anim) {
-                            for(int i = 0; i < 12; i++) {
-                                if(!destinationTime.showAnimate3(i))
-                                    break;
-                                if(needDepTime) {
-                                    departedTime.showAnimate3(i);
-                                }
-                                mydelay(5);
+                            destinationTime.startAnim(tcdAnimDate);
+                            if(needDepTime) {
+                                departedTime.startAnim(tcdAnimDate);
                             }
                         } else {
                         #endif    // IS_ACAR_DISPLAY
                             #ifndef TC_NO_MONTH_ANIM // ---------------------
-                            for(bool i : { true, false }) {
-                                destinationTime.showAnimate(i);
-                                if(needDepTime) {
-                                    departedTime.showAnimate(i);
-                                }
-                                if(i) mydelay(80);
+                            destinationTime.startAnim(tcdAnimMonth);
+                            if(needDepTime) {
+                                departedTime.startAnim(tcdAnimMonth);
                             }
                             #else // TC_NO_MONTH_ANIM -----------------------
                             destinationTime.show();
@@ -1944,6 +1953,12 @@ bool keypadIsIdle()
     return (!lastKeyPressed);
 }
 
+// Key down or date entry in progress
+bool keypadInputActive()
+{
+    return (keypad.isKeyActive() || dateIndex);
+}
+
 static void resetDisplayMode(bool setDep)
 {
     // Reset the red display and disable nav&rc&wc&mini modes if they use it.
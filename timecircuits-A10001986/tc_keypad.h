@@ -77,6 +77,7 @@ void cancelEnterAnim(bool reenableDT = true);
 void cancelETTAnim();
 
 bool keypadIsIdle();
+bool keypadInputActive();
 
 void setBeepMode(int mode);
 void startBeepTimer();
@@ -219,6 +219,7 @@
 #include <WiFi.h> 
 
 #include "tcddisplay.h"
+#include "i2cbus.h"
 #include "tc_keypad.h"
 #include "tc_main.h"
 #include "tc_audio.h"
@@ -239,7 +240,8 @@
 #define MODE_SENS 9
 #define MODE_LTS  10
 #define MODE_CLI  11
-#define MODE_VER  12
+#define MODE_I2C  12
+#define MODE_VER  13
 
 #define MODE_MIN  MODE_ALRM
 #define MODE_MAX  MODE_VER
@@ -292,6 +294,7 @@ static void doShowSensors();
 #endif
 static void doShowNetInfo();
 static void doShowBTTFNInfo();
+static void doShowI2CInfo();
 static bool menuWaitForReleaseNC();
 static bool checkEnterPress();
 static void waitForEnterRelease();
@@ -445,6 +448,10 @@ static void menuShow(int number, tcdDisplay*& displayHelp)
         sw_sel(D_D);
         #endif
         break;
+    case MODE_I2C:
+        dt_showTextDirect("I2C BUS");
+        sw_sel(D_D);
+        break;
     case MODE_VER:  // Version info
         dt_showTextDirect("VERSION");
         pt_showTextDirect(TC_VERSION);
@@ -933,6 +940,12 @@ void enter_menu()
 
         // Show client info
         doShowBTTFNInfo();
+
+    } else if(menuItemNum == MODE_I2C) {   // Show i2c statistics
+
+        allOffWaitEnterRelease();
+
+        doShowI2CInfo();
  
     #if defined(TC_HAVELIGHT) || defined(TC_HAVETEMP)
     } else if(menuItemNum == MODE_SENS) {   // Show sensor info
@@ -2214,6 +2227,76 @@ void doShowBTTFNInfo()
 }
 
 
+/*
+ * Show i2c bus statistics
+ * (per device: address, average transaction time, errors)
+ */
+static void displayI2CDev(int number)
+{
+    const i2cDevStats *st = i2cBus.getDevStats(number);
+    char buf[16];
+
+    if(!st) {
+        dt_showTextDirect("NO DATA");
+        sw_sel(D_D);
+        return;
+    }
+
+    sprintf(buf, "I2C %02X", st->addr);
+    dt_showTextDirect(buf);
+    sprintf(buf, "AVG %dUS", st->count ? (int)(st->usecs / st->count) : 0);
+    pt_showTextDirect(buf);
+    sprintf(buf, "ERRORS %d", (int)st->errors);
+    lt_showTextDirect(buf);
+    sw_sel(D_D|D_P|D_L);
+}
+
+static void doShowI2CInfo()
+{
+    int number = 0;
+    bool i2cDone = false;
+    int numDevs = i2cBus.getNumDevs();
+    bool wasEnter, dirDown, wasQuit = false, wasSelect;
+
+    displayI2CDev(number);
+
+    prepareForInput();
+
+    while(!checkTimeOut() && !i2cDone) {
+
+        if(checkForMenuControl(wasEnter, dirDown, wasQuit, wasSelect)) {
+
+            if(wasQuit) break;
+
+            i2cDone = (wasSelect || (wasEnter && menuWaitForReleaseNC()));
+
+            if(!i2cDone && numDevs > 1) {
+
+                if(dirDown) {
+                    number++;
+                    if(number >= numDevs) number = 0;
+                } else {
+                    if(!number) number = numDevs - 1;
+                    else number--;
+                }
+
+                displayI2CDev(number);
+
+            }
+
+        } else {
+
+            menuDelay(50);
+            numDevs = i2cBus.getNumDevs();
+
+        }
+
+    }
+
+    keypadMode = 0;
+}
+
+
 /* *** Helpers ################################################### */
 
 
@@ -2366,6 +2449,7 @@ static void menuDelay(unsigned long mydel)
  */
 static void menuLoops()
 {
+    i2cSched.newSlice();
     audio_loop();
     wifi_loop();
     audio_loop();
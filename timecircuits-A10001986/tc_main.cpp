@@ -69,8 +69,10 @@
 #if defined(TC_HAVE_RE) || defined(TC_HAVE_REMOTE)
 #include "input.h"
 #endif
+#include "i2cbus.h"
 
 #include "tc_main.h"
+#include "tc_tzdb.h"
 
 // i2c slave addresses
 
@@ -402,16 +404,33 @@ uint64_t    timeDifference = 0;
 bool        timeDiffUp = false;  // true = add difference, false = subtract difference
 
 // TZ/DST status & data
-static int  tzForYear[3]    = { 0, 0, 0 };               // Parsing done for this very year
+static int  tzForYear[3]    = { 0, 0, 0 };               // Parsing done for this very (UTC) year
 static char *tzDSTpart[3]   = { NULL, NULL, NULL };
 static int  tzDiffGMT[3]    = { 0, 0, 0 };               // Difference to UTC in nonDST time
 static int  tzDiffGMTDST[3] = { 0, 0, 0 };               // Difference to UTC in DST time
 static int  tzDiff[3]       = { 0, 0, 0 };               // difference between DST and non-DST in minutes
-static int  DSTonMins[3]    = { -1, -1, -1 };            // DST-on date/time in minutes since 1/1 00:00 (in non-DST time)
-static int  DSToffMins[3]   = { 600000, 600000, 600000}; // DST-off date/time in minutes since 1/1 00:00 (in DST time)
+static int  DSTonMins[3]    = { -1, -1, -1 };            // DST-on date/time in minutes since 1/1 00:00 UTC (may be outside of year)
+static int  DSToffMins[3]   = { 600000, 600000, 600000}; // DST-off date/time in minutes since 1/1 00:00 UTC (may be outside of year)
 bool        couldDST[3]     = { false, false, false };   // Could use own DST management (and DST is defined in TZ)
 static int8_t tzIsValid[3]  = { -1, -1, -1 };
 static int8_t tzHasDST[3]   = { -1, -1, -1 };
+typedef struct {                                         // Compiled DST start/end rule
+    char    type;       // 'M' (month.week.day), 'J' (Julian day 1-365), 'n' (day 0-365)
+    uint8_t month;
+    uint8_t week;
+    uint8_t wday;
+    int16_t day;
+    int16_t mins;       // Time of day in minutes, -167:59 to 167:59 hours
+} tzRule;
+static tzRule tzRules[3][2];
+#define TZ_CACHE_YEARS 4                                 // DST data cache size per TZ (power of 2)
+typedef struct {
+    int  year;
+    int  onMins;
+    int  offMins;
+    bool couldDST;
+} tzYearData;
+static tzYearData tzYearCache[3][TZ_CACHE_YEARS];
 #ifdef TC_DBG_BOOT
 static const char *badTZ = "Failed to parse TZ\n";
 #endif
@@ -498,6 +517,7 @@ static int           gpsDispMode = 0;
 tcdDisplay destinationTime(DISP_DEST, DEST_TIME_ADDR);
 tcdDisplay presentTime(DISP_PRES, PRES_TIME_ADDR);
 tcdDisplay departedTime(DISP_LAST, DEPT_TIME_ADDR);
+static bool frameHeld = false;
 
 // The speedo and temp.sensor objects
 speedDisplay speedo(SPEEDO_ADDR);
@@ -661,6 +681,22 @@ const uint32_t *autoNMPresets[AUTONM_NUM_PRESETS] = {
 static unsigned long lastLoopLight = 0;
 #endif
 
+// I2C bus scheduling for bulk reads (GPS, sensors), see
+// tcI2CSched. Jobs in order of priority.
+#define I2C_SLICE_BUDGET 3000       // us per main_loop() iteration/delay round
+enum {
+    I2CJ_GPS = 0,
+    I2CJ_TEMP,
+    I2CJ_LIGHT,
+    I2CJ_NUM
+};
+static const uint16_t i2cJobDeadline[I2CJ_NUM] = {
+    100,    // GPS (ms past due)
+    2000,   // Temperature
+    1000    // Light
+};
+static unsigned long i2cJobNow = 0;
+
 // Reminder
 uint8_t remMonth = 0;
 uint8_t remDay   = 0;
@@ -702,155 +738,33 @@ static const uint8_t monthDays[] =
 {
     31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31
 };
-static const unsigned int mon_yday[2][13] =
+static constexpr unsigned int mon_yday[2][13] =
 {
     { 0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334, 365 },
     { 0, 31, 60, 91, 121, 152, 182, 213, 244, 274, 305, 335, 366 }
 };
-static const unsigned int mon_ydayt24t60[2][13] =
-{
-    { 0, 31*24*60,  59*24*60,  90*24*60, 120*24*60, 151*24*60, 181*24*60, 
-        212*24*60, 243*24*60, 273*24*60, 304*24*60, 334*24*60, 365*24*60 },
-    { 0, 31*24*60,  60*24*60,  91*24*60, 121*24*60, 152*24*60, 182*24*60, 
-        213*24*60, 244*24*60, 274*24*60, 305*24*60, 335*24*60, 366*24*60 }
-};
-static const uint64_t mins1kYears[] =
-{
-#ifndef TC_JULIAN_CAL  
-             0,  262975680,  525949920,  788924160, 1051898400,
-    1314874080, 1577848320, 1840822560, 2103796800, 2366772480,
-    2629746720, 2892720960, 3155695200, 3418670880, 3681645120,
-    3944619360, 4207593600, 4470569280, 4733543520, 4996517760,
-    5259492000, 5522467680
-#elif !defined(JSWITCH_1582)
-             0,   52596000,  105192000,  157788000,  210384000, 
-     262980000,  315576000,  368172000,  420768000,  473364000, 
-     525960000,  578556000,  631152000,  683748000,  736344000, 
-     788940000,  841536000,  894132000,  946712160,  999306720, 
-    1051901280, 1104497280, 1157091840, 1209686400, 1262280960, 
-    1314876960, 1367471520, 1420066080, 1472660640, 1525256640, 
-    1577851200, 1630445760, 1683040320, 1735636320, 1788230880, 
-    1840825440, 1893420000, 1946016000, 1998610560, 2051205120, 
-    2103799680, 2156395680, 2208990240, 2261584800, 2314179360, 
-    2366775360, 2419369920, 2471964480, 2524559040, 2577155040, 
-    2629749600, 2682344160, 2734938720, 2787534720, 2840129280, 
-    2892723840, 2945318400, 2997914400, 3050508960, 3103103520, 
-    3155698080, 3208294080, 3260888640, 3313483200, 3366077760, 
-    3418673760, 3471268320, 3523862880, 3576457440, 3629053440, 
-    3681648000, 3734242560, 3786837120, 3839433120, 3892027680, 
-    3944622240, 3997216800, 4049812800, 4102407360, 4155001920, 
-    4207596480, 4260192480, 4312787040, 4365381600, 4417976160, 
-    4470572160, 4523166720, 4575761280, 4628355840, 4680951840, 
-    4733546400, 4786140960, 4838735520, 4891331520, 4943926080, 
-    4996520640, 5049115200, 5101711200, 5154305760, 5206900320,
-    5259494880, 5312090880, 5364685440, 5417280000, 5469874560, 
-    5522470560, 5575065120, 5627659680, 5680254240, 5732850240   
-#else
-             0,   52596000,  105192000,  157788000,  210384000, 
-     262980000,  315576000,  368172000,  420768000,  473364000, 
-     525960000,  578556000,  631152000,  683748000,  736344000, 
-     788940000,  841521600,  894117600,  946712160,  999306720, 
-    1051901280, 1104497280, 1157091840, 1209686400, 1262280960, 
-    1314876960, 1367471520, 1420066080, 1472660640, 1525256640, 
-    1577851200, 1630445760, 1683040320, 1735636320, 1788230880, 
-    1840825440, 1893420000, 1946016000, 1998610560, 2051205120, 
-    2103799680, 2156395680, 2208990240, 2261584800, 2314179360, 
-    2366775360, 2419369920, 2471964480, 2524559040, 2577155040, 
-    2629749600, 2682344160, 2734938720, 2787534720, 2840129280, 
-    2892723840, 2945318400, 2997914400, 3050508960, 3103103520, 
-    3155698080, 3208294080, 3260888640, 3313483200, 3366077760, 
-    3418673760, 3471268320, 3523862880, 3576457440, 3629053440, 
-    3681648000, 3734242560, 3786837120, 3839433120, 3892027680, 
-    3944622240, 3997216800, 4049812800, 4102407360, 4155001920, 
-    4207596480, 4260192480, 4312787040, 4365381600, 4417976160, 
-    4470572160, 4523166720, 4575761280, 4628355840, 4680951840, 
-    4733546400, 4786140960, 4838735520, 4891331520, 4943926080, 
-    4996520640, 5049115200, 5101711200, 5154305760, 5206900320,
-    5259494880, 5312090880, 5364685440, 5417280000, 5469874560, 
-    5522470560, 5575065120, 5627659680, 5680254240, 5732850240
-#endif    
-};
 uint32_t (*t)(uint8_t *, uint32_t, uint32_t);
-static const uint32_t hours1kYears[] =
-{
-#ifndef TC_JULIAN_CAL
-                0,  262975680/60,  525949920/60,  788924160/60, 1051898400/60,
-    1314874080/60, 1577848320/60, 1840822560/60, 2103796800/60, 2366772480/60, 
-    2629746720/60, 2892720960/60, 3155695200/60, 3418670880/60, 3681645120/60, 
-    3944619360/60, 4207593600/60, 4470569280/60, 4733543520/60, 4996517760/60,
-    5259492000/60, 5522467680/60 
-#elif !defined(JSWITCH_1582)
-                0,   52596000/60,  105192000/60,  157788000/60,  210384000/60, 
-     262980000/60,  315576000/60,  368172000/60,  420768000/60,  473364000/60, 
-     525960000/60,  578556000/60,  631152000/60,  683748000/60,  736344000/60, 
-     788940000/60,  841536000/60,  894132000/60,  946712160/60,  999306720/60, 
-    1051901280/60, 1104497280/60, 1157091840/60, 1209686400/60, 1262280960/60, 
-    1314876960/60, 1367471520/60, 1420066080/60, 1472660640/60, 1525256640/60, 
-    1577851200/60, 1630445760/60, 1683040320/60, 1735636320/60, 1788230880/60, 
-    1840825440/60, 1893420000/60, 1946016000/60, 1998610560/60, 2051205120/60, 
-    2103799680/60, 2156395680/60, 2208990240/60, 2261584800/60, 2314179360/60, 
-    2366775360/60, 2419369920/60, 2471964480/60, 2524559040/60, 2577155040/60, 
-    2629749600/60, 2682344160/60, 2734938720/60, 2787534720/60, 2840129280/60, 
-    2892723840/60, 2945318400/60, 2997914400/60, 3050508960/60, 3103103520/60, 
-    3155698080/60, 3208294080/60, 3260888640/60, 3313483200/60, 3366077760/60, 
-    3418673760/60, 3471268320/60, 3523862880/60, 3576457440/60, 3629053440/60, 
-    3681648000/60, 3734242560/60, 3786837120/60, 3839433120/60, 3892027680/60, 
-    3944622240/60, 3997216800/60, 4049812800/60, 4102407360/60, 4155001920/60, 
-    4207596480/60, 4260192480/60, 4312787040/60, 4365381600/60, 4417976160/60, 
-    4470572160/60, 4523166720/60, 4575761280/60, 4628355840/60, 4680951840/60, 
-    4733546400/60, 4786140960/60, 4838735520/60, 4891331520/60, 4943926080/60, 
-    4996520640/60, 5049115200/60, 5101711200/60, 5154305760/60, 5206900320/60,
-    5259494880/60, 5312090880/60, 5364685440/60, 5417280000/60, 5469874560/60, 
-    5522470560/60, 5575065120/60, 5627659680/60, 5680254240/60, 5732850240/60
-#else
-             0/60,   52596000/60,  105192000/60,  157788000/60,  210384000/60, 
-     262980000/60,  315576000/60,  368172000/60,  420768000/60,  473364000/60, 
-     525960000/60,  578556000/60,  631152000/60,  683748000/60,  736344000/60, 
-     788940000/60,  841521600/60,  894117600/60,  946712160/60,  999306720/60, 
-    1051901280/60, 1104497280/60, 1157091840/60, 1209686400/60, 1262280960/60, 
-    1314876960/60, 1367471520/60, 1420066080/60, 1472660640/60, 1525256640/60, 
-    1577851200/60, 1630445760/60, 1683040320/60, 1735636320/60, 1788230880/60, 
-    1840825440/60, 1893420000/60, 1946016000/60, 1998610560/60, 2051205120/60, 
-    2103799680/60, 2156395680/60, 2208990240/60, 2261584800/60, 2314179360/60, 
-    2366775360/60, 2419369920/60, 2471964480/60, 2524559040/60, 2577155040/60, 
-    2629749600/60, 2682344160/60, 2734938720/60, 2787534720/60, 2840129280/60, 
-    2892723840/60, 2945318400/60, 2997914400/60, 3050508960/60, 3103103520/60, 
-    3155698080/60, 3208294080/60, 3260888640/60, 3313483200/60, 3366077760/60, 
-    3418673760/60, 3471268320/60, 3523862880/60, 3576457440/60, 3629053440/60, 
-    3681648000/60, 3734242560/60, 3786837120/60, 3839433120/60, 3892027680/60, 
-    3944622240/60, 3997216800/60, 4049812800/60, 4102407360/60, 4155001920/60, 
-    4207596480/60, 4260192480/60, 4312787040/60, 4365381600/60, 4417976160/60, 
-    4470572160/60, 4523166720/60, 4575761280/60, 4628355840/60, 4680951840/60, 
-    4733546400/60, 4786140960/60, 4838735520/60, 4891331520/60, 4943926080/60, 
-    4996520640/60, 5049115200/60, 5101711200/60, 5154305760/60, 5206900320/60,
-    5259494880/60, 5312090880/60, 5364685440/60, 5417280000/60, 5469874560/60, 
-    5522470560/60, 5575065120/60, 5627659680/60, 5680254240/60, 5732850240/60
-#endif    
-};
 
 #ifdef TC_JULIAN_CAL
 static const uint64_t tdro = 5258967840;
+// Last day of Julian Cal (year, month, day); everything else is derived
 #ifndef JSWITCH_1582
-static const int jCentStart   = 1700;      // Start of century when switch took place
-static const int jCentEnd     = 1799;      // Last year of century when switch took place
-static const int jSwitchYear  = 1752;      // Year in which switch to Gregorian Cal took place
-static const int jSwitchMon   = 9;         // Month in which switch to Gregorian Cal took place
-static const int jSwitchDay   = 2;         // Last day of Julian Cal
-static const int jSwitchSkipD = 11;        // Number of days skipped
-static const int jSwitchSkipH = 11 * 24;   // Num hours skipped
+static constexpr int jSwitchYear = 1752, jSwitchMon = 9, jSwitchDay = 2;
 #else
-static const int jCentStart   = 1500;      // Start of century when switch took place
-static const int jCentEnd     = 1599;      // Last year of century when switch took place
-static const int jSwitchYear  = 1582;      // Year in which switch to Gregorian Cal took place
-static const int jSwitchMon   = 10;        // Month in which switch to Gregorian Cal took place
-static const int jSwitchDay   = 4;         // Last day of Julian Cal
-static const int jSwitchSkipD = 10;        // Number of days skipped
-static const int jSwitchSkipH = 10 * 24;   // Num hours skipped
+static constexpr int jSwitchYear = 1582, jSwitchMon = 10, jSwitchDay = 4;
 #endif
-static int mon_yday_jSwitch[13];     // Accumulated days per month in year of Switch
-static int mon_ydayt24t60J[13];      // Accumulated mins per month in year of Switch
-static int jSwitchYrHrs;
-static uint32_t jSwitchHash = 0;
+// Number of days skipped (difference between Julian and Gregorian Cal at switch)
+static constexpr int jSwitchSkipD = ((jSwitchYear - (jSwitchMon < 3)) / 100) - ((jSwitchYear - (jSwitchMon < 3)) / 400) - 2;
+// Number of Gregorian non-leap centuries up to and including year of switch
+static constexpr int jSwitchNLC   = ((jSwitchYear + 100) / 100) - ((jSwitchYear + 400) / 400);
+static constexpr uint32_t jSwitchHash = (jSwitchYear << 16) | (jSwitchMon << 8) | jSwitchDay;
+// Accumulated days per month in year of Switch
+#define MYJS(i) (mon_yday[(jSwitchYear % 4) ? 0 : 1][i] - ((i >= jSwitchMon) ? jSwitchSkipD : 0))
+static constexpr unsigned int mon_yday_jSwitch[13] = {
+    MYJS(0), MYJS(1), MYJS(2), MYJS(3), MYJS(4), MYJS(5), MYJS(6),
+    MYJS(7), MYJS(8), MYJS(9), MYJS(10), MYJS(11), MYJS(12)
+};
+#undef MYJS
 #else
 static const uint64_t tdro = 5258964960;
 #endif
@@ -929,9 +843,61 @@ int bttfnHaveClients = 0; // This is a bool by nature (0, !0)
 #define BTTFN_VERSION              1
 #define BTTF_PACKET_SIZE          48
 #define BTTF_DEFAULT_LOCAL_PORT 1338
-#define BTTFN_MAX_CLIENTS          6
+#ifndef BTTFN_MAX_CLIENTS
+#define BTTFN_MAX_CLIENTS         16    // 1-255 (slot numbers are uint8_t, 0xff is NIL)
+#endif
+// Hash table at least twice the size of the client table
+#if BTTFN_MAX_CLIENTS <= 8
+#define BTTFN_HASH_BITS            4
+#elif BTTFN_MAX_CLIENTS <= 16
+#define BTTFN_HASH_BITS            5
+#elif BTTFN_MAX_CLIENTS <= 32
+#define BTTFN_HASH_BITS            6
+#elif BTTFN_MAX_CLIENTS <= 64
+#define BTTFN_HASH_BITS            7
+#elif BTTFN_MAX_CLIENTS <= 128
+#define BTTFN_HASH_BITS            8
+#else
+#define BTTFN_HASH_BITS            9
+#endif
+#define BTTFN_HASH_SIZE         (1 << BTTFN_HASH_BITS)
+#define BTTFN_NIL               0xff
+static_assert(BTTFN_HASH_SIZE >= 2 * BTTFN_MAX_CLIENTS && BTTFN_MAX_CLIENTS >= 1 && BTTFN_MAX_CLIENTS <= 255, "Bad BTTFN_MAX_CLIENTS");
+// Budget for draining queued packets per bttfn_loop() call. A
+// packet parsed after the budget is used up is still handled
+// (it cannot be left in the socket), so a call handles up to
+// BTTFN_LOOP_MAXPKTS + 1.
+#ifndef BTTFN_LOOP_MAXPKTS
+#define BTTFN_LOOP_MAXPKTS         8
+#endif
+#ifndef BTTFN_LOOP_MAXUS
+#define BTTFN_LOOP_MAXUS        3000
+#endif
+// Clock sync: Exchanges with longer RTT (ms) are ignored; 
+// offset is valid after that many exchanges, and until the
+// client misses that many sync intervals (no less than 
+// BTTFN_SYNC_MININTV ms each)
+#define BTTFN_SYNC_MAXRTT       1000
+#define BTTFN_SYNC_MINCNT          3
+#define BTTFN_SYNC_MAXMISS         5
+#define BTTFN_SYNC_MININTV      1000
+// NOT_DATA: Check for changes every BTTFN_ND_CHECK ms, send keep-alive
+// after BTTFN_ND_KEEPALIVE ms (1000 if a client does not support this)
+#define BTTFN_ND_CHECK            50
+#define BTTFN_ND_KEEPALIVE      5000
+#define BTTFN_ND_TEMPDIFF         50    // Temperature change to report (*100)
+// Changed-fields mask in NOT_DATA byte 17 bits 3-6 (bits 0-2 are
+// doW, bit 7 the temperature unit). Valid if BTTFN_NDC_VALID is
+// set in byte 40, whose bits 6-7 are unused in all packets (0-5
+// carry minute bits of the compressed times).
+#define BTTFN_NDC_VALID         0x80    // byte 40
+#define BTTFN_NDC_TIME          0x08    // Date/time (minute)
+#define BTTFN_NDC_DDT           0x10    // Destination/departed times
+#define BTTFN_NDC_SENS          0x20    // Temperature, lux
+#define BTTFN_NDC_STAT          0x40    // Status, sensor availability, SSID/pw
 struct _bttfnClient {
     unsigned long ALIVE;
+    uint8_t       prev, next;           // LRU list, by ALIVE
     #ifdef TC_HAVE_REMOTE
     uint32_t      RemID;
     #endif
@@ -942,6 +908,15 @@ struct _bttfnClient {
     uint8_t       Flags;
     uint8_t       Type;
     char          ID[14];
+    // Clock sync
+    uint32_t      SyncSerial;           // Serial of last reply
+    unsigned long SyncT3;               // Our time of last reply (0 = none)
+    int32_t       Offset;               // Client clock minus ours (ms)
+    uint16_t      RTT;                  // Round trip time (ms) of exchange Offset is from
+    unsigned long SyncLast;             // Our time of last exchange
+    uint32_t      SyncIntv;             // Interval between last two exchanges (ms)
+    uint8_t       SyncCnt;              // Number of exchanges
+    uint8_t       SyncAge;              // Exchanges since Offset was updated
 };
 static const uint8_t BTTFUDPHD[BTTF_PACKET_SIZE] = { 'B', 'T', 'T', 'F', BTTFN_VERSION | 0x40, 0};
 static WiFiUDP       bttfUDP;
@@ -951,8 +926,20 @@ static UDP*          tcdmcUDP;
 static IPAddress     bttfnMcIP(224, 0, 0, 224);
 static byte          BTTFUDPBuf[BTTF_PACKET_SIZE];
 static byte          BTTFDataBuf[BTTF_PACKET_SIZE];
+// Client registry: Slots are stable; bttfnHash maps IP to slot+1 
+// (open addressing, linear probing), bttfnOrder lists used slots in 
+// order of registration, the LRU list is used for expiry.
 static _bttfnClient  bttfnClient[BTTFN_MAX_CLIENTS];
+static uint8_t       bttfnHash[BTTFN_HASH_SIZE];
+static uint8_t       bttfnOrder[BTTFN_MAX_CLIENTS];
+static uint8_t       bttfnFree[BTTFN_MAX_CLIENTS];
+static int           bttfnNumCli = 0;
+static uint8_t       bttfnLRUHead = BTTFN_NIL, bttfnLRUTail = BTTFN_NIL;
+// Number of clients with capability; flags 0x01, 0x02, 0x04, !0x02,
+// 0x01 without 0x08
+static uint8_t       bttfnCapCnt[5] = { 0 };
 static uint8_t       bttfnDateBuf[8];
+static BTTFN_Stats   bttfnStats = { 0 };
 static uint32_t      bttfnSeqCnt = 1;
 static uint32_t      bttfnDataSeqCnt = 1;
 static unsigned long bttfnlastExpire = 0;
@@ -967,6 +954,12 @@ static int           oldBTTFNSpd = -2;
 static uint16_t      oldBTTFNSSrc = 0xffff;
 static unsigned long bttfnLastSpeedNot = 0;
 static unsigned long bttfnLastDataNot = 0;
+static unsigned long bttfnLastDataCheck = 0;
+static unsigned long bttfnLastDataClean = 0;
+static uint8_t       bttfnLastData[BTTF_PACKET_SIZE];
+static uint8_t       bttfnNDLegacy = 0;
+static unsigned long bttfnNDStart = 0;
+static uint32_t      bttfnNDLatSum = 0;
 static unsigned long bttfnLastInfo = 0;
 static int           TCDBusyStatus = 0;
 static uint8_t       bttfnData17 = 0, bttfnData18, bttfnData19;
@@ -1052,6 +1045,10 @@ static void triggerLongTT(bool noLead = false);
 static void checkForSpeedTT(bool doP2, bool isRemote);
 #endif
 
+static bool i2cJobGrant(int job, unsigned long late);
+static void i2cJobStart(int job);
+static void i2cJobDone(int job);
+
 static void copyPresentToDeparted(bool isReturn);
 
 static void ettoPulseStart();
@@ -1060,24 +1057,65 @@ static void sendTTNetWorkMsg(uint16_t bttfnPayload, uint16_t bttfnPayload2);
 static void sendNetWorkMsg(const char *pl, unsigned int len, uint8_t bttfnMsg, uint16_t bttfnPayload = 0, uint16_t bttfnPayload2 = 0);
 
 // Time calculations
+static constexpr uint32_t daysBeforeYear(int year);
 static uint64_t  dateToMins(int year, int month, int day, int hour, int minute);
 static void      minsToDate(uint64_t total, int& year, int& month, int& day, int& hour, int& minute);
-#ifdef TC_JULIAN_CAL
-static void      calcJulianData();
-#endif
 static void      convTime(int diff, int& y, int& m, int& d, int& h, int& mm);
+#ifdef TC_DBG_TZCHECK
+static int       tzCheck();
+#endif
 
 /// Native NTP
 static bool NTPHaveCurrentTime();
 static bool NTPGetUTC(int& year, int& month, int& day, int& hour, int& minute, int& second);
 
 // Basic Telematics Transmission Framework
-static void bttfn_notify(uint8_t targetType, uint8_t event, uint16_t payload = 0, uint16_t payload2 = 0, uint16_t payload3 = 0);
+static void bttfn_notify(uint8_t targetType, uint8_t event, uint16_t payload = 0, uint16_t payload2 = 0, uint16_t payload3 = 0, unsigned long execAt = 0);
 static void bttfn_notify_speed();
+static void bttfn_expire_client(int i);
 static void bttfn_send_autoUpdates();
 static void bttfn_setup();
 static void bttfn_setup_sensors();
 
+// Time travel display disruption (P1)
+static bool ttgShowOn(tcdDisplay *d, int ii);
+static bool ttgOnFull(tcdDisplay *d, int ii);
+static bool ttgDestP4(tcdDisplay *d, int ii);
+static bool ttgPresP4(tcdDisplay *d, int ii);
+static bool ttgDeptP4(tcdDisplay *d, int ii);
+static bool ttgDestP5(tcdDisplay *d, int ii);
+static bool ttgPresP5(tcdDisplay *d, int ii);
+static bool ttgDeptP5(tcdDisplay *d, int ii);
+
+static const tcdAnimStep ttgDestP4Seq[] = {
+    { ttgShowOn, 0, 0 },
+    { ttgDestP4, 4, 20 }, { ttgDestP4, 3, 20 }, { ttgDestP4, 2, 20 }, { ttgDestP4, 1, 20 }, { ttgDestP4, 0, 20 },
+    { NULL }
+};
+static const tcdAnimStep ttgPresP4Seq[] = {
+    { ttgShowOn, 0, 0 },
+    { ttgPresP4, 4, 20 }, { ttgPresP4, 3, 20 }, { ttgPresP4, 2, 20 }, { ttgPresP4, 1, 20 }, { ttgPresP4, 0, 20 },
+    { NULL }
+};
+static const tcdAnimStep ttgDeptP4Seq[] = {
+    { ttgShowOn, 0, 0 },
+    { ttgDeptP4, 4, 20 }, { ttgDeptP4, 3, 20 }, { ttgDeptP4, 2, 20 }, { ttgDeptP4, 1, 20 }, { ttgDeptP4, 0, 20 },
+    { NULL }
+};
+static const tcdAnimStep ttgDestP5Seq[] = {
+    { ttgDestP5, 4, 10 }, { ttgDestP5, 3, 10 }, { ttgDestP5, 2, 10 }, { ttgDestP5, 1, 10 }, { ttgDestP5, 0, 10 },
+    { NULL }
+};
+static const tcdAnimStep ttgPresP5Seq[] = {
+    { ttgPresP5, 4, 10 }, { ttgPresP5, 3, 10 }, { ttgPresP5, 2, 10 }, { ttgPresP5, 1, 10 }, { ttgPresP5, 0, 10 },
+    { NULL }
+};
+static const tcdAnimStep ttgDeptP5Seq[] = {
+    { ttgOnFull, 0, 0 },
+    { ttgDeptP5, 4, 10 }, { ttgDeptP5, 3, 10 }, { ttgDeptP5, 2, 10 }, { ttgDeptP5, 1, 10 }, { ttgDeptP5, 0, 10 },
+    { NULL }
+};
+
 /*
  * main_boot()
  *
@@ -1131,6 +1169,12 @@ void main_setup()
     // Pin for monitoring seconds from RTC
     pinMode(SECONDS_IN_PIN, INPUT_PULLDOWN);
 
+    // I2C scheduling for bulk reads
+    i2cSched.begin(I2C_SLICE_BUDGET);
+    for(int i = 0; i < I2CJ_NUM; i++) {
+        i2cSched.addJob(i2cJobDeadline[i]);
+    }
+
     // Init fake power switch
     useFakePowerSwitch = evalBool(settings.fakePwrOn);
     fakePowerOnKey.begin();
@@ -1192,11 +1236,6 @@ void main_setup()
     // Turn on the RTC's 1Hz clock output
     rtc.clockOutEnable();
 
-    // Calculate data for Julian Calendar
-    #ifdef TC_JULIAN_CAL
-    calcJulianData();
-    #endif
-
     // Swap red and yellow displays if so configured
     #ifdef IS_ACAR_DISPLAY
     if(evalBool(settings.swapDL)) {
@@ -1273,13 +1312,7 @@ void main_setup()
         } else {
             oldTime -= timeDifference;
         }
-        if(oldTime >= 
-        #ifndef TC_JULIAN_CAL
-                      mins1kYears[(10000 / 500)]
-        #else
-                      mins1kYears[(10000 / 100)]
-        #endif
-                                                ) {
+        if(oldTime >= (uint64_t)daysBeforeYear(10000) * 24 * 60) {
             timeDifference = 0;
         }
     } else {
@@ -1422,6 +1455,10 @@ void main_setup()
         Serial.printf("%s%s", funcName, badTZ);
         #endif
     }
+
+    #ifdef TC_DBG_TZCHECK
+    tzCheck();
+    #endif
     
     // Set RTC with NTP time
     if(getNTPTime(true, gdtu, true, true)) {
@@ -2100,6 +2137,14 @@ void main_loop()
     const char *funcName = "time_loop: ";
     #endif
 
+    // Display updates are collected and sent
+    // back-to-back at the end of this function
+    allHoldFrame();
+
+    allAnimLoop();
+
+    i2cSched.newSlice();
+
     if(useFakePowerSwitch || (csf & (CSF_MQTTPM|CSF_RPM|CSF_RESTOREFP))) {
 
         csf &= ~CSF_RESTOREFP;
@@ -2876,21 +2921,25 @@ void main_loop()
         #ifdef TC_HAVEGPS
         if(sgf & SGF_UGPS) {
             if(millis64() >= lastLoopGPS) {
-                lastLoopGPS += (uint64_t)GPSupdateFreq;
-                // call loop with doDelay true; delay not needed but
-                // this causes a call of audio_loop() which is good
-                myGPS.loop(true);
-
-                // Auto-TT on GPS-88mph only if RotEnc/Remote are not source of displayed speed
-                if((!(sgf & SGF_DispRotEnc)) && (!(csf & CSF_RSM))) {
-                    displayGPSorRESpeed(true);
-                    #ifdef NOT_MY_RESPONSIBILITY
-                    if(myGPS.getSpeed() >= 88) {
-                        checkForSpeedTT(true, false);
-                    } else if(myGPS.getSpeed() < 10) {
-                        GPSabove88 = false;
+                if(i2cJobGrant(I2CJ_GPS, millis64() - lastLoopGPS)) {
+                    lastLoopGPS += (uint64_t)GPSupdateFreq;
+                    // call loop with doDelay true; delay not needed but
+                    // this causes a call of audio_loop() which is good
+                    i2cJobStart(I2CJ_GPS);
+                    myGPS.loop(true);
+                    i2cJobDone(I2CJ_GPS);
+
+                    // Auto-TT on GPS-88mph only if RotEnc/Remote are not source of displayed speed
+                    if((!(sgf & SGF_DispRotEnc)) && (!(csf & CSF_RSM))) {
+                        displayGPSorRESpeed(true);
+                        #ifdef NOT_MY_RESPONSIBILITY
+                        if(myGPS.getSpeed() >= 88) {
+                            checkForSpeedTT(true, false);
+                        } else if(myGPS.getSpeed() < 10) {
+                            GPSabove88 = false;
+                        }
+                        #endif
                     }
-                    #endif
                 }
             #ifdef TC_HAVE_REMOTE
             } else if(remoteWasMaster) {
@@ -2937,9 +2986,12 @@ void main_loop()
         }
         
         #ifdef TC_HAVELIGHT
-        if((sgf & SGF_ULightSens) && (millisNow - lastLoopLight >= 3000)) {
+        if((sgf & SGF_ULightSens) && (millisNow - lastLoopLight >= 3000) &&
+                            i2cJobGrant(I2CJ_LIGHT, millisNow - lastLoopLight - 3000)) {
             lastLoopLight = millisNow;
+            i2cJobStart(I2CJ_LIGHT);
             lightSens.loop();
+            i2cJobDone(I2CJ_LIGHT);
         }
         #endif
 
@@ -3368,7 +3420,6 @@ void main_loop()
 
         if(!skipTTAnim && (timeTravelP1 > 1)) {
 
-            int ii = 5, tt;
             switch(timeTravelP1) {
             case 2:
                 ((rand() % 10) > 7) ? presentTime.off() : presentTime.on();
@@ -3379,42 +3430,14 @@ void main_loop()
                 allOff();
                 break;
             case 4:
-                destinationTime.show();
-                presentTime.show();
-                departedTime.show();
-                allOn();
-                while(ii--) {
-                    tt = rand() % 21;
-                    if(tt < 5) destinationTime.show();
-                    else {
-                        destinationTime.showTextDirect(p1errStrs[(tt - 5) >> 2], CDT_COLON);
-                    }
-                    if(!(ii % 2)) destinationTime.setBrightnessDirect((1+(rand() % 10)) & 0x0a);
-                    if(ii % 2) presentTime.setBrightnessDirect((1+(rand() % 10)) & 0x0b);
-                    ((rand() % 10) < 3) ? departedTime.showTextDirect(">ACS2011GIDUW") : departedTime.show();
-                    if(ii % 2) departedTime.setBrightnessDirect((1+(rand() % 10)) & 0x07);
-                    mydelay(20);
-                }
+                destinationTime.startAnim(ttgDestP4Seq);
+                presentTime.startAnim(ttgPresP4Seq);
+                departedTime.startAnim(ttgDeptP4Seq);
                 break;
             case 5:
-                departedTime.setBrightness(255);
-                departedTime.on();
-                while(ii--) {
-                    tt = rand() % 10;
-                    if(!(ii % 4))   presentTime.setBrightnessDirect(1+(rand() % 8));
-                    if(tt < 3)      { presentTime.setBrightnessDirect(4); presentTime.showPattern(true); }
-                    else if(tt < 7) { presentTime.show(); presentTime.on(); }
-                    else            { presentTime.off(); }
-                    tt = (rand() + millis()) % 10;
-                    if(tt < 3)      { destinationTime.showTextDirect(p1errStrs[rand() % 4], CDT_COLON); }
-                    else if(tt < 6) { destinationTime.show(); destinationTime.on(); }
-                    else            { if(!(ii % 2)) destinationTime.setBrightnessDirect(1+(rand() % 8)); }
-                    tt = (tt + (rand() + millis())) % 10;
-                    if(tt < 4)      { departedTime.setBrightnessDirect(4); departedTime.showPattern(true); }
-                    else if(tt < 6) { departedTime.showTextDirect("R 2 0 1 1 T R "); }
-                    else            { departedTime.show(); }
-                    mydelay(10);
-                }
+                destinationTime.startAnim(ttgDestP5Seq);
+                presentTime.startAnim(ttgPresP5Seq);
+                departedTime.startAnim(ttgDeptP5Seq);
                 break;
             default:
                 allOff();
@@ -3497,6 +3520,8 @@ void main_loop()
         if(destShowAlt > 0) destShowAlt--;
         if(depShowAlt > 0) depShowAlt--;
     } 
+
+    allFlushFrame();
 }
 
 #ifdef TC_HAVEMQTT
@@ -4170,7 +4195,8 @@ static void sendTTNetWorkMsg(uint16_t bttfnPayload, uint16_t bttfnPayload2)
         return;
     }
     #endif
-    bttfn_notify(BTTFN_TYPE_ANY, BTTFN_NOT_TT, bttfnPayload, bttfnPayload2);
+    // Payload is lead time: Clients with clock sync get absolute time
+    bttfn_notify(BTTFN_TYPE_ANY, BTTFN_NOT_TT, bttfnPayload, bttfnPayload2, 0, millis() + bttfnPayload);
 }
 
 // Send notification message via MQTT -or- BTTFN.
@@ -4350,6 +4376,30 @@ void restoreLastTime()
     departedTime.setFromStruct(&lastTimeBackup);
 }
 
+/*
+ * Advance date/time by one minute
+ */
+static void dateAddMinute(dateStruct& d)
+{
+    if(++d.minute < 60) return;
+    d.minute = 0;
+    if(++d.hour < 24) return;
+    d.hour = 0;
+    #ifdef TC_JULIAN_CAL
+    if(d.year == jSwitchYear && d.month == jSwitchMon && d.day == jSwitchDay) {
+        d.day += jSwitchSkipD;
+    }
+    #endif
+    if(++d.day <= daysInMonth(d.month, d.year)) return;
+    d.day = 1;
+    if(++d.month <= 12) return;
+    d.month = 1;
+    // Don't care about 9999-10000 roll-over
+    // So we display 0000 for 10000+
+    // So be it.
+    d.year++;
+}
+
 /*
  * Send date/time to presentTime: Either vanilla (LOCAL), or with timeDifference(to UTC)
  */
@@ -4372,40 +4422,55 @@ void updatePresentTime(uint8_t wdplus1)
     t.hour = gdtu.hour();
     t.minute = gdtu.minute();
 
-    if( (memcmp((void *)&ptCache.sDate, (void *)&t, sizeof(dateStruct))) ||
-        (ptCache.td != timeDifference) ||
-        (ptCache.tdup != timeDiffUp) ) {
+    if( (ptCache.td == timeDifference) &&
+        (ptCache.tdup == timeDiffUp) ) {
 
-        memcpy((void *)&ptCache.sDate, (void *)&t, sizeof(dateStruct));
-        ptCache.td = timeDifference;
-        ptCache.tdup = timeDiffUp;
-        
-        int year = t.year;
-        int month = t.month;
-        int day = t.day; 
-        int hour = t.hour; 
-        int minute = t.minute;
-
-        uint64_t utcMins = dateToMins(year, month, day, hour, minute);
+        // Same minute: Nothing to do
+        if(!memcmp((void *)&ptCache.sDate, (void *)&t, sizeof(dateStruct))) {
+            presentTime.setFromStruct(&ptCache.tDate);
+            return;
+        }
 
-        if(timeDiffUp) {
-            utcMins += timeDifference;
-            // Don't care about 9999-10000 roll-over
-            // So we display 0000 for 10000+
-            // So be it.
-        } else {
-            utcMins -= timeDifference;
+        // Next minute: Advance shifted time in step
+        dateAddMinute(ptCache.sDate);
+        if(!memcmp((void *)&ptCache.sDate, (void *)&t, sizeof(dateStruct))) {
+            dateAddMinute(ptCache.tDate);
+            presentTime.setFromStruct(&ptCache.tDate);
+            return;
         }
+    }
 
-        minsToDate(utcMins, year, month, day, hour, minute);
-        
-        ptCache.tDate.year = year;
-        ptCache.tDate.month = month;
-        ptCache.tDate.day = day;
-        ptCache.tDate.hour = hour;
-        ptCache.tDate.minute = minute;
+    // Time difference changed, or RTC stepped: Recalc
+    
+    memcpy((void *)&ptCache.sDate, (void *)&t, sizeof(dateStruct));
+    ptCache.td = timeDifference;
+    ptCache.tdup = timeDiffUp;
+    
+    int year = t.year;
+    int month = t.month;
+    int day = t.day; 
+    int hour = t.hour; 
+    int minute = t.minute;
+
+    uint64_t utcMins = dateToMins(year, month, day, hour, minute);
+
+    if(timeDiffUp) {
+        utcMins += timeDifference;
+        // Don't care about 9999-10000 roll-over
+        // So we display 0000 for 10000+
+        // So be it.
+    } else {
+        utcMins -= timeDifference;
     }
 
+    minsToDate(utcMins, year, month, day, hour, minute);
+    
+    ptCache.tDate.year = year;
+    ptCache.tDate.month = month;
+    ptCache.tDate.day = day;
+    ptCache.tDate.hour = hour;
+    ptCache.tDate.minute = minute;
+
     presentTime.setFromStruct(&ptCache.tDate);
 }
 
@@ -4594,6 +4659,7 @@ static void mySetupDelay(unsigned int mydel, bool heavy)
     unsigned long startNow = millis();
 
     while(millis() - startNow < mydel) {
+        i2cSched.newSlice();
         audio_loop();
         ntp_short_loop();
         #if defined(TC_HAVEGPS) || defined(TC_HAVE_RE) || defined(TC_HAVE_REMOTE)
@@ -4622,6 +4688,7 @@ static void waitAudioDoneSetup()
     unsigned long startNow = millis();
 
     while(!checkAudioDone() && (millis() - startNow < 2000)) {
+        i2cSched.newSlice();
         audio_loop();
         ntp_short_loop();
         bttfn_loop(BNLP_SK_EXPIRE);
@@ -4695,24 +4762,55 @@ void mydelay(unsigned long mydel)
 {
     unsigned long elap = 0;
     unsigned long startNow = millis();
+    bool wasHeld = frameHeld;
+
+    // Show what was rendered so far; hold again afterwards
+    if(wasHeld) allFlushFrame();
 
     if(mydel <= 10) {
         while(millis() - startNow < mydel) {
             ntp_short_loop();
             audio_loop_quick();
+            allAnimLoop();
+        }
+    } else {
+        while(millis() - startNow < mydel) {
+            i2cSched.newSlice();
+            ntp_short_loop();
+            allAnimLoop();
+            bttfn_loop(BNLP_SK_MC|BNLP_SK_NOTDATA|BNLP_SK_EXPIRE);
+            audio_loop();
+            #if defined(TC_HAVEGPS) || defined(TC_HAVE_RE) || defined(TC_HAVE_REMOTE)
+            speedoUpdate_loop(false);  // GPS part: 6-12ms without delay, 8-13ms with delay
+            audio_loop_quick();
+            #endif
         }
-        return;
     }
 
-    while(millis() - startNow < mydel) {
-        ntp_short_loop();
-        bttfn_loop(BNLP_SK_MC|BNLP_SK_NOTDATA|BNLP_SK_EXPIRE);
-        audio_loop();
-        #if defined(TC_HAVEGPS) || defined(TC_HAVE_RE) || defined(TC_HAVE_REMOTE)
-        speedoUpdate_loop(false);  // GPS part: 6-12ms without delay, 8-13ms with delay
-        audio_loop_quick();
-        #endif
-    }
+    if(wasHeld) allHoldFrame();
+}
+
+/*
+ * I2C bus scheduling for bulk reads
+ * "late" is the time (ms) the job is past due.
+ */
+static bool i2cJobGrant(int job, unsigned long late)
+{
+    // Keep the bus free for keypad scans and display updates
+    i2cSched.setForeground(keypadInputActive());
+
+    return i2cSched.grant(job, late);
+}
+
+static void i2cJobStart(int job)
+{
+    i2cSched.start(job);
+    i2cJobNow = micros();
+}
+
+static void i2cJobDone(int job)
+{
+    i2cSched.done(job, micros() - i2cJobNow);
 }
 
 // Call this to get full CPU speed
@@ -4960,8 +5058,10 @@ static void updateTemperature(bool force)
         tui = 5 * 1000;
     }
         
-    if(force || (now - tempReadNow >= tui)) {
+    if(force || ((now - tempReadNow >= tui) && i2cJobGrant(I2CJ_TEMP, now - tempReadNow - tui))) {
+        i2cJobStart(I2CJ_TEMP);
         tempSens.readTemp();
+        i2cJobDone(I2CJ_TEMP);
         tempReadNow = now;
     }
 }
@@ -5326,25 +5426,31 @@ void animate(bool withLEDs)
 
     #ifndef TC_NO_MONTH_ANIM  // ---------------------
 
+    // Time displays are animated in the background;
+    // only nav/temp/hum displays need us to wait
+    bool needWait = false;
+
     for(bool i : { true, false }) {
         #ifdef TC_HAVEGPS
         if(isNavMode()) {
             if(i) gpsMakePos(destDisp, depDisp);
             destinationTime.showNavDirect(destDisp, i);
             departedTime.showNavDirect(depDisp, i);
+            needWait = true;
         } else
         #endif
         #ifdef TC_HAVETEMP
         if(isRcMode() && (!isWcMode() || (!(wcf & WCF_HaveTZ1)))) {
             destinationTime.showTempDirect(tempSens.readLastTemp(), i);
+            needWait = true;
         } else
         #endif
             if(isMiniMode())
                 destinationTime.clearDisplay();
-            else
-                destinationTime.showAnimate(i);
+            else if(i)
+                destinationTime.startAnim(tcdAnimMonth);
     
-        presentTime.showAnimate(i);
+        if(i) presentTime.startAnim(tcdAnimMonth);
     
         #ifdef TC_HAVEGPS
         if(!isNavMode()) {
@@ -5353,23 +5459,26 @@ void animate(bool withLEDs)
             if(isRcMode()) {
                 if(isWcMode() && (wcf & WCF_HaveTZ1)) {
                     departedTime.showTempDirect(tempSens.readLastTemp(), i);
+                    needWait = true;
                 } else if(!isWcMode() && tempSens.haveHum()) {
                     departedTime.showHumDirect(tempSens.readHum(), i);
-                } else {
-                    departedTime.showAnimate(i);
+                    needWait = true;
+                } else if(i) {
+                    departedTime.startAnim(tcdAnimMonth);
                 }
             } else
             #endif
                 if(isMiniMode())
                     departedTime.clearDisplay();
-                else
-                    departedTime.showAnimate(i);
+                else if(i)
+                    departedTime.startAnim(tcdAnimMonth);
         #ifdef TC_HAVEGPS
         }
         #endif
 
         if(i) {
             if(withLEDs) leds_on();
+            if(!needWait) break;
             mydelay(80);
         }
     }
@@ -5426,6 +5535,86 @@ void animate(bool withLEDs)
     #endif // TC_NO_MONTH_ANIM  ---------------------
 }
 
+/*
+ * Time travel display disruption
+ * Steps of the P1 animation sequences (ii counts down)
+ */
+static bool ttgShowOn(tcdDisplay *d, int ii)
+{
+    d->show();
+    d->on();
+    return true;
+}
+
+static bool ttgOnFull(tcdDisplay *d, int ii)
+{
+    d->setBrightness(255);
+    d->on();
+    return true;
+}
+
+static bool ttgDestP4(tcdDisplay *d, int ii)
+{
+    int tt = rand() % 21;
+    if(tt < 5) d->show();
+    else {
+        d->showTextDirect(p1errStrs[(tt - 5) >> 2], CDT_COLON);
+    }
+    if(!(ii % 2)) d->setBrightnessDirect((1+(rand() % 10)) & 0x0a);
+    return true;
+}
+
+static bool ttgPresP4(tcdDisplay *d, int ii)
+{
+    if(ii % 2) d->setBrightnessDirect((1+(rand() % 10)) & 0x0b);
+    return true;
+}
+
+static bool ttgDeptP4(tcdDisplay *d, int ii)
+{
+    ((rand() % 10) < 3) ? d->showTextDirect(">ACS2011GIDUW") : d->show();
+    if(ii % 2) d->setBrightnessDirect((1+(rand() % 10)) & 0x07);
+    return true;
+}
+
+static bool ttgPresP5(tcdDisplay *d, int ii)
+{
+    int tt = rand() % 10;
+    if(!(ii % 4))   d->setBrightnessDirect(1+(rand() % 8));
+    if(tt < 3)      { d->setBrightnessDirect(4); d->showPattern(true); }
+    else if(tt < 7) { d->show(); d->on(); }
+    else            { d->off(); }
+    return true;
+}
+
+static bool ttgDestP5(tcdDisplay *d, int ii)
+{
+    int tt = (rand() + millis()) % 10;
+    if(tt < 3)      { d->showTextDirect(p1errStrs[rand() % 4], CDT_COLON); }
+    else if(tt < 6) { d->show(); d->on(); }
+    else            { if(!(ii % 2)) d->setBrightnessDirect(1+(rand() % 8)); }
+    return true;
+}
+
+static bool ttgDeptP5(tcdDisplay *d, int ii)
+{
+    int tt = (rand() + millis()) % 10;
+    if(tt < 4)      { d->setBrightnessDirect(4); d->showPattern(true); }
+    else if(tt < 6) { d->showTextDirect("R 2 0 1 1 T R "); }
+    else            { d->show(); }
+    return true;
+}
+
+/*
+ * Drive display animations
+ */
+void allAnimLoop()
+{
+    destinationTime.animLoop();
+    presentTime.animLoop();
+    departedTime.animLoop();
+}
+
 // Activate lamp test on all displays and turn on
 void allShowPattern()
 {
@@ -5456,6 +5645,34 @@ void allresetBrightness()
     departedTime.resetBrightness();
 }
 
+/*
+ * Display frames: While a frame is held, display RAM
+ * updates only go to the displays' back buffers. 
+ * allFlushFrame() then sends all changed displays 
+ * back-to-back. Returns the number of bytes sent.
+ */
+void allHoldFrame()
+{
+    destinationTime.holdFrame();
+    presentTime.holdFrame();
+    departedTime.holdFrame();
+    speedo.holdFrame();
+    frameHeld = true;
+}
+
+int allFlushFrame()
+{
+    int ret;
+
+    ret  = destinationTime.flushFrame();
+    ret += presentTime.flushFrame();
+    ret += departedTime.flushFrame();
+    ret += speedo.flushFrame();
+    frameHeld = false;
+
+    return ret;
+}
+
 static void startDisplays()
 {
     presentTime.begin();
@@ -5987,9 +6204,11 @@ void speedoUpdate_loop(bool async)
 {
     bool chg = false;
     #ifdef TC_HAVEGPS
-    if((sgf & SGF_UGPS) && (millis64() >= lastLoopGPS)) {
+    if((sgf & SGF_UGPS) && (millis64() >= lastLoopGPS) && i2cJobGrant(I2CJ_GPS, millis64() - lastLoopGPS)) {
         lastLoopGPS += (uint64_t)GPSupdateFreq;
+        i2cJobStart(I2CJ_GPS);
         myGPS.loop(false);
+        i2cJobDone(I2CJ_GPS);
         if(sgf & SGF_DispGPSSpd) chg |= displayGPSorRESpeed(true);
     }
     #endif
@@ -6107,236 +6326,132 @@ bool isLeapYear(int year)
 }
 #endif
 
+/*
+ *  Number of days from 1/1/0 to 1/1/year
+ */
+#ifndef TC_JULIAN_CAL
+static constexpr uint32_t daysBeforeYear(int year)
+{
+    // Year 0 is a leap year
+    return (year * 365) + ((year + 3) / 4) - ((year + 99) / 100) + ((year + 399) / 400);
+}
+#else
+static constexpr uint32_t daysBeforeYear(int year)
+{
+    // After switch, subtract Gregorian non-leap centuries, and skipped days
+    return (year * 365) + ((year + 3) / 4) - 
+           ((year > jSwitchYear) ? 
+              ((((year + 99) / 100) - ((year + 399) / 400)) - jSwitchNLC) + jSwitchSkipD : 0);
+}
+#endif
+
+/*
+ *  Find year for given number of days since 1/1/0
+ */
+static int yearFromDays(uint32_t days)
+{
+    // Estimate is off by one year at most
+    int year = (days * 400U) / 146097U;
+    
+    if(daysBeforeYear(year + 1) <= days) year++;
+    else if(daysBeforeYear(year) > days) year--;
+
+    return year;
+}
+
 /*
  *  Convert a date into "minutes since 1/1/0 0:0"
  */
 #ifndef TC_JULIAN_CAL 
 uint64_t dateToMins(int year, int month, int day, int hour, int minute)
 {
-    uint64_t total64 = 0;
-    uint32_t total32 = 0;
-    int c = year, d = 0;        // ny0: d=1
-
-    if(year < 11000) {
-        total32 = hours1kYears[year / 500];
-        if(total32) d = (year / 500) * 500;
-    } else {
-        total32 = hours1kYears[(sizeof(hours1kYears)/sizeof(hours1kYears[0]))-1];
-        d = ((sizeof(hours1kYears)/sizeof(hours1kYears[0]))-1) * 500;
-    }
-
-    while(c-- > d) {
-        total32 += (isLeapYear(c) ? (8760+24) : 8760);
-    }
-    total32 += (mon_yday[isLeapYear(year) ? 1 : 0][month - 1] * 24);
-    total32 += (day - 1) * 24;
-    total32 += hour;
-    total64 = (uint64_t)total32 * 60;
-    total64 += minute;
-    return total64;
+    uint32_t total32 = daysBeforeYear(year);
+    
+    total32 += mon_yday[isLeapYear(year) ? 1 : 0][month - 1];
+    total32 += day - 1;
+    total32 = (total32 * 24) + hour;
+    
+    return ((uint64_t)total32 * 60) + minute;
 }
 #else
 uint64_t dateToMins(int year, int month, int day, int hour, int minute)
 {
-    uint64_t total64 = 0;
-    uint32_t total32 = 0;
-    int c = year, d = 0;        // ny0: d=1
-
-    if(year < 11000) {
-        total32 = hours1kYears[year / 100];
-        if(total32) d = (year / 100) * 100;
-    } else {
-        total32 = hours1kYears[(sizeof(hours1kYears)/sizeof(hours1kYears[0]))-1];
-        d = ((sizeof(hours1kYears)/sizeof(hours1kYears[0]))-1) * 100;
-    }
+    uint32_t total32 = daysBeforeYear(year);
 
-    if(c < jCentStart || c > jCentEnd) {
-        while(c-- > d) {
-            total32 += (isLeapYear(c) ? (8760+24) : 8760);
-        }
-        total32 += (mon_yday[isLeapYear(year) ? 1 : 0][month - 1] * 24);
-        total32 += (day - 1) * 24;
-    } else {
-        while(c-- > d) {
-            total32 += ((c == jSwitchYear) ? jSwitchYrHrs : (isLeapYear(c) ? (8760+24) : 8760));
-        }
-        if(year == jSwitchYear) {
-            total32 += (mon_yday_jSwitch[month - 1] * 24);
-            if(month == jSwitchMon) {
-                if(day <= jSwitchDay) {
-                    total32 += (day - 1) * 24;
-                } else if(day > jSwitchDay + jSwitchSkipD) {
-                    total32 += (day - jSwitchSkipD - 1) * 24;
-                } else {
-                    Serial.printf("Bad date!\n");
-                }
+    if(year == jSwitchYear) {
+        total32 += mon_yday_jSwitch[month - 1];
+        if(month == jSwitchMon) {
+            if(day <= jSwitchDay) {
+                total32 += day - 1;
+            } else if(day > jSwitchDay + jSwitchSkipD) {
+                total32 += day - jSwitchSkipD - 1;
             } else {
-                total32 += (day - 1) * 24;
+                Serial.printf("Bad date!\n");
             }
         } else {
-            total32 += (mon_yday[isLeapYear(year) ? 1 : 0][month - 1] * 24);
-            total32 += (day - 1) * 24;
+            total32 += day - 1;
         }
+    } else {
+        total32 += mon_yday[isLeapYear(year) ? 1 : 0][month - 1];
+        total32 += day - 1;
     }
-
-    total32 += hour;
-    total64 = (uint64_t)total32 * 60;
-    total64 += minute;
-    return total64;
+    total32 = (total32 * 24) + hour;
+    
+    return ((uint64_t)total32 * 60) + minute;
 }
 #endif
 
 /*
  *  Convert "minutes since 1/1/0 0:0" into date
  */
-#ifndef TC_JULIAN_CAL
 void minsToDate(uint64_t total64, int& year, int& month, int& day, int& hour, int& minute)
 {
-    int c = 0, d = (sizeof(mins1kYears)/sizeof(mins1kYears[0]))-1;  // ny0: c=1
-    int temp;
-    uint32_t total32;
-
-    year = 0;             // ny0: 1
-    month = day = 1;
-    hour = minute = 0;
+    // Avoid 64bit division: x / 1440 = (x / 32) / 45
+    uint32_t days = (uint32_t)(total64 >> 5) / 45;
+    uint32_t total32 = (uint32_t)total64 - (days * (24*60));
+    const unsigned int *myd;
+    int c;
 
-    while(d >= 0) {
-        if(total64 > mins1kYears[d]) break;
-        d--;
-    }
-    if(d > 0) {
-        total64 -= mins1kYears[d];
-        c = year = d * 500;
-    }
+    year = yearFromDays(days);
+    days -= daysBeforeYear(year);
 
-    total32 = total64;
+    // No month has more than 32 days, so start search there
+    c = (days >> 5) + 1;
 
-    while(1) {
-        temp = isLeapYear(c++) ? ((8760+24)*60) : (8760*60);
-        if(total32 < temp) break;
-        year++;
-        total32 -= temp;
+    myd = mon_yday[isLeapYear(year) ? 1 : 0];
+    #ifdef TC_JULIAN_CAL
+    if(year == jSwitchYear) {
+        myd = mon_yday_jSwitch;
     }
-
-    c = 1;
-    temp = isLeapYear(year) ? 1 : 0;
+    #endif
+    
     while(c < 12) {
-        if(total32 < (mon_ydayt24t60[temp][c])) break;
+        if(days < myd[c]) break;
         c++;
     }
     month = c;
-    total32 -= (mon_ydayt24t60[temp][c-1]);
-
-    temp = total32 / (24*60);
-    day = temp + 1;
-    total32 -= (temp * (24*60));
-
-    temp = total32 / 60;
-    hour = temp;
-
-    minute = total32 - (temp * 60);
-}
-#else
-void minsToDate(uint64_t total64, int& year, int& month, int& day, int& hour, int& minute)
-{
-    int c = 0, d = (sizeof(mins1kYears)/sizeof(mins1kYears[0]));    // ny0: c=1
-    int temp;
-    uint32_t total32;
-    
-    year = 0;             // ny0: 1
-    month = day = 1;
-    hour = minute = 0;
-  
-    d = (total64 < mins1kYears[d/2]) ? d / 2 : d - 1;
-
-    while(d >= 0) {
-        if(total64 > mins1kYears[d]) break;
-        d--;
-    }
-    if(d > 0) {
-        total64 -= mins1kYears[d];
-        c = year = d * 100;
-    }
-    
-    total32 = total64;
+    day = days - myd[c-1] + 1;
 
-    if(c < jCentStart || c > jCentEnd) {
-        while(1) {
-            temp = isLeapYear(c++) ? ((8760+24)*60) : (8760*60);
-            if(total32 < temp) break;
-            year++;
-            total32 -= temp;
-        }
-    } else {
-        while(1) {
-            temp = ((c == jSwitchYear) ? jSwitchYrHrs : (isLeapYear(c) ? (8760+24) : 8760)) * 60;
-            if(total32 < temp) break;
-            c++;
-            year++;
-            total32 -= temp;
-        }
+    #ifdef TC_JULIAN_CAL
+    if(year == jSwitchYear && month == jSwitchMon && day > jSwitchDay) {
+        day += jSwitchSkipD;
     }
+    #endif
 
-    c = 1;
-    if(year == jSwitchYear) {
-        while(c < 12) {
-            if(total32 < (mon_ydayt24t60J[c])) break;
-            c++;
-        }
-        month = c;
-        total32 -= (mon_ydayt24t60J[c-1]);
-  
-        temp = total32 / (24*60);
-        day = temp + 1;
-        if(month == jSwitchMon && day > jSwitchDay) {
-            day += jSwitchSkipD;
-        }
-    } else {      
-        temp = isLeapYear(year) ? 1 : 0;
-        while(c < 12) {
-            if(total32 < (mon_ydayt24t60[temp][c])) break;
-            c++;
-        }
-        month = c;
-        total32 -= (mon_ydayt24t60[temp][c-1]);
-
-        temp = total32 / (24*60);
-        day = temp + 1;
-    }
-    total32 -= (temp * (24*60));
-    
-    temp = total32 / 60;
-    hour = temp;
-
-    minute = total32 - (temp * 60);
+    hour = total32 / 60;
+    minute = total32 - (hour * 60);
 }
-#endif
 
 uint32_t getHrs1KYrs(int index)
 {
-    return hours1kYears[index*2];
+    #ifndef TC_JULIAN_CAL
+    return daysBeforeYear(index * 1000) * 24;
+    #else
+    return daysBeforeYear(index * 200) * 24;
+    #endif
 }
 
 #ifdef TC_JULIAN_CAL
-static void calcJulianData()
-{
-    int l = isLeapYear(jSwitchYear) ? 1 : 0;
-  
-    for(int i = 0; i < 13; i++) {
-        mon_yday_jSwitch[i] = mon_yday[l][i];
-    }
-    for(int i = jSwitchMon; i < 13; i++) {
-        mon_yday_jSwitch[i] -= jSwitchSkipD;
-    }
-    for(int i = 0; i < 13; i++) {
-        mon_ydayt24t60J[i] = mon_yday_jSwitch[i] * 24 * 60;
-    }
-    
-    jSwitchYrHrs = (l ? (8760+24) : 8760) - jSwitchSkipH;
-
-    jSwitchHash = (jSwitchYear << 16) | (jSwitchMon << 8) | jSwitchDay;
-} 
-
 void correctNonExistingDate(int year, int month, int& day)
 {
   if(year == jSwitchYear && month == jSwitchMon) {
@@ -6397,21 +6512,22 @@ static char *parseInt(char *t, int& it)
 }
 
 /*
- * Parse DST parts of TZ string
+ * Compile DST part of TZ string into rule
  */
-static char *parseDST(char *t, int& DSTyear, int& DSTmonth, int& DSTday, int& DSThour, int& DSTmin, int currYear, int correction)
+static char *compileDST(char *t, tzRule& rule)
 {
     char *u;
-    int it, tw, dow;
+    int it, mins;
+    bool isNeg;
 
-    DSTyear = currYear;
-    DSTmin = 0;
+    rule.type = *t;
+    rule.mins = 2 * 60;
     
     if(*t == 'M') {
         t++;
         u = parseInt(t, it);
         if(!u) return NULL;
-        if(it >= 1 && it <= 12) DSTmonth = it;
+        if(it >= 1 && it <= 12) rule.month = it;
         else                    return NULL;
             
         t = u;
@@ -6420,7 +6536,7 @@ static char *parseDST(char *t, int& DSTyear, int& DSTmonth, int& DSTday, int& DS
         u = parseInt(t, it);
         if(!u) return NULL;
         if(it < 1 || it > 5) return NULL;
-        tw = it;
+        rule.week = it;
         
         t = u;        
         if(*t++ != '.') return NULL;
@@ -6428,18 +6544,9 @@ static char *parseDST(char *t, int& DSTyear, int& DSTmonth, int& DSTday, int& DS
         u = parseInt(t, it);
         if(!u) return NULL;
         if(it < 0 || it > 6) return NULL;
+        rule.wday = it;
 
         t = u;
-        
-        // it = weekday (0=Su), tw = week (1,2,3,4=nth week; 5=last)
-        dow = dayOfWeek(1, DSTmonth, currYear);
-        if(dow == 0) dow = 7;
-        DSTday = (it+1) - dow;
-        if(DSTday < 1) DSTday += 7;
-        while(--tw) {
-             DSTday += 7;
-        }
-        if(DSTday > daysInMonth(DSTmonth, currYear)) DSTday -= 7;
 
     } else if(*t == 'J') {
 
@@ -6448,15 +6555,9 @@ static char *parseDST(char *t, int& DSTyear, int& DSTmonth, int& DSTday, int& DS
         if(!u) return NULL;
 
         if(it < 1 || it > 365) return NULL;
+        rule.day = it;
         
         t = u;
-
-        DSTmonth = 0;
-        while(it > monthDays[DSTmonth]) {
-            it -= monthDays[DSTmonth++];
-        }
-        DSTmonth++;
-        DSTday = it;
       
     } else if(*t >= '0' && *t <= '9') {
 
@@ -6464,27 +6565,23 @@ static char *parseDST(char *t, int& DSTyear, int& DSTmonth, int& DSTday, int& DS
         if(!u) return NULL;
 
         if(it < 0 || it > 365) return NULL;
-        if((it > 364) && (!isLeapYear(currYear))) return NULL;
+        rule.type = 'n';
+        rule.day = it;
         
         t = u;
-
-        it++;
-        DSTmonth = 1;
-        while(it > daysInMonth(DSTmonth, currYear)) {
-            it -= daysInMonth(DSTmonth, currYear);
-            DSTmonth++;
-        }
-        DSTday = it;
       
     } else return NULL;
 
+    // Time: [+-]hh[:mm[:ss]], hh up to 167; sign applies to 
+    // minutes as well ("-0:30" is half an hour before midnight)
     if(*t == '/') {
         t++;
+        isNeg = (*t == '-');
         u = parseInt(t, it);
         if(!u) return NULL;
         
         t = u;
-        if(it >= -167 && it <= 167) DSThour = it;
+        if(it >= -167 && it <= 167) mins = abs(it) * 60;
         else return NULL;
         
         if(*t == ':') {
@@ -6493,7 +6590,7 @@ static char *parseDST(char *t, int& DSTyear, int& DSTmonth, int& DSTday, int& DS
             if(!u) return NULL;
             
             t = u;
-            if(it >= 0 && it <= 59) DSTmin = it;
+            if(it >= 0 && it <= 59) mins += it;
             else return NULL;
             
             if(*t == ':') {
@@ -6503,79 +6600,177 @@ static char *parseDST(char *t, int& DSTyear, int& DSTmonth, int& DSTday, int& DS
                 t = u;
             }
         }
-    } else {
-        DSThour = 2;    
-    }
-
-    // Correction used for converting DST-end to non-DST
-    if(correction > 0) {
-        DSTmin -= correction;
-        while(DSTmin < 0) {
-            DSTmin += 60;
-            DSThour--;
-        }
-    } else if(correction < 0) {
-        DSTmin -= correction;
-        while(DSTmin > 59) {
-            DSTmin -= 60;
-            DSThour++;
-        }
-    }
 
-    if(DSThour > 23) {
-        while(DSThour > 23) {
-            DSTday++;
-            DSThour -= 24;
-        }
-        while(DSTday > daysInMonth(DSTmonth, DSTyear)) {
-            DSTday -= daysInMonth(DSTmonth, DSTyear);
-            DSTmonth++;
-            if(DSTmonth > 12) {
-                DSTyear++;
-                DSTmonth = 1;
-            }
-        }
-    } else if(DSThour < 0) {
-        while(DSThour < 0) {
-            DSTday--;
-            DSThour += 24;
-        }
-        while(DSTday < 1) {
-            DSTmonth--;
-            if(DSTmonth < 1) {
-                DSTyear--;
-                DSTmonth = 12;
-            }
-            DSTday += daysInMonth(DSTmonth, DSTyear);
-        }
+        rule.mins = isNeg ? -mins : mins;
     }
     
     return t;
 }
 
 /*
- * Convert date into minutes since 1/1 00:00 of given year
+ * Day of year (0-365) for DST start or end rule
  */
-int mins2Date(int year, int month, int day, int hour, int mins)
-{
-    return ((((mon_yday[isLeapYear(year) ? 1 : 0][month - 1] + (day - 1)) * 24) + hour) * 60) + mins;
-}
+static int ruleYDay(const tzRule& rule, int year)
+{
+    int dow, day;
+
+    switch(rule.type) {
+    case 'M':
+        // wday = weekday (0=Su), week = week (1,2,3,4=nth week; 5=last)
+        dow = dayOfWeek(1, rule.month, year);
+        day = rule.wday - dow;
+        if(day < 0) day += 7;
+        day += (rule.week - 1) * 7;
+        if(day >= daysInMonth(rule.month, year)) day -= 7;
+        return mon_yday[isLeapYear(year) ? 1 : 0][rule.month - 1] + day;
+    case 'J':
+        // 1-365, Feb 29 never counted
+        return rule.day - 1 + ((rule.day >= 60 && isLeapYear(year)) ? 1 : 0);
+    default:
+        // 0-365, Feb 29 counted; 365 in non-leap years is Jan 1 of next year
+        return rule.day;
+    }
+}
+
+/*
+ * Convert date into minutes since 1/1 00:00 of given year
+ */
+int mins2Date(int year, int month, int day, int hour, int mins)
+{
+    return ((((mon_yday[isLeapYear(year) ? 1 : 0][month - 1] + (day - 1)) * 24) + hour) * 60) + mins;
+}
+
+/*
+ * Calculate DST start and end for given (UTC) year from compiled rules
+ *
+ * Like libc, we evaluate the rules for the UTC year of the time in
+ * question, and take start and end as they are, even if they are
+ * outside of that year due to rule times beyond 0-24 hours.
+ * Start is in local non-DST time, end in local DST time; both are
+ * converted to UTC.
+ */
+static void calcDSTYear(int index, int currYear, tzYearData *td)
+{
+    td->onMins  = (ruleYDay(tzRules[index][0], currYear) * (24*60)) + tzRules[index][0].mins + tzDiffGMT[index];
+    td->offMins = (ruleYDay(tzRules[index][1], currYear) * (24*60)) + tzRules[index][1].mins + tzDiffGMTDST[index];
+    td->couldDST = (td->onMins != td->offMins);
+
+    #ifdef TC_DBG_TIME
+    Serial.printf("parseTZ: (%d) %d/%d(%d) DST %d: %d - %d (UTC mins)\n",
+                index,
+                tzDiffGMT[index], tzDiffGMTDST[index], tzDiff[index],
+                currYear, td->onMins, td->offMins);
+    #endif
+}
+
+/*
+ * Built-in time zone table (tc_tzdb.h)
+ */
+
+// Compare name against table entry (case-insensitive)
+static int tzdbCmp(const char *name, uint32_t e)
+{
+    const char *s = tzdbRegions + tzdbRegOffs[TZDB_REGION(e)];
+    int a, b;
+
+    for(int i = 0; i < 2; i++) {
+        while(*s) {
+            a = tolower(*name++);
+            b = tolower(*s++);
+            if(a != b) return a - b;
+        }
+        s = tzdbNames + TZDB_NAME(e);
+    }
+
+    return tolower(*name);
+}
+
+int tzdbFind(const char *name)
+{
+    int l = 0, r = TZDB_COUNT - 1;
+
+    while(l <= r) {
+        int m = (l + r) >> 1;
+        int c = tzdbCmp(name, tzdbIndex[m]);
+        if(!c) return m;
+        if(c < 0) r = m - 1;
+        else      l = m + 1;
+    }
+
+    return -1;
+}
+
+int tzdbCount()
+{
+    return TZDB_COUNT;
+}
+
+static_assert(TZ_NAMEBUF_LEN > TZDB_MAXNAMELEN, "TZ_NAMEBUF_LEN too small");
+
+// buf must hold TZ_NAMEBUF_LEN chars
+bool tzdbGetName(int idx, char *buf)
+{
+    if(idx < 0 || idx >= TZDB_COUNT) return false;
+
+    uint32_t e = tzdbIndex[idx];
+    strcpy(buf, tzdbRegions + tzdbRegOffs[TZDB_REGION(e)]);
+    strcat(buf, tzdbNames + TZDB_NAME(e));
+
+    return true;
+}
+
+const char *tzdbGetPosix(int idx)
+{
+    if(idx < 0 || idx >= TZDB_COUNT) return NULL;
+
+    return tzdbPosix + TZDB_POSIX(tzdbIndex[idx]);
+}
+
+/*
+ * Select zone <idx> from the table as main time zone
+ */
+bool tzdbSelect(int idx)
+{
+    DateTime dtu;
+
+    if(!tzdbGetName(idx, settings.timeZone)) return false;
+
+    write_settings();
+
+    myrtcnow(dtu);
+    return resetTZ(0, dtu.year());
+}
+
+/*
+ * Forget everything known about TZ <index> and
+ * re-parse it (after the setting was changed)
+ */
+bool resetTZ(int index, int currYear)
+{
+    tzIsValid[index] = -1;
+    tzHasDST[index] = -1;
+    tzDSTpart[index] = NULL;
+
+    return parseTZ(index, currYear);
+}
 
 /*
  * Parse TZ string and setup DST data
- * 
+ *
+ * The TZ setting is either a POSIX TZ string or a zone
+ * name from the built-in table ("Europe/Vienna").
+ *
  * If TZ-part is bad, always returns FALSE
  * If DST-part is bad, only returns FALSE once
  * (DST-part ignored if bad in later calls)
  */
 bool parseTZ(int index, int currYear, bool doparseDST)
 {
-    char *tz, *t, *u, *v;
+    char *tz, *t, *u;
     int diffNorm = 0;
     int diffDST = 0;
     int it;
-    int DSTonYear, DSTonMonth, DSTonDay, DSTonHour, DSTonMinute;
-    int DSToffYear, DSToffMonth, DSToffDay, DSToffHour, DSToffMinute;
+    bool isNeg;
 
     switch(index) {
     case 0: tz = settings.timeZone;     break;
@@ -6585,6 +6780,12 @@ bool parseTZ(int index, int currYear, bool doparseDST)
         return false;
     }
 
+    // Zone name? (POSIX strings have no '/' before the first ',')
+    if(!tzDSTpart[index] && strchr(tz, '/') && !strchr(tz, ',')) {
+        const char *p = tzdbGetPosix(tzdbFind(tz));
+        if(p) tz = (char *)p;
+    }
+
     couldDST[index] = false;
     tzForYear[index] = 0;
     if(!tzDSTpart[index]) {
@@ -6636,6 +6837,7 @@ bool parseTZ(int index, int currYear, bool doparseDST)
         if(*t != '-' && *t != '+' && (*t < '0' || *t > '9'))
             return false;                             // No numerical difference after name -> bad string. Bad TZ.
     
+        isNeg = (*t == '-');
         t = parseInt(t, it);
         if(it >= -24 && it <= 24) diffNorm = it * 60;
         else                      return false;       // Bad hr difference. No DST.
@@ -6646,8 +6848,8 @@ bool parseTZ(int index, int currYear, bool doparseDST)
             if(!u) return false;                      // No number following ":". Bad string. Bad TZ.
             t = u;
             if(it >= 0 && it <= 59) {
-                if(diffNorm < 0)  diffNorm -= it;
-                else              diffNorm += it;
+                if(isNeg) diffNorm -= it;             // "-0:30" is -30
+                else      diffNorm += it;
             } else return false;                      // Bad min difference. Bad TZ.
             if(*t == ':') {
                 t++;
@@ -6674,6 +6876,7 @@ bool parseTZ(int index, int currYear, bool doparseDST)
         } else if(*t != '-' && *t != '+' && (*t < '0' || *t > '9')) {
             tzDiff[index] = 60;                       // No numerical difference after name -> Assume 1 hr
         } else {
+            isNeg = (*t == '-');
             t = parseInt(t, it);
             if(it >= -24 && it <= 24) diffDST = it * 60;
             else                      return false;   // Bad hr difference. Bad TZ.
@@ -6683,8 +6886,8 @@ bool parseTZ(int index, int currYear, bool doparseDST)
                 if(!u) return false;                  // No number following ":". Bad TZ.
                 t = u;
                 if(it >= 0 && it <= 59) {
-                    if(diffDST < 0)  diffDST -= it;
-                    else             diffDST += it;
+                    if(isNeg) diffDST -= it;
+                    else      diffDST += it;
                 } else return false;                  // Bad min difference. Bad TZ.
                 if(*t == ':') {
                     t++;
@@ -6712,184 +6915,98 @@ bool parseTZ(int index, int currYear, bool doparseDST)
     if(!tzHasDST[index] || !doparseDST) {
         return true;
     }
+
+    // 2) Compile DST start and end rules (once)
+
+    if(tzHasDST[index] < 0) {
     
-    if(*t == 0 || *t != ',') {                        // No DST definition. No DST.
-        tzHasDST[index] = 0;
-        return true;
-    }
+        if(*t == 0 || *t != ',') {                    // No DST definition. No DST.
+            tzHasDST[index] = 0;
+            return true;
+        }
 
-    t++;
+        t++;
 
-    tzForYear[index] = currYear;
+        // Set to "no DST" until verified valid
+        tzHasDST[index] = 0;
 
-    // Set to "no DST" until verified valid
-    tzHasDST[index] = 0;
-
-    // 2) parse DST start
-
-    v = t;
-    u = parseDST(t, DSTonYear, DSTonMonth, DSTonDay, DSTonHour, DSTonMinute, currYear, 0);
-    if(!u) return false;
-
-    // If start crosses end year (due to hour numbers >= 24), need to calculate 
-    // for previous year (which then might be in current year). 
-    // The same goes for the other direction vice versa.
-    if(DSTonYear > currYear) {
-        u = parseDST(v, DSTonYear, DSTonMonth, DSTonDay, DSTonHour, DSTonMinute, currYear-1, 0);
-        if(!u) return false;
-        // Trigger check below if still outside of current year
-        if(DSTonYear != currYear) DSTonYear = currYear + 1;
-    } else if(DSTonYear < currYear) {
-        u = parseDST(v, DSTonYear, DSTonMonth, DSTonDay, DSTonHour, DSTonMinute, currYear+1, 0);
-        if(!u) return false;
-        // Trigger check below if still outside of current year
-        if(DSTonYear != currYear) DSTonYear = currYear - 1;
-    }
-    
-    t = u;
+        t = compileDST(t, tzRules[index][0]);
+        if(!t) return false;
 
-    if(*t == 0 || *t != ',') return false;          // Have start, but no end. Bad string. No DST.
-    t++;
+        if(*t == 0 || *t != ',') return false;      // Have start, but no end. Bad string. No DST.
+        t++;
 
-    // 3) parse DST end
+        if(!compileDST(t, tzRules[index][1])) return false;
 
-    v = t;
-    u = parseDST(t, DSToffYear, DSToffMonth, DSToffDay, DSToffHour, DSToffMinute, currYear, tzDiff[index]);
-    if(!u) return false;
+        for(int i = 0; i < TZ_CACHE_YEARS; i++) {
+            tzYearCache[index][i].year = -1;
+        }
 
-    // See above
-    if(DSToffYear > currYear) {
-        u = parseDST(v, DSToffYear, DSToffMonth, DSToffDay, DSToffHour, DSToffMinute, currYear-1, tzDiff[index]);
-        if(!u) return false;
-        // Trigger check below if still outside of current year
-        if(DSToffYear != currYear) DSToffYear = currYear + 1;
-    } else if(DSToffYear < currYear) {
-        u = parseDST(v, DSToffYear, DSToffMonth, DSToffDay, DSToffHour, DSToffMinute, currYear+1, tzDiff[index]);
-        if(!u) return false;
-        // Trigger check below if still outside of current year
-        if(DSToffYear != currYear) DSToffYear = currYear - 1;
+        tzHasDST[index] = 1;  // TZ has valid DST definition
     }
 
-    // 4) Evaluate results
+    tzForYear[index] = currYear;
 
-    tzHasDST[index] = 1;  // TZ has valid DST definition
+    // 3) Look up DST start and end for currYear; calculate if not cached
 
-    if((DSToffMonth == DSTonMonth) && (DSToffDay == DSTonDay)) {
-        couldDST[index] = false;
-        #ifdef TC_DBG_TIME
-        Serial.printf("parseTZ: (%d) DST not used\n", index);
-        #endif
-    } else {
-        couldDST[index] = true;
-
-        // If start or end still beyond our current year, set to impossible values
-        // to allow a valid comparison.
-        // Despite our cross-end-check for currYear above, this still can happen!
-        // Eg: "CRAZY-3:30<C3ACY>4:56,M1.1.0/-48,M12.5.0/48"
-        // For 2023, first calculated start is on 12/30/2022, so we do 2024 above, 
-        // but for 2024 start is on 1/5/2024. Nothing in 2023!
-        // Likewise 2023's first calculated end is on 1/2/2024, so we do 2022 above,
-        // but for 2022, it is on 12/27/2022. Again, outside of our current year!
-        // So with this somewhat challenging time zone definition, the entire year 
-        // 2023 is DST. Need to set -1/600000 to make comparison right.
-        if(DSTonYear < currYear)
-            DSTonMins[index] = -1;
-        else if(DSTonYear > currYear)
-            DSTonMins[index] = 600000;
-        else 
-            DSTonMins[index] = mins2Date(currYear, DSTonMonth, DSTonDay, DSTonHour, DSTonMinute);
+    tzYearData *td = &tzYearCache[index][currYear & (TZ_CACHE_YEARS - 1)];
     
-        if(DSToffYear < currYear)
-            DSToffMins[index] = -1;
-        else if(DSToffYear > currYear)
-            DSToffMins[index] = 600000;
-        else {
-            DSToffMins[index] = mins2Date(currYear, DSToffMonth, DSToffDay, DSToffHour, DSToffMinute);
-        }
-
-        #ifdef TC_DBG_TIME
-        Serial.printf("parseTZ: (%d) %d/%d(%d) DST %d-%02d-%02d/%02d:%02d - %d-%02d-%02d/%02d:%02d\n",
-                    index,
-                    tzDiffGMT[index], tzDiffGMTDST[index], tzDiff[index],
-                    DSTonYear, DSTonMonth, DSTonDay, DSTonHour, DSTonMinute,
-                    DSToffYear, DSToffMonth, DSToffDay, DSToffHour, DSToffMinute);
-        #endif
-
+    if(td->year != currYear) {
+        calcDSTYear(index, currYear, td);
+        td->year = currYear;
     }
+
+    couldDST[index] = td->couldDST;
+    DSTonMins[index] = td->onMins;
+    DSToffMins[index] = td->offMins;
         
     return true;
 }
 
 /*
- * Check if given local date/time is within DST period.
- * Given "Local" is assumed be be non-DST.
+ * Check if given UTC date/time is within DST period.
+ * DST data must be set up for the year (parseTZ).
  */
 int timeIsDST(int index, int year, int month, int day, int hour, int mins, int& currTimeMins)
 {
     currTimeMins = mins2Date(year, month, day, hour, mins);
 
-    // DSTxxMins is in non-DST local time (End corrected from DST to non-DST in parseTZ)
-    if(DSTonMins[index] < DSToffMins[index]) {
-        if((currTimeMins >= DSTonMins[index]) && (currTimeMins < DSToffMins[index]))
-            return 1;
-        else 
-            return 0;
-    } else {
-        if((currTimeMins >= DSToffMins[index]) && (currTimeMins < DSTonMins[index]))
-            return 0;
-        else
-            return 1;
+    // Like libc: If start is after end, DST is active at year start/end
+    if(DSTonMins[index] > DSToffMins[index]) {
+        return (currTimeMins < DSToffMins[index]) || (currTimeMins >= DSTonMins[index]);
     }
+    return (currTimeMins >= DSTonMins[index]) && (currTimeMins < DSToffMins[index]);
 }
 
 /*
  * Conversion from/to UTC
  */
+
+// Apply difference to "minutes since 1/1/0 0:0", wrap years 1 <-> 9999
+static uint64_t applyMinsDiff(uint64_t total64, int diff)
+{
+    int64_t mins = (int64_t)total64 - diff;
+
+    if(mins < (int64_t)daysBeforeYear(1) * (24*60)) {
+        mins += (int64_t)(daysBeforeYear(10000) - daysBeforeYear(1)) * (24*60);
+    } else if(mins >= (int64_t)daysBeforeYear(10000) * (24*60)) {
+        mins -= (int64_t)(daysBeforeYear(10000) - daysBeforeYear(1)) * (24*60);
+    }
+
+    return (uint64_t)mins;
+}
+
+// Apply difference to date/time, wrap years 1 <-> 9999
 static void convTime(int diff, int& y, int& m, int& d, int& h, int& mm)
 {
-    
-    if(diff > 0) {
-
-        mm -= diff;
-        while(mm < 0) {
-            mm += 60;
-            h--;
-        }
-        while(h < 0) {
-            h += 24;
-            d--;
-        }
-        while(d < 1) {
-            m--;
-            if(m < 1) {
-                m = 12;
-                y--;
-                if(y < 1) y = 9999;
-            }
-            d += daysInMonth(m, y);
-        }
-        
-    } else if(diff < 0) {
-
-        mm -= diff;
-        while(mm > 59) {
-            mm -= 60;
-            h++;
-        }
-        while(h > 23) {
-            h -= 24;
-            d++;
-        }
-        while(d > daysInMonth(m, y)) {
-            d -= daysInMonth(m, y);
-            m++;
-            if(m > 12) {
-                m = 1;
-                y++;
-                if(y > 9999) y = 1;
-            }
-        }
+    int dm = (h * 60) + mm - diff;
 
+    if(dm >= 0 && dm < 24*60) {
+        // Still same day, no need to go through date conversion
+        h = dm / 60;
+        mm = dm - (h * 60);
+    } else {
+        minsToDate(applyMinsDiff(dateToMins(y, m, d, h, mm), diff), y, m, d, h, mm);
     }
 }
 
@@ -6904,15 +7021,15 @@ h(uint8_t *n, uint32_t h, uint32_t m)
     return h;
 }
 
-void UTCtoLocal(DateTime &dtu, DateTime& dtl, int index)
+bool UTCtoLocal(DateTime &dtu, DateTime& dtl, int index)
 {
     int y  = dtu.year();
     int m  = dtu.month();
     int d  = dtu.day();
     int h  = dtu.hour();
     int mm = dtu.minute();
-    int y2 = y, m2 = m, d2 = d, h2 = h, mm2 = mm;
     int ctm = 0;
+    bool isDST = false;
 
     #ifdef TC_DBG_TIME
     if(dtu.second() == 30) {
@@ -6920,20 +7037,17 @@ void UTCtoLocal(DateTime &dtu, DateTime& dtl, int index)
     }
     #endif
 
-    // Convert to local (non-DST)
-    convTime(tzDiffGMT[index], y, m, d, h, mm);
-
-    // Check for DST
-    if(couldDST[index]) {
+    // Check for DST (rules are evaluated for UTC year)
+    if(tzHasDST[index] > 0) {
         if(tzForYear[index] != y) {
             parseTZ(index, y);
         }
-        if(timeIsDST(index, y, m, d, h, mm, ctm)) {
-            y = y2; m = m2; d = d2; h = h2; mm = mm2;
-            convTime(tzDiffGMTDST[index], y, m, d, h, mm);
-        }
+        isDST = couldDST[index] && timeIsDST(index, y, m, d, h, mm, ctm);
     }
 
+    // Convert to local
+    convTime(isDST ? tzDiffGMTDST[index] : tzDiffGMT[index], y, m, d, h, mm);
+
     dtl.set(y, m, d, h, mm, dtu.second());
 
     #ifdef TC_DBG_TIME
@@ -6941,6 +7055,8 @@ void UTCtoLocal(DateTime &dtu, DateTime& dtl, int index)
         Serial.printf("UTCtoLocal: (%d) Local: %d-%d-%d %d:%d\n", index, y, m, d, h, mm, dtu.second());
     }
     #endif
+
+    return isDST;
 }
 
 void LocalToUTC(int& ny, int& nm, int& nd, int& nh, int& nmm, int index)
@@ -6952,8 +7068,14 @@ void LocalToUTC(int& ny, int& nm, int& nd, int& nh, int& nmm, int index)
     Serial.printf("LocalToUTC: (%d) Local: %d-%d-%d %d:%d\n", index, ny, nm, nd, nh, nmm);
     #endif
 
-    if(couldDST[index]) {
-        if(timeIsDST(index, ny, nm, nd, nh, nmm, ctm)) {
+    // Check for DST at UTC time of given time taken as non-DST
+    if(tzHasDST[index] > 0) {
+        int y = ny, m = nm, d = nd, h = nh, mm = nmm;
+        convTime(-diff, y, m, d, h, mm);
+        if(tzForYear[index] != y) {
+            parseTZ(index, y);
+        }
+        if(couldDST[index] && timeIsDST(index, y, m, d, h, mm, ctm)) {
             diff = tzDiffGMTDST[index];
         }
     }
@@ -6963,7 +7085,163 @@ void LocalToUTC(int& ny, int& nm, int& nd, int& nh, int& nmm, int index)
     #ifdef TC_DBG_TIME
     Serial.printf("LocalToUTC: (%d) UTC:   %d-%d-%d %d:%d\n", index, ny, nm, nd, nh, nmm);
     #endif
-}    
+}
+
+#ifdef TC_DBG_TZCHECK
+/*
+ * Compare our TZ/DST handling with libc's (tzset/localtime_r)
+ * for all zones from the built-in table (looked up by name),
+ * some hand-made TZ strings, and random ones; each at every hour 
+ * of a random year plus random instants. Checks local time and
+ * DST flag. Prints mismatches and speed, returns # of mismatches.
+ * Uses TZ index 0; restores main time zone when done.
+ */
+static int tzCheckOne(const char *tz, const char *ltz, uint32_t& ourUs, uint32_t& libUs, int& convs)
+{
+    char   tzBuf[64];
+    struct tm tmu, tml;
+    DateTime dtu, dtl;
+    time_t t;
+    bool   isDST;
+    int    bad = 0;
+    int    year = 1971 + (esp_random() % 66);
+    unsigned long now;
+
+    strcpy(settings.timeZone, tz);
+    if(!resetTZ(0, year)) {
+        Serial.printf("tzCheck: '%s' rejected\n", tz);
+        return 1;
+    }
+
+    strcpy(tzBuf, ltz);
+    setenv("TZ", tzBuf, 1);
+    tzset();
+
+    // Jan 1 of year, 0:00 UTC
+    t = (time_t)(((year - 1970) * 365) + ((year - 1969) / 4)) * 86400;
+    t -= 3600;
+
+    for(int i = 0; i < (366 * 24) + 2000; i++) {
+
+        if(i >= 366 * 24) {
+            t = esp_random() & 0x7fffffff;
+        } else {
+            t += 3600;
+        }
+
+        gmtime_r(&t, &tmu);
+        dtu.set(tmu.tm_year + 1900, tmu.tm_mon + 1, tmu.tm_mday, tmu.tm_hour, tmu.tm_min, tmu.tm_sec);
+
+        now = micros();
+        isDST = UTCtoLocal(dtu, dtl, 0);
+        ourUs += micros() - now;
+
+        now = micros();
+        localtime_r(&t, &tml);
+        libUs += micros() - now;
+
+        convs++;
+
+        if(dtl.year() != tml.tm_year + 1900 || dtl.month() != tml.tm_mon + 1 || dtl.day() != tml.tm_mday ||
+           dtl.hour() != tml.tm_hour || dtl.minute() != tml.tm_min || isDST != (tml.tm_isdst > 0)) {
+            if(++bad <= 3) {
+                Serial.printf("tzCheck: '%s' UTC %d-%02d-%02d %02d:%02d: ours %d-%02d-%02d %02d:%02d%s, libc %d-%02d-%02d %02d:%02d%s\n",
+                    tz,
+                    dtu.year(), dtu.month(), dtu.day(), dtu.hour(), dtu.minute(),
+                    dtl.year(), dtl.month(), dtl.day(), dtl.hour(), dtl.minute(), isDST ? " DST" : "",
+                    tml.tm_year + 1900, tml.tm_mon + 1, tml.tm_mday, tml.tm_hour, tml.tm_min, 
+                    (tml.tm_isdst > 0) ? " DST" : "");
+            }
+        }
+    }
+
+    return bad;
+}
+
+// Random DST rule ("M10.5.0/3", "J60/-48:30", "300/167:59")
+static char *tzRandRule(char *buf)
+{
+    uint32_t r = esp_random();
+    int hr = (int)((r >> 16) % 335) - 167;
+    int mn = (int)((r >> 8) & 0xff) % 60;
+
+    switch(r % 3) {
+    case 0:
+        r = esp_random();
+        buf += sprintf(buf, "M%d.%d.%d", 1 + (r % 12), 1 + ((r >> 8) % 5), (r >> 16) % 7);
+        break;
+    case 1:
+        buf += sprintf(buf, "J%d", 1 + (esp_random() % 365));
+        break;
+    default:
+        buf += sprintf(buf, "%d", esp_random() % 366);
+    }
+
+    return buf + sprintf(buf, "/%d:%02d", hr, mn);
+}
+
+static int tzCheck()
+{
+    static const char *tzHand[] = {
+        "CRAZY-3:30<C3ACY>4:56,M1.1.0/-48,M12.5.0/48",
+        "EST5EDT,J60/2,J300/2",
+        "EST5EDT,59/2,299/2",
+        "<-03>3<-02>,M3.5.0/-2,M10.5.0/-1",
+        "<+1030>-10:30<+11>-11,M10.1.0,M4.1.0",
+        "NZST-12NZDT,M9.5.0,M4.1.0/3",
+        "XST-14",
+        "YST12",
+        "<AAA>5<BBB>,M3.2.0/-167,M11.1.0/167",
+        "<AAA>5<BBB>,J1/-167:59,J365/167:59",
+        "<AAA>-5<BBB>,0/-48:30,365/48:30",
+        "<AAA>-0:30<BBB>,M3.5.0/-0:30,M10.5.0/0:30",
+        NULL
+    };
+    char     saveTZ[sizeof(settings.timeZone)];
+    char     name[TZ_NAMEBUF_LEN];
+    char     buf[64], *p;
+    uint32_t ourUs = 0, libUs = 0;
+    int      convs = 0, bad = 0, zones = 0;
+    DateTime dtu;
+
+    strcpy(saveTZ, settings.timeZone);
+
+    // All zones from the built-in table; libc gets the POSIX string
+    for(int i = 0; i < tzdbCount(); i++, zones++) {
+        tzdbGetName(i, name);
+        bad += tzCheckOne(name, tzdbGetPosix(i), ourUs, libUs, convs);
+    }
+
+    for(int i = 0; tzHand[i]; i++, zones++) {
+        bad += tzCheckOne(tzHand[i], tzHand[i], ourUs, libUs, convs);
+    }
+
+    // Random ones (within POSIX limits: Rule times -167 to 167 hours;
+    // names need 3 characters, otherwise libc ignores DST)
+    for(int i = 0; i < 500; i++, zones++) {
+        uint32_t r = esp_random();
+        p = buf + sprintf(buf, "<A%03d>%s%d:%02d<BBB>,", i, (r & 0x10000) ? "-" : "", (int)(r % 13), ((r >> 8) % 4) * 15);
+        p = tzRandRule(p);
+        *p++ = ',';
+        tzRandRule(p);
+        bad += tzCheckOne(buf, buf, ourUs, libUs, convs);
+    }
+
+    Serial.printf("tzCheck: %d zones, %d conversions, %d mismatches\n", zones, convs, bad);
+    Serial.printf("tzCheck: UTCtoLocal %d conv/s, localtime_r %d conv/s\n",
+        (int)((uint64_t)convs * 1000000 / (ourUs ? ourUs : 1)),
+        (int)((uint64_t)convs * 1000000 / (libUs ? libUs : 1)));
+
+    unsetenv("TZ");
+    tzset();
+
+    strcpy(settings.timeZone, saveTZ);
+    myrtcnow(dtu);
+    resetTZ(0, dtu.year());
+
+    return bad;
+}
+#endif
 
 /**************************************************************
  ***                                                        ***
@@ -7094,8 +7372,6 @@ static bool NTPHaveCurrentTime()
 // Get UTC time from NTP response
 static bool NTPGetUTC(int& year, int& month, int& day, int& hour, int& minute, int& second)
 {
-    uint32_t temp, c;
-
     // Fail if no time received (or stamp is timed out)
     if(!NTPHaveCurrentTime()) return false;
     
@@ -7107,30 +7383,7 @@ static bool NTPGetUTC(int& year, int& month, int& day, int& hour, int& minute, i
     uint32_t total32 = secsSinceTCepoch / 60;
 
     // Calculate current date
-    year = c = TCEPOCH;
-    while(1) {
-        temp = isLeapYear(c++) ? ((8760+24)*60) : (8760*60);
-        if(total32 < temp) break;
-        year++;
-        total32 -= temp;
-    }
-
-    c = 1;
-    temp = isLeapYear(year) ? 1 : 0;
-    while(c < 12) {
-        if(total32 < (mon_ydayt24t60[temp][c])) break;
-        c++;
-    }
-    month = c;
-    total32 -= (mon_ydayt24t60[temp][c-1]);
-
-    day = total32 / (24*60);
-    total32 -= (day * (24*60));
-    day++;
-
-    hour = total32 / 60;
-
-    minute = total32 - (hour * 60);
+    minsToDate(((uint64_t)daysBeforeYear(TCEPOCH) * (24*60)) + total32, year, month, day, hour, minute);
 
     return true;
 }
@@ -7506,53 +7759,195 @@ static void bttfn_evalremotecommand(uint32_t seq, uint8_t cmd, uint8_t p1, uint8
 }
 #endif
 
-int bttfnNumClients()
+/*
+ * BTTFN client registry
+ */
+
+static int bttfn_hashSlot(uint32_t ip)
 {
-    int i;
+    return (ip * 2654435761U) >> (32 - BTTFN_HASH_BITS);
+}
+
+static _bttfnClient *bttfn_findClient(uint32_t ip)
+{
+    for(int h = bttfn_hashSlot(ip); bttfnHash[h]; h = (h + 1) & (BTTFN_HASH_SIZE - 1)) {
+        if(bttfnClient[bttfnHash[h] - 1].IP32 == ip)
+            return &bttfnClient[bttfnHash[h] - 1];
+    }
+    return NULL;
+}
+
+// Check if client's clock offset is usable. An offset not
+// refreshed for BTTFN_SYNC_MAXMISS sync intervals is dropped;
+// the client then needs BTTFN_SYNC_MINCNT new exchanges.
+static bool bttfn_syncValid(_bttfnClient *c)
+{
+    if(c->SyncCnt && millis() - c->SyncLast > BTTFN_SYNC_MAXMISS * c->SyncIntv) {
+        c->SyncCnt = 0;
+    }
+    return (c->SyncCnt >= BTTFN_SYNC_MINCNT);
+}
+
+static void bttfn_hashRemove(uint32_t ip)
+{
+    int h = bttfn_hashSlot(ip), j, k;
+
+    while(bttfnClient[bttfnHash[h] - 1].IP32 != ip) {
+        h = (h + 1) & (BTTFN_HASH_SIZE - 1);
+    }
+
+    // Backward shift deletion: Move up entries that
+    // would otherwise become unreachable
+    for(j = h; ; ) {
+        bttfnHash[j] = 0;
+        for(;;) {
+            h = (h + 1) & (BTTFN_HASH_SIZE - 1);
+            if(!bttfnHash[h]) return;
+            k = bttfn_hashSlot(bttfnClient[bttfnHash[h] - 1].IP32);
+            // Move entry unless its home k is cyclically in (j, h]
+            if((j < h) ? (j >= k || k > h) : (j >= k && k > h)) break;
+        }
+        bttfnHash[j] = bttfnHash[h];
+        j = h;
+    }
+}
+
+static void bttfn_lruUnlink(int i)
+{
+    _bttfnClient *c = &bttfnClient[i];
     
-    for(i = 0; i < BTTFN_MAX_CLIENTS; i++) {
-        if(!bttfnClient[i].IP32)
-            break;
+    if(c->prev != BTTFN_NIL) bttfnClient[c->prev].next = c->next;
+    else                     bttfnLRUHead = c->next;
+    if(c->next != BTTFN_NIL) bttfnClient[c->next].prev = c->prev;
+    else                     bttfnLRUTail = c->prev;
+}
+
+static void bttfn_lruAppend(int i)
+{
+    _bttfnClient *c = &bttfnClient[i];
+    
+    c->next = BTTFN_NIL;
+    c->prev = bttfnLRUTail;
+    if(bttfnLRUTail != BTTFN_NIL) bttfnClient[bttfnLRUTail].next = i;
+    else                          bttfnLRUHead = i;
+    bttfnLRUTail = i;
+}
+
+static void bttfn_countCaps(uint8_t flags, int d)
+{
+    if(flags & 0x01) bttfnCapCnt[0] += d;
+    if(flags & 0x02) bttfnCapCnt[1] += d;
+    else             bttfnCapCnt[3] += d;
+    if(flags & 0x04) bttfnCapCnt[2] += d;
+    if((flags & 0x09) == 0x01) bttfnCapCnt[4] += d;
+
+    bttfnAtLeastOneND    = bttfnCapCnt[0] ? 1 : 0;
+    bttfnAtLeastOneMC    = bttfnCapCnt[1] ? 2 : 0;
+    bttfnNotAllSupportMC = bttfnCapCnt[3] ? 1 : 0;
+    bttfnNDLegacy        = bttfnCapCnt[4] ? 1 : 0;
+    // Any client requesting packed dest/dep dates?
+    bttfnDataParm        = bttfnCapCnt[2] ? 0x80 : 0;
+}
+
+static void bttfn_removeClient(int i)
+{
+    _bttfnClient *c = &bttfnClient[i];
+    int j;
+
+    bttfn_hashRemove(c->IP32);
+    bttfn_lruUnlink(i);
+    bttfn_countCaps(c->Flags, -1);
+    c->IP32 = 0;
+
+    for(j = 0; bttfnOrder[j] != i; j++) { }
+    memmove(&bttfnOrder[j], &bttfnOrder[j + 1], bttfnNumCli - j - 1);
+    
+    bttfnFree[BTTFN_MAX_CLIENTS - bttfnNumCli] = i;
+    bttfnNumCli--;
+}
+
+static void bttfn_initClients()
+{
+    memset(bttfnClient, 0, sizeof(bttfnClient));
+    memset(bttfnHash, 0, sizeof(bttfnHash));
+    memset(bttfnCapCnt, 0, sizeof(bttfnCapCnt));
+    for(int i = 0; i < BTTFN_MAX_CLIENTS; i++) {
+        bttfnFree[i] = BTTFN_MAX_CLIENTS - 1 - i;
     }
-    return i;
+    bttfnNumCli = 0;
+    bttfnLRUHead = bttfnLRUTail = BTTFN_NIL;
+    bttfn_countCaps(0, 0);
+}
+
+int bttfnNumClients()
+{
+    return bttfnNumCli;
 }
 
 bool bttfnGetClientInfo(int c, char **id, uint8_t **ip, uint8_t *type)
 {
-    if(c > BTTFN_MAX_CLIENTS - 1)
-        return false;
-        
-    if(!bttfnClient[c].IP32)
+    _bttfnClient *cl;
+    
+    if(c < 0 || c >= bttfnNumCli)
         return false;
+
+    cl = &bttfnClient[bttfnOrder[c]];
         
-    *id = bttfnClient[c].ID;
-    *ip = bttfnClient[c].IP;
+    *id = cl->ID;
+    *ip = cl->IP;
 
-    *type = bttfnClient[c].Type;
+    *type = cl->Type;
 
     return true;
 }
 
+bool bttfnGetClientSync(int c, int32_t *offset, uint16_t *rtt)
+{
+    _bttfnClient *cl;
+    
+    if(c < 0 || c >= bttfnNumCli)
+        return false;
+
+    cl = &bttfnClient[bttfnOrder[c]];
+
+    *offset = cl->Offset;
+    *rtt = cl->RTT;
+
+    return bttfn_syncValid(cl);
+}
+
 static uint32_t storeBTTFNClient(uint32_t ip, uint8_t *buf, uint8_t type, uint8_t flags)
 {
     _bttfnClient *newClient;
-    int i;
+    int i, h;
 
-    // Check if already in list, search for free slot
-    for(i = 0; i < BTTFN_MAX_CLIENTS; i++) {
-        newClient = &bttfnClient[i];
-        if(ip == newClient->IP32)
-            goto stcl_ipIdentical;
-        else if(!newClient->IP32)
-            goto stcl_copyIP;
+    // Check if already in list
+    if((newClient = bttfn_findClient(ip))) {
+        i = newClient - bttfnClient;
+        bttfn_lruUnlink(i);
+        bttfn_countCaps(newClient->Flags, -1);
+        goto stcl_ipIdentical;
     }
 
-    // Bail if no slot available
-    return 0;
-
-stcl_copyIP:
+    // No free slot: Reuse least recently seen if expired
+    if(bttfnNumCli >= BTTFN_MAX_CLIENTS) {
+        if(millis() - bttfnClient[bttfnLRUHead].ALIVE <= 5*60*1000) {
+            // Bail if no slot available
+            return 0;
+        }
+        bttfn_expire_client(bttfnLRUHead);
+    }
 
+    i = bttfnFree[BTTFN_MAX_CLIENTS - 1 - bttfnNumCli];
+    newClient = &bttfnClient[i];
     newClient->IP32 = ip;
+    newClient->SyncT3 = 0;
+    newClient->SyncCnt = 0;
+    newClient->SyncIntv = BTTFN_SYNC_MININTV;
+    bttfnOrder[bttfnNumCli++] = i;
+
+    for(h = bttfn_hashSlot(ip); bttfnHash[h]; h = (h + 1) & (BTTFN_HASH_SIZE - 1)) { }
+    bttfnHash[h] = i + 1;
 
 stcl_ipIdentical:
 
@@ -7565,12 +7960,8 @@ stcl_ipIdentical:
     newClient->ALIVE = millis();
     newClient->Flags = flags;
 
-    if(flags & 0x02) {
-        bttfnAtLeastOneMC = 2;
-        bttfnAtLeastOneND |= (flags & 0x01);
-    } else {
-        bttfnNotAllSupportMC = 1;
-    }
+    bttfn_lruAppend(i);
+    bttfn_countCaps(flags, 1);
     
     #ifdef TC_HAVE_REMOTE
     #ifdef ESP32
@@ -7588,77 +7979,50 @@ stcl_ipIdentical:
     #endif
 }
 
+static void bttfn_expire_client(int i)
+{
+    #ifdef TC_HAVE_REMOTE
+    _bttfnClient *c = &bttfnClient[i];
+    
+    #ifdef TC_DBG_NET
+    Serial.printf("Expiring device type %d\n", c->Type);
+    #endif
+    if(c->Type == BTTFN_TYPE_REMOTE) {
+        #ifdef TC_DBG_NET
+        Serial.printf("Expiring remote id: %u %u\n", c->RemID, registeredRemID);
+        #endif
+        if(c->RemID == registeredRemID) {
+            removeRemote();
+        }
+    } else if(registeredRemKPID && (c->RemID == registeredRemKPID)) {
+        #ifdef TC_DBG_NET
+        Serial.printf("Expiring remote KP id: %u %u\n", c->RemID, registeredRemKPID);
+        #endif
+        removeKPRemote();
+    }
+    #endif  // TC_HAVE_REMOTE
+
+    bttfn_removeClient(i);
+}
+
 static void bttfn_expire_clients()
 {
-    int k, numClients = 0, didST = 0;
     unsigned long now = millis();
 
     if(now - bttfnlastExpire < 57*1000)
         return;
         
     bttfnlastExpire = now;
-    
-    for(int i = 0; i < BTTFN_MAX_CLIENTS; i++) {
-        if(bttfnClient[i].IP32) {
-            numClients++;
-            if(now - bttfnClient[i].ALIVE > 5*60*1000) {
-                bttfnClient[i].IP32 = 0;
-                #ifdef TC_HAVE_REMOTE
-                #ifdef TC_DBG_NET
-                Serial.printf("Expiring device type %d\n", bttfnClient[i].Type);
-                #endif
-                if(bttfnClient[i].Type == BTTFN_TYPE_REMOTE) {
-                    #ifdef TC_DBG_NET
-                    Serial.printf("Expiring remote id: %u %u\n", bttfnClient[i].RemID, registeredRemID);
-                    #endif
-                    if(bttfnClient[i].RemID == registeredRemID) {
-                        removeRemote();
-                    }
-                } else if(registeredRemKPID && (bttfnClient[i].RemID == registeredRemKPID)) {
-                    #ifdef TC_DBG_NET
-                    Serial.printf("Expiring remote KP id: %u %u\n", bttfnClient[i].RemID, registeredRemKPID);
-                    #endif
-                    removeKPRemote();
-                }
-                #endif  // TC_HAVE_REMOTE
-                numClients--;
-                didST++;
-            }
-        }
-    }
-
-    bttfnHaveClients = numClients;
 
-    if(!didST)
+    if(!bttfnNumCli)
         return;
 
-    for(int j = 0; j < BTTFN_MAX_CLIENTS - 1; j++) {
-        if(!bttfnClient[j].IP32) {
-            for(k = j + 1; k < BTTFN_MAX_CLIENTS; k++) {
-                if(bttfnClient[k].IP32) {
-                    memcpy(&bttfnClient[j], &bttfnClient[k], (BTTFN_MAX_CLIENTS - k) * sizeof(_bttfnClient));
-                    for(int l = BTTFN_MAX_CLIENTS - (k - j); l < BTTFN_MAX_CLIENTS; l++) bttfnClient[l].IP32 = 0;
-                    break;
-                }
-            }
-            if(k == BTTFN_MAX_CLIENTS) break;
-        }
+    // LRU list is ordered by ALIVE: Oldest first
+    while(bttfnLRUHead != BTTFN_NIL && now - bttfnClient[bttfnLRUHead].ALIVE > 5*60*1000) {
+        bttfn_expire_client(bttfnLRUHead);
     }
 
-    k = bttfnNotAllSupportMC = bttfnDataParm = 0;
-    for(int i = 0; i < BTTFN_MAX_CLIENTS; i++) {
-        if(bttfnClient[i].IP32) {
-            k |= bttfnClient[i].Flags;
-            if(!(bttfnClient[i].Flags & 0x02)) {       
-                bttfnNotAllSupportMC = 1;
-            }
-        } else
-            break;
-    }
-    bttfnAtLeastOneMC = k & 0x02;
-    bttfnAtLeastOneND = k & 0x01;
-    // See if any of the remaining clients requests packed dest/dep dates
-    if(k & 0x04) bttfnDataParm = 0x80;
+    bttfnHaveClients = bttfnNumCli;
     
     if(!bttfnHaveClients) wifiRestartPSTimer();
 }
@@ -7773,16 +8137,15 @@ static void bttfn_fill_response(uint8_t *buf, int skipClear, uint8_t parm)
         buf[5] &= ~0x20;
         parm &= 0x0f;
         if(parm) {
-            for(int i = 0; i < BTTFN_MAX_CLIENTS; i++) {
-                if(bttfnClient[i].IP32) {
-                    if(parm == bttfnClient[i].Type) {
-                        for(int j = 0; j < 4; j++) {
-                            buf[27+j] = bttfnClient[i].IP[j];
-                        }
-                        buf[5] |= 0x20;
-                        break;
+            for(int i = 0; i < bttfnNumCli; i++) {
+                _bttfnClient *c = &bttfnClient[bttfnOrder[i]];
+                if(parm == c->Type) {
+                    for(int j = 0; j < 4; j++) {
+                        buf[27+j] = c->IP[j];
                     }
-                } else break;
+                    buf[5] |= 0x20;
+                    break;
+                }
             }
         }
     }
@@ -7795,12 +8158,60 @@ static void bttfn_fill_response(uint8_t *buf, int skipClear, uint8_t parm)
     // 4:Support NOT_DATA
     // 5:Support REMCMD_DOOR
     // 6:Sends SSID-appendix & password marker in NOT_DATA
-    // 7 for future use.
-    buf[31] = 0x01 | 0x04 | 0x08 | 0x10 | 0x20 | 0x40;
+    // 7:Clock sync, scheduled events, change-driven NOT_DATA
+    buf[31] = 0x01 | 0x04 | 0x08 | 0x10 | 0x20 | 0x40 | 0x80;
     
     // buf[5]&0x80 taken (TT)
 }
 
+/*
+ * Clock sync: Client sends its time as serial (T1), plus its time 
+ * of receiving our previous reply (T4') and that reply's serial.
+ * With our time of sending that reply (T3') and receiving this
+ * request (T2):
+ * 
+ *   offset = ((T4' - T3') - (T2 - T1)) / 2
+ *   RTT    =  (T4' - T3') + (T2 - T1)
+ *
+ * The client's clock is unrelated to ours, so the offset can be
+ * anything; it is calculated as (T4' - T3') - RTT / 2, modulo 2^32.
+ *
+ * The offset from the fastest recent exchange is kept; the RTT 
+ * to beat grows by 1ms per exchange to follow clock drift.
+ */
+static void bttfn_syncSample(_bttfnClient *c, uint8_t *buf, unsigned long now)
+{
+    uint32_t t1 = GET32(buf, 6);
+
+    if(c->SyncT3 && (uint32_t)GET32(buf, 43) == c->SyncSerial) {
+        uint32_t d1 = GET32(buf, 39) - c->SyncT3;
+        uint32_t d2 = now - t1;
+        int32_t rtt = d1 + d2;
+        if(rtt >= 0 && rtt < BTTFN_SYNC_MAXRTT) {
+            bttfn_syncValid(c);
+            if(c->SyncCnt) {
+                c->SyncIntv = now - c->SyncLast;
+                if(c->SyncIntv < BTTFN_SYNC_MININTV) c->SyncIntv = BTTFN_SYNC_MININTV;
+            }
+            c->SyncLast = now;
+            if(!c->SyncCnt || rtt <= c->RTT + c->SyncAge) {
+                c->Offset = d1 - rtt / 2;
+                c->RTT = rtt;
+                c->SyncAge = 0;
+            } else if(c->SyncAge < 255) {
+                c->SyncAge++;
+            }
+            if(c->SyncCnt < 255) c->SyncCnt++;
+            #ifdef TC_DBG_NET
+            Serial.printf("Clock sync %s: offset %d rtt %d (best %d)\n", c->ID, (int32_t)(d1 - rtt / 2), rtt, c->RTT);
+            #endif
+        }
+    }
+
+    c->SyncSerial = t1;
+    c->SyncT3 = now ? now : 1;
+}
+
 static bool bttfn_handlePacket(uint8_t *buf, bool isMC)
 {
     uint32_t tip32 = 0;
@@ -7851,7 +8262,10 @@ static bool bttfn_handlePacket(uint8_t *buf, bool isMC)
     
     // Retrieve (optional) request parameter
     // 0-3: Device type for IP lookup
-    // 4-6: For future use
+    // 4:   Clock sync data included (6-9: client time, 39-42: client time
+    //      of receiving last reply, 43-46: serial of last reply)
+    // 5:   Client handles change-driven NOT_DATA
+    // 6:   For future use
     // 7:   Request displayed destination and departed times with date/time request
     parm = buf[24];
 
@@ -7861,6 +8275,9 @@ static bool bttfn_handlePacket(uint8_t *buf, bool isMC)
         bttfnDataParm = 0x80;
         cFlags |= 0x04;
     }
+    if(parm & 0x20) {
+        cFlags |= 0x08;
+    }
 
     receivedRemID = storeBTTFNClient(tip32, buf, ctype, cFlags);
 
@@ -7911,6 +8328,12 @@ static bool bttfn_handlePacket(uint8_t *buf, bool isMC)
         // Add response marker to version byte
         buf[4] |= 0x80;
 
+        // Clock sync; reply is sent right away
+        if(parm & 0x10) {
+            _bttfnClient *c = bttfn_findClient(tip32);
+            if(c) bttfn_syncSample(c, buf, millis());
+        }
+
         // Eval query and build reply into buf
         bttfn_fill_response(buf, 0, parm);
         
@@ -7925,7 +8348,9 @@ static bool bttfn_handlePacket(uint8_t *buf, bool isMC)
 }
 
 // Send event notification
-static void bttfn_notify(uint8_t targetType, uint8_t event, uint16_t payload, uint16_t payload2, uint16_t payload3)
+// If execAt is given (our time), clients with clock sync get the 
+// event's execution time in their time at 12-15 (16 bit 0 set).
+static void bttfn_notify(uint8_t targetType, uint8_t event, uint16_t payload, uint16_t payload2, uint16_t payload3, unsigned long execAt)
 {
     // No clients?
     if(!bttfnHaveClients)
@@ -7951,6 +8376,14 @@ static void bttfn_notify(uint8_t targetType, uint8_t event, uint16_t payload, ui
         if(!bttfnSeqCnt) bttfnSeqCnt = 1;
     } else if(targetType || bttfnNotAllSupportMC) {
         sendMC = false;
+    } else if(execAt) {
+        // Need unicast if any client can take a scheduled event
+        for(int i = 0; i < bttfnNumCli; i++) {
+            if(bttfn_syncValid(&bttfnClient[bttfnOrder[i]])) {
+                sendMC = false;
+                break;
+            }
+        }
     }
     
     // Checksum
@@ -7961,11 +8394,20 @@ static void bttfn_notify(uint8_t targetType, uint8_t event, uint16_t payload, ui
         tcdUDP->write(BTTFUDPBuf, BTTF_PACKET_SIZE);
         tcdUDP->endPacket();
     } else {
-        for(int i = 0; i < BTTFN_MAX_CLIENTS; i++) {
-            if(!bttfnClient[i].IP32)
-                break;
-            if(!targetType || targetType == bttfnClient[i].Type) {
-                tcdUDP->beginPacket(IPAddress(bttfnClient[i].IP32), BTTF_DEFAULT_LOCAL_PORT);
+        for(int i = 0; i < bttfnNumCli; i++) {
+            _bttfnClient *c = &bttfnClient[bttfnOrder[i]];
+            if(!targetType || targetType == c->Type) {
+                if(execAt) {
+                    if(bttfn_syncValid(c)) {
+                        SET32(BTTFUDPBuf, 12, execAt + c->Offset);
+                        BTTFUDPBuf[16] = 0x01;
+                    } else {
+                        SET32(BTTFUDPBuf, 12, 0);
+                        BTTFUDPBuf[16] = 0;
+                    }
+                    BTTFUDPBuf[BTTF_PACKET_SIZE - 1] = bttfn_checksum(BTTFUDPBuf);
+                }
+                tcdUDP->beginPacket(IPAddress(c->IP32), BTTF_DEFAULT_LOCAL_PORT);
                 tcdUDP->write(BTTFUDPBuf, BTTF_PACKET_SIZE);
                 tcdUDP->endPacket();
             }
@@ -8042,23 +8484,51 @@ void bttfn_notify_info()
     #endif
 }
 
+// Compare NOT_DATA contents, return changed-fields mask
+static uint8_t bttfn_dataChanges(const uint8_t *n, const uint8_t *o)
+{
+    uint8_t chg = 0;
+    int32_t a, b;
+
+    // Date/time with minute resolution
+    if(memcmp(n + 10, o + 10, 6))         chg |= BTTFN_NDC_TIME;
+    if(memcmp(n + 32, o + 32, 9))         chg |= BTTFN_NDC_DDT;
+
+    // Temperature: Threshold, or (un)availability
+    a = (int16_t)(n[20] | (n[21] << 8));
+    b = (int16_t)(o[20] | (o[21] << 8));
+    if(a != b && (a == -32768 || b == -32768 || abs(a - b) >= BTTFN_ND_TEMPDIFF))
+                                          chg |= BTTFN_NDC_SENS;
+    // Lux: 10% (at least 2), or (un)availability
+    a = (int32_t)GET32(n, 22);
+    b = (int32_t)GET32(o, 22);
+    if(a != b && (a < 0 || b < 0 || abs(a - b) >= ((b >= 20) ? b / 10 : 2)))
+                                          chg |= BTTFN_NDC_SENS;
+
+    if(n[5] != o[5] || (n[17] & 0x87) != (o[17] & 0x87) || n[26] != o[26] ||
+       n[18] != o[18] || n[19] != o[19])  chg |= BTTFN_NDC_STAT;
+
+    return chg;
+}
+
+/*
+ * NOT_DATA is sent as soon as something relevant changes, 
+ * otherwise as a keep-alive. If all NOT_DATA clients support
+ * it, changed fields are flagged and the keep-alive is slow.
+ */
 static void bttfn_notify_data()
 {
+    uint8_t chg;
+    
     if(!bttfnAtLeastOneND)
         return;
 
     unsigned long now = millisNonZero();
     
-    if(now - bttfnLastDataNot < 1000)
+    if(now - bttfnLastDataCheck < BTTFN_ND_CHECK)
         return;
 
-    bttfnLastDataNot = now;
-
-    // If last INFO was sent recently, skip
-    if(bttfnLastInfo && (now - bttfnLastInfo < 500))
-        return;
-
-    bttfnLastInfo = 0;
+    bttfnLastDataCheck = now;
 
     // Skip during time-critical phase of P0 and P2
     if((csf & (CSF_P0|CSF_P2)) && timeTravelP0Speed < 30)
@@ -8066,15 +8536,47 @@ static void bttfn_notify_data()
 
     bttfn_fill_response(BTTFDataBuf, 7, bttfnDataParm);
     
+    // Write remaining byte of sysid and pw marker
+    BTTFDataBuf[18] = bttfnData18;
+    BTTFDataBuf[19] = bttfnData19;
+
+    if(!bttfnLastDataNot) {
+        chg = BTTFN_NDC_TIME|BTTFN_NDC_DDT|BTTFN_NDC_SENS|BTTFN_NDC_STAT;
+    } else if(!(chg = bttfn_dataChanges(BTTFDataBuf, bttfnLastData))) {
+        bttfnLastDataClean = now;
+        if(now - bttfnLastDataNot < (bttfnNDLegacy ? 1000 : BTTFN_ND_KEEPALIVE))
+            return;
+        // If last INFO was sent recently, skip
+        if(bttfnLastInfo && (now - bttfnLastInfo < 500))
+            return;
+    }
+
+    bttfnLastInfo = 0;
+    
+    memcpy(bttfnLastData, BTTFDataBuf, BTTF_PACKET_SIZE);
+    bttfnLastDataNot = now;
+
+    if(!bttfnNDStart) bttfnNDStart = now;
+    bttfnStats.ndPackets++;
+    if(chg && bttfnLastDataClean) {
+        // Change happened since last check without change
+        uint32_t lat = now - bttfnLastDataClean;
+        bttfnStats.ndChanged++;
+        bttfnNDLatSum += lat;
+        if(lat > bttfnStats.ndLatMax) bttfnStats.ndLatMax = lat;
+    }
+    bttfnLastDataClean = now;
+
+    if(!bttfnNDLegacy) {
+        BTTFDataBuf[40] |= BTTFN_NDC_VALID;
+        BTTFDataBuf[17] |= chg;
+    }
+    
     SET32(BTTFDataBuf, 6, bttfnDataSeqCnt);
     bttfnDataSeqCnt++;
     if(!bttfnDataSeqCnt) bttfnDataSeqCnt++;
 
     SET32(BTTFDataBuf, 27, bttfnSessionID);
-
-    // Write remaining byte of sysid and pw marker
-    BTTFDataBuf[18] = bttfnData18;
-    BTTFDataBuf[19] = bttfnData19;
     
     // Calc checksum
     BTTFDataBuf[BTTF_PACKET_SIZE - 1] = bttfn_checksum(BTTFDataBuf);
@@ -8085,7 +8587,7 @@ static void bttfn_notify_data()
     tcdUDP->endPacket();
 
     #ifdef TC_DBG_NET
-    Serial.println("Sent NOT_DATA");
+    Serial.printf("Sent NOT_DATA (changed 0x%02x)\n", chg);
     #endif
 
     return;
@@ -8124,7 +8626,7 @@ static void bttfn_setup()
     unsigned char *s = (unsigned char *)settings.hostName;
     for(t = h; *s; ++s) hostNameHash = 37 * hostNameHash + tolower(*s);
 
-    memset(bttfnClient, 0, sizeof(bttfnClient));
+    bttfn_initClients();
 
     // For testing
     r  = bttfn_unrollPacket;
@@ -8164,41 +8666,101 @@ static void bttfn_setup_sensors()
     #endif
 }
 
+// Check packet and time budget for draining the sockets.
+// Returns BNBL_OK, or which limit was reached.
+#define BNBL_OK   0
+#define BNBL_PKTS 1
+#define BNBL_TIME 2
+static int bttfn_budgetLeft(uint32_t numPkts, unsigned long startUs)
+{
+    if(numPkts >= BTTFN_LOOP_MAXPKTS)
+        return BNBL_PKTS;
+    if(micros() - startUs >= BTTFN_LOOP_MAXUS)
+        return BNBL_TIME;
+    return BNBL_OK;
+}
+
+// A packet arrived after the budget was used up: Count which
+// limit ended the call. (An empty queue ends it on its own.)
+static bool bttfn_budgetOut(int limit)
+{
+    if(limit == BNBL_PKTS) bttfnStats.pktLimit++;
+    else                   bttfnStats.timeLimit++;
+
+    return false;
+}
+
 bool bttfn_loop(uint32_t taskMask)
 {
-    bool resmc = false;
+    unsigned long startUs = micros(), took;
+    uint32_t numPkts = 0;
+    int limit = BNBL_OK;
+    bool budget = true;
+
+    // Handle all queued discover packets, then all queued
+    // requests, as long as the budget lasts. The budget only
+    // counts as exhausted if there is another packet.
 
     if(!(taskMask & BNLP_SK_MC)) {
-        resmc = bttfn_checkmc();
+        while(bttfn_checkmc()) {
+            numPkts++;
+            bttfnStats.mcPackets++;
+            if(limit) {
+                budget = bttfn_budgetOut(limit);
+                break;
+            }
+            limit = bttfn_budgetLeft(numPkts, startUs);
+        }
     }
 
-    int psize = 0;
+    if(budget && !(taskMask & BNLP_SK_SP)) {
+        while(tcdUDP->parsePacket()) {
+    
+            tcdUDP->read(BTTFUDPBuf, BTTF_PACKET_SIZE);
+        
+            if(bttfn_handlePacket(BTTFUDPBuf, false)) {
+                tcdUDP->beginPacket(tcdUDP->remoteIP(), BTTF_DEFAULT_LOCAL_PORT);
+                tcdUDP->write(BTTFUDPBuf, BTTF_PACKET_SIZE);
+                tcdUDP->endPacket();
+            }
 
-    if(!(taskMask & BNLP_SK_SP)) {
-        psize = tcdUDP->parsePacket();
+            numPkts++;
+            if(limit) {
+                budget = bttfn_budgetOut(limit);
+                break;
+            }
+            limit = bttfn_budgetLeft(numPkts, startUs);
+        }
     }
 
-    if(!psize) {
+    bttfnStats.calls++;
+    if(numPkts) {
+        bttfnStats.packets += numPkts;
+        if(numPkts > bttfnStats.maxPerCall) bttfnStats.maxPerCall = numPkts;
+        if((took = micros() - startUs) > bttfnStats.maxUs) bttfnStats.maxUs = took;
+    }
+
+    // Queues empty: Do the housekeeping. If the budget ran 
+    // out, the next call continues with the remaining packets.
+    if(budget) {
         if(!(taskMask & BNLP_SK_NOTDATA)) {
             bttfn_notify_data();
         }
         if(!(taskMask & BNLP_SK_EXPIRE)) {
             bttfn_expire_clients();
         }
-        return false | resmc;
     }
-    
-    tcdUDP->read(BTTFUDPBuf, BTTF_PACKET_SIZE);
 
-    if(bttfn_handlePacket(BTTFUDPBuf, false)) {
-        tcdUDP->beginPacket(tcdUDP->remoteIP(), BTTF_DEFAULT_LOCAL_PORT);
-        tcdUDP->write(BTTFUDPBuf, BTTF_PACKET_SIZE);
-        tcdUDP->endPacket();
-    } else if(!psize) {
-        (*r)(BTTFUDPBuf, 0, BTTF_PACKET_SIZE);
-    }
+    return (numPkts > 0);
+}
 
-    return true;
+void bttfnGetStats(BTTFN_Stats *st)
+{
+    unsigned long elapsed = bttfnNDStart ? millis() - bttfnNDStart : 0;
+    
+    *st = bttfnStats;
+    st->ndPerHour = elapsed ? (uint32_t)((uint64_t)st->ndPackets * 3600000 / elapsed) : 0;
+    st->ndLatAvg = st->ndChanged ? bttfnNDLatSum / st->ndChanged : 0;
 }
 
 bool bttfn_loop_ex()
@@ -156,6 +156,9 @@ void      allShowPattern();
 void      allOff();
 void      allOn();
 void      allresetBrightness();
+void      allHoldFrame();
+int       allFlushFrame();
+void      allAnimLoop();
 void      loadUserDLTimes();
 
 #ifdef TC_HAVEGPS
@@ -185,9 +188,15 @@ void      correctNonExistingDate(int year, int month, int& day);
 uint8_t*  e(uint8_t *, uint32_t, int);
 void      correctYr4RTC(uint16_t& year, int16_t& offs);
 int       mins2Date(int year, int month, int day, int hour, int mins);
+int       tzdbFind(const char *name);
+int       tzdbCount();
+bool      tzdbGetName(int idx, char *buf);
+const char *tzdbGetPosix(int idx);
+bool      tzdbSelect(int idx);
+bool      resetTZ(int index, int currYear);
 bool      parseTZ(int index, int currYear, bool doparseDST = true);
 int       timeIsDST(int index, int year, int month, int day, int hour, int mins, int& currTimeMins);
-void      UTCtoLocal(DateTime &dtu, DateTime& dtl, int index);
+bool      UTCtoLocal(DateTime &dtu, DateTime& dtl, int index);
 void      LocalToUTC(int& ny, int& nm, int& nd, int& nh, int& nmm, int index);
 
 void      ntp_setup(bool doUseNTP, IPAddress& ntpServer, bool couldHaveNTP, bool ntpLUF);
@@ -197,8 +206,25 @@ int       ntp_status();
 
 int       bttfnNumClients();
 bool      bttfnGetClientInfo(int c, char **id, uint8_t **ip, uint8_t *type);
+bool      bttfnGetClientSync(int c, int32_t *offset, uint16_t *rtt);
 bool      bttfn_loop(uint32_t taskMask = 0);
 bool      bttfn_loop_ex();
+
+typedef struct {
+    uint32_t calls;         // bttfn_loop() calls
+    uint32_t packets;       // Packets handled (all)
+    uint32_t mcPackets;     // Packets handled (multicast)
+    uint32_t maxPerCall;    // Most packets found queued in one call
+    uint32_t pktLimit;      // Calls ending at packet budget
+    uint32_t timeLimit;     // Calls ending at time budget
+    uint32_t maxUs;         // Longest call handling packets (us)
+    uint32_t ndPackets;     // NOT_DATA sent
+    uint32_t ndChanged;     // thereof because of changes
+    uint32_t ndPerHour;     // NOT_DATA per hour
+    uint32_t ndLatAvg;      // Change to NOT_DATA, upper bound (ms)
+    uint32_t ndLatMax;
+} BTTFN_Stats;
+void      bttfnGetStats(BTTFN_Stats *st);
 void      bttfn_notify_info();
 
 #ifdef TC_HAVE_REMOTE
@@ -223,6 +249,8 @@ void      removeKPRemote();
 
 #define REM_BRAKE 1900
 
+#define TZ_NAMEBUF_LEN 32   // Zone name from built-in table incl. 0-term
+
 extern bool showUpdAvail;
 
 extern uint16_t lastYear;
@@ -0,0 +1,273 @@
+/*
+ * -------------------------------------------------------------------
+ * CircuitSetup.us Time Circuits Display
+ * (C) 2022-2026 Thomas Winischhofer (A10001986)
+ * https://github.com/realA10001986/Time-Circuits-Display
+ * https://tcd.out-a-ti.me
+ *
+ * Time zone table
+ *
+ * Generated by tools/mktzdb.py from timezones.csv - do not edit.
+ *
+ * -------------------------------------------------------------------
+ * License: Modified MIT NON-AI
+ * 
+ * Permission is hereby granted, free of charge, to any person 
+ * obtaining a copy of this software and associated documentation 
+ * files (the "Software"), to deal in the Software without restriction, 
+ * including without limitation the rights to use, copy, modify, 
+ * merge, publish, distribute, sublicense, and/or sell copies of the 
+ * Software, and to permit persons to whom the Software is furnished to 
+ * do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be 
+ * included in all copies or substantial portions of the Software.
+ * 
+ * Links inside the Software pointing to the original source must not 
+ * be changed or removed.
+ *
+ * In addition, the following restrictions apply:
+ * 
+ * 1. The Software and any modifications made to it may not be used 
+ * for the purpose of training or improving machine learning algorithms, 
+ * including but not limited to artificial intelligence, natural 
+ * language processing, or data mining. This condition applies to any 
+ * derivatives, modifications, or updates based on the Software code. 
+ * Any usage of the Software in an AI-training dataset is considered a 
+ * breach of this License.
+ *
+ * 2. The Software may not be included in any dataset used for 
+ * training or improving machine learning algorithms, including but 
+ * not limited to artificial intelligence, natural language processing, 
+ * or data mining.
+ *
+ * 3. Any person or organization found to be in violation of these 
+ * restrictions will be subject to legal action and may be held liable 
+ * for any damages resulting from such use.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. 
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY 
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, 
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE 
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef _TC_TZDB_H
+#define _TC_TZDB_H
+
+// 461 zones, 93 distinct POSIX strings, 7292 bytes
+
+#define TZDB_COUNT      461
+#define TZDB_MAXNAMELEN 30
+
+#define TZDB_NAME(e)    ((e) & 0x3fff)
+#define TZDB_POSIX(e)   (((e) >> 14) & 0xfff)
+#define TZDB_REGION(e)  ((e) >> 26)
+
+static const char tzdbPosix[] =
+  "GMT0\0""EAT-3\0""CET-1\0""WAT-1\0""CAT-2\0"
+  "EET-2EEST,M4.5.5/0,M10.5.4/24\0""<+01>-1\0"
+  "CET-1CEST,M3.5.0,M10.5.0/3\0""SAST-2\0""EET-2\0"
+  "HST10HDT,M3.2.0,M11.1.0\0""AKST9AKDT,M3.2.0,M11.1.0\0""AST4\0"
+  "<-03>3\0""EST5\0""CST6\0""<-04>4\0""<-05>5\0""MST7MDT,M3.2.0,M11.1.0\0"
+  "CST6CDT,M3.2.0,M11.1.0\0""MST7\0""EST5EDT,M3.2.0,M11.1.0\0"
+  "AST4ADT,M3.2.0,M11.1.0\0""<-02>2<-01>,M3.5.0/-1,M10.5.0/0\0"
+  "CST5CDT,M3.2.0/0,M11.1.0/1\0""PST8PDT,M3.2.0,M11.1.0\0"
+  "<-03>3<-02>,M3.2.0,M11.1.0\0""<-02>2\0"
+  "<-04>4<-03>,M9.1.6/24,M4.1.6/24\0""NST3:30NDT,M3.2.0,M11.1.0\0"
+  "<+08>-8\0""<+07>-7\0""<+10>-10\0""AEST-10AEDT,M10.1.0,M4.1.0/3\0"
+  "<+05>-5\0""NZST-12NZDT,M9.5.0,M4.1.0/3\0""<+03>-3\0"
+  "<+00>0<+02>-2,M3.5.0/1,M10.5.0/3\0""<+12>-12\0""<+04>-4\0"
+  "EET-2EEST,M3.5.0/0,M10.5.0/0\0""<+06>-6\0""<+09>-9\0""<+0530>-5:30\0"
+  "EET-2EEST,M3.5.0/3,M10.5.0/4\0""EET-2EEST,M3.4.4/50,M10.4.4/50\0"
+  "HKT-8\0""WIB-7\0""WIT-9\0""IST-2IDT,M3.4.4/26,M10.5.0\0"
+  "<+0430>-4:30\0""PKT-5\0""<+0545>-5:45\0""IST-5:30\0""CST-8\0"
+  "<+11>-11\0""WITA-8\0""PST-8\0""KST-9\0""<+0330>-3:30\0""JST-9\0"
+  "<+0630>-6:30\0""<-01>1<+00>,M3.5.0/0,M10.5.0/1\0"
+  "WET0WEST,M3.5.0/1,M10.5.0\0""<-01>1\0"
+  "ACST-9:30ACDT,M10.1.0,M4.1.0/3\0""AEST-10\0""ACST-9:30\0"
+  "<+0845>-8:45\0""<+1030>-10:30<+11>-11,M10.1.0,M4.1.0\0""AWST-8\0"
+  "<-10>10\0""<-11>11\0""<-12>12\0""<-06>6\0""<-07>7\0""<-08>8\0"
+  "<-09>9\0""<+13>-13\0""<+14>-14\0""<+02>-2\0""UTC0\0"
+  "EET-2EEST,M3.5.0,M10.5.0/3\0""IST-1GMT0,M10.5.0,M3.5.0/1\0"
+  "GMT0BST,M3.5.0/1,M10.5.0\0""MSK-3\0"
+  "<+1245>-12:45<+1345>,M9.5.0/2:45,M4.1.0/3:45\0"
+  "<-06>6<-05>,M9.1.6/22,M4.1.6/22\0""ChST-10\0""HST10\0""<-0930>9:30\0"
+  "SST11\0""<+11>-11<+12>,M10.1.0,M4.1.0/3\0";
+
+static const char tzdbRegions[] =
+  "Africa/\0""America/\0""America/Argentina/\0""America/Indiana/\0"
+  "America/Kentucky/\0""America/North_Dakota/\0""Antarctica/\0""Arctic/\0"
+  "Asia/\0""Atlantic/\0""Australia/\0""Etc/\0""Europe/\0""Indian/\0"
+  "Pacific/\0";
+
+static const uint8_t tzdbRegOffs[] = {
+  0, 8, 17, 36, 53, 71, 93, 105, 113, 119, 129, 140,
+  145, 153, 161
+};
+
+static const char tzdbNames[] =
+  "Abidjan\0""Accra\0""Addis_Ababa\0""Algiers\0""Asmara\0""Bamako\0"
+  "Bangui\0""Banjul\0""Bissau\0""Blantyre\0""Brazzaville\0""Bujumbura\0"
+  "Cairo\0""Casablanca\0""Ceuta\0""Conakry\0""Dakar\0""Dar_es_Salaam\0"
+  "Djibouti\0""Douala\0""El_Aaiun\0""Freetown\0""Gaborone\0""Harare\0"
+  "Johannesburg\0""Juba\0""Kampala\0""Khartoum\0""Kigali\0""Kinshasa\0"
+  "Lagos\0""Libreville\0""Lome\0""Luanda\0""Lubumbashi\0""Lusaka\0"
+  "Malabo\0""Maputo\0""Maseru\0""Mbabane\0""Mogadishu\0""Monrovia\0"
+  "Nairobi\0""Ndjamena\0""Niamey\0""Nouakchott\0""Ouagadougou\0"
+  "Porto-Novo\0""Sao_Tome\0""Tripoli\0""Tunis\0""Windhoek\0""Adak\0"
+  "Anchorage\0""Anguilla\0""Antigua\0""Araguaina\0""Buenos_Aires\0"
+  "Catamarca\0""Cordoba\0""Jujuy\0""La_Rioja\0""Mendoza\0""Rio_Gallegos\0"
+  "Salta\0""San_Juan\0""San_Luis\0""Tucuman\0""Ushuaia\0""Aruba\0"
+  "Asuncion\0""Atikokan\0""Bahia\0""Bahia_Banderas\0""Barbados\0""Belem\0"
+  "Belize\0""Blanc-Sablon\0""Boa_Vista\0""Bogota\0""Boise\0"
+  "Cambridge_Bay\0""Campo_Grande\0""Cancun\0""Caracas\0""Cayenne\0"
+  "Cayman\0""Chicago\0""Chihuahua\0""Costa_Rica\0""Creston\0""Cuiaba\0"
+  "Curacao\0""Danmarkshavn\0""Dawson\0""Dawson_Creek\0""Denver\0"
+  "Detroit\0""Dominica\0""Edmonton\0""Eirunepe\0""El_Salvador\0"
+  "Fort_Nelson\0""Fortaleza\0""Glace_Bay\0""Godthab\0""Goose_Bay\0"
+  "Grand_Turk\0""Grenada\0""Guadeloupe\0""Guatemala\0""Guayaquil\0"
+  "Guyana\0""Halifax\0""Havana\0""Hermosillo\0""Indianapolis\0""Knox\0"
+  "Marengo\0""Petersburg\0""Tell_City\0""Vevay\0""Vincennes\0""Winamac\0"
+  "Inuvik\0""Iqaluit\0""Jamaica\0""Juneau\0""Louisville\0""Monticello\0"
+  "Kralendijk\0""La_Paz\0""Lima\0""Los_Angeles\0""Lower_Princes\0"
+  "Maceio\0""Managua\0""Manaus\0""Marigot\0""Martinique\0""Matamoros\0"
+  "Mazatlan\0""Menominee\0""Merida\0""Metlakatla\0""Mexico_City\0"
+  "Miquelon\0""Moncton\0""Monterrey\0""Montevideo\0""Montreal\0"
+  "Montserrat\0""Nassau\0""New_York\0""Nipigon\0""Nome\0""Noronha\0"
+  "Beulah\0""Center\0""New_Salem\0""Nuuk\0""Ojinaga\0""Panama\0"
+  "Pangnirtung\0""Paramaribo\0""Phoenix\0""Port-au-Prince\0"
+  "Port_of_Spain\0""Porto_Velho\0""Puerto_Rico\0""Punta_Arenas\0"
+  "Rainy_River\0""Rankin_Inlet\0""Recife\0""Regina\0""Resolute\0"
+  "Rio_Branco\0""Santarem\0""Santiago\0""Santo_Domingo\0""Sao_Paulo\0"
+  "Scoresbysund\0""Sitka\0""St_Barthelemy\0""St_Johns\0""St_Kitts\0"
+  "St_Lucia\0""St_Thomas\0""St_Vincent\0""Swift_Current\0""Tegucigalpa\0"
+  "Thule\0""Thunder_Bay\0""Tijuana\0""Toronto\0""Tortola\0""Vancouver\0"
+  "Whitehorse\0""Winnipeg\0""Yakutat\0""Yellowknife\0""Casey\0""Davis\0"
+  "DumontDUrville\0""Macquarie\0""Mawson\0""McMurdo\0""Palmer\0"
+  "Rothera\0""Syowa\0""Troll\0""Vostok\0""Longyearbyen\0""Aden\0"
+  "Almaty\0""Amman\0""Anadyr\0""Aqtau\0""Aqtobe\0""Ashgabat\0""Atyrau\0"
+  "Baghdad\0""Bahrain\0""Baku\0""Bangkok\0""Barnaul\0""Beirut\0"
+  "Bishkek\0""Brunei\0""Chita\0""Choibalsan\0""Colombo\0""Damascus\0"
+  "Dhaka\0""Dili\0""Dubai\0""Dushanbe\0""Famagusta\0""Gaza\0""Hebron\0"
+  "Ho_Chi_Minh\0""Hong_Kong\0""Hovd\0""Irkutsk\0""Jakarta\0""Jayapura\0"
+  "Jerusalem\0""Kabul\0""Kamchatka\0""Karachi\0""Kathmandu\0""Khandyga\0"
+  "Kolkata\0""Krasnoyarsk\0""Kuala_Lumpur\0""Kuching\0""Kuwait\0""Macau\0"
+  "Magadan\0""Makassar\0""Manila\0""Muscat\0""Nicosia\0""Novokuznetsk\0"
+  "Novosibirsk\0""Omsk\0""Oral\0""Phnom_Penh\0""Pontianak\0""Pyongyang\0"
+  "Qatar\0""Qyzylorda\0""Riyadh\0""Sakhalin\0""Samarkand\0""Seoul\0"
+  "Shanghai\0""Singapore\0""Srednekolymsk\0""Taipei\0""Tashkent\0"
+  "Tbilisi\0""Tehran\0""Thimphu\0""Tokyo\0""Tomsk\0""Ulaanbaatar\0"
+  "Urumqi\0""Ust-Nera\0""Vientiane\0""Vladivostok\0""Yakutsk\0""Yangon\0"
+  "Yekaterinburg\0""Yerevan\0""Azores\0""Bermuda\0""Canary\0"
+  "Cape_Verde\0""Faroe\0""Madeira\0""Reykjavik\0""South_Georgia\0"
+  "St_Helena\0""Stanley\0""Adelaide\0""Brisbane\0""Broken_Hill\0"
+  "Currie\0""Darwin\0""Eucla\0""Hobart\0""Lindeman\0""Lord_Howe\0"
+  "Melbourne\0""Perth\0""Sydney\0""GMT\0""GMT+0\0""GMT+1\0""GMT+10\0"
+  "GMT+11\0""GMT+12\0""GMT+2\0""GMT+3\0""GMT+4\0""GMT+5\0""GMT+6\0"
+  "GMT+7\0""GMT+8\0""GMT+9\0""GMT-0\0""GMT-1\0""GMT-10\0""GMT-11\0"
+  "GMT-12\0""GMT-13\0""GMT-14\0""GMT-2\0""GMT-3\0""GMT-4\0""GMT-5\0"
+  "GMT-6\0""GMT-7\0""GMT-8\0""GMT-9\0""GMT0\0""Greenwich\0""UCT\0"
+  "Universal\0""UTC\0""Zulu\0""Amsterdam\0""Andorra\0""Astrakhan\0"
+  "Athens\0""Belgrade\0""Berlin\0""Bratislava\0""Brussels\0""Bucharest\0"
+  "Budapest\0""Busingen\0""Chisinau\0""Copenhagen\0""Dublin\0"
+  "Gibraltar\0""Guernsey\0""Helsinki\0""Isle_of_Man\0""Istanbul\0"
+  "Jersey\0""Kaliningrad\0""Kiev\0""Kirov\0""Lisbon\0""Ljubljana\0"
+  "London\0""Luxembourg\0""Madrid\0""Malta\0""Mariehamn\0""Minsk\0"
+  "Monaco\0""Moscow\0""Oslo\0""Paris\0""Podgorica\0""Prague\0""Riga\0"
+  "Rome\0""Samara\0""San_Marino\0""Sarajevo\0""Saratov\0""Simferopol\0"
+  "Skopje\0""Sofia\0""Stockholm\0""Tallinn\0""Tirane\0""Ulyanovsk\0"
+  "Uzhgorod\0""Vaduz\0""Vatican\0""Vienna\0""Vilnius\0""Volgograd\0"
+  "Warsaw\0""Zagreb\0""Zaporozhye\0""Zurich\0""Antananarivo\0""Chagos\0"
+  "Christmas\0""Cocos\0""Comoro\0""Kerguelen\0""Mahe\0""Maldives\0"
+  "Mauritius\0""Mayotte\0""Reunion\0""Apia\0""Auckland\0""Bougainville\0"
+  "Chatham\0""Chuuk\0""Easter\0""Efate\0""Enderbury\0""Fakaofo\0""Fiji\0"
+  "Funafuti\0""Galapagos\0""Gambier\0""Guadalcanal\0""Guam\0""Honolulu\0"
+  "Kiritimati\0""Kosrae\0""Kwajalein\0""Majuro\0""Marquesas\0""Midway\0"
+  "Nauru\0""Niue\0""Norfolk\0""Noumea\0""Pago_Pago\0""Palau\0""Pitcairn\0"
+  "Pohnpei\0""Port_Moresby\0""Rarotonga\0""Saipan\0""Tahiti\0""Tarawa\0"
+  "Tongatapu\0""Wake\0""Wallis\0";
+
+static const uint32_t tzdbIndex[TZDB_COUNT] = {
+  0x00000000, 0x00000008, 0x0001400e, 0x0002c01a, 0x00014022, 0x00000029,
+  0x00044030, 0x00000037, 0x0000003e, 0x0005c045, 0x0004404e, 0x0005c05a,
+  0x00074064, 0x000ec06a, 0x0010c075, 0x0000007b, 0x00000083, 0x00014089,
+  0x00014097, 0x000440a0, 0x000ec0a7, 0x000000b0, 0x0005c0b9, 0x0005c0c2,
+  0x001780c9, 0x0005c0d6, 0x000140db, 0x0005c0e3, 0x0005c0ec, 0x000440f3,
+  0x000440fc, 0x00044102, 0x0000010d, 0x00044112, 0x0005c119, 0x0005c124,
+  0x0004412b, 0x0005c132, 0x00178139, 0x00178140, 0x00014148, 0x00000152,
+  0x0001415b, 0x00044163, 0x0004416c, 0x00000173, 0x0000017e, 0x0004418a,
+  0x00000195, 0x0019419e, 0x0002c1a6, 0x0005c1ac, 0x041ac1b5, 0x0420c1ba,
+  0x042701c4, 0x042701cd, 0x042841d5, 0x082841df, 0x082841ec, 0x082841f6,
+  0x082841fe, 0x08284204, 0x0828420d, 0x08284215, 0x08284222, 0x08284228,
+  0x08284231, 0x0828423a, 0x08284242, 0x0427024a, 0x04284250, 0x042a0259,
+  0x04284262, 0x042b4268, 0x04270277, 0x04284280, 0x042b4286, 0x0427028d,
+  0x042c829a, 0x042e42a4, 0x043002ab, 0x043002b1, 0x042c82bf, 0x042a02cc,
+  0x042c82d3, 0x042842db, 0x042a02e3, 0x0435c2ea, 0x042b42f2, 0x042b42fc,
+  0x043b8307, 0x042c830f, 0x04270316, 0x0400031e, 0x043b832b, 0x043b8332,
+  0x0430033f, 0x043cc346, 0x0427034e, 0x04300357, 0x042e4360, 0x042b4369,
+  0x043b8375, 0x04284381, 0x0442838b, 0x04484395, 0x0442839d, 0x043cc3a7,
+  0x042703b2, 0x042703ba, 0x042b43c5, 0x042e43cf, 0x042c83d9, 0x044283e0,
+  0x045043e8, 0x043b83ef, 0x0c3cc3fa, 0x0c35c407, 0x0c3cc40c, 0x0c3cc414,
+  0x0c35c41f, 0x0c3cc429, 0x0c3cc42f, 0x0c3cc439, 0x04300441, 0x043cc448,
+  0x042a0450, 0x0420c458, 0x103cc45f, 0x103cc46a, 0x04270475, 0x042c8480,
+  0x042e4487, 0x0457048c, 0x04270498, 0x042844a6, 0x042b44ad, 0x042c84b5,
+  0x042704bc, 0x042704c4, 0x0435c4cf, 0x043b84d9, 0x0435c4e2, 0x042b44ec,
+  0x0420c4f3, 0x042b44fe, 0x045cc50a, 0x04428513, 0x042b451b, 0x04284525,
+  0x043cc530, 0x04270539, 0x043cc544, 0x043cc54b, 0x043cc554, 0x0420c55c,
+  0x04638561, 0x1435c569, 0x1435c570, 0x1435c577, 0x04484581, 0x0435c586,
+  0x042a058e, 0x043cc595, 0x042845a1, 0x043b85ac, 0x043cc5b4, 0x042705c3,
+  0x042c85d1, 0x042705dd, 0x042845e9, 0x0435c5f6, 0x0435c602, 0x0428460f,
+  0x042b4616, 0x0435c61d, 0x042e4626, 0x04284631, 0x0465463a, 0x04270643,
+  0x04284651, 0x0448465b, 0x0420c668, 0x0427066e, 0x046d467c, 0x04270685,
+  0x0427068e, 0x04270697, 0x042706a1, 0x042b46ac, 0x042b46ba, 0x044286c6,
+  0x043cc6cc, 0x045706d8, 0x043cc6e0, 0x042706e8, 0x045706f0, 0x043b86fa,
+  0x0435c705, 0x0420c70e, 0x04300716, 0x1873c722, 0x1875c728, 0x1877c72e,
+  0x187a073d, 0x18814747, 0x1883474e, 0x18284756, 0x1828475d, 0x188a4765,
+  0x188c476b, 0x18814771, 0x1c10c778, 0x208a4785, 0x2081478a, 0x208a4791,
+  0x20948797, 0x2081479e, 0x208147a4, 0x208147ab, 0x208147b4, 0x208a47bb,
+  0x208a47c3, 0x2096c7cb, 0x2075c7d0, 0x2075c7d8, 0x2098c7e0, 0x20a007e7,
+  0x2073c7ef, 0x20a207f6, 0x2073c7fc, 0x20a40807, 0x208a480f, 0x20a00818,
+  0x20a2081e, 0x2096c823, 0x20814829, 0x20a74832, 0x20ae883c, 0x20ae8841,
+  0x2075c848, 0x20b64854, 0x2075c85e, 0x2073c863, 0x20b7c86b, 0x20b94873,
+  0x20bac87c, 0x20c18886, 0x2094888c, 0x20c4c896, 0x20c6489e, 0x20a208a8,
+  0x20c988b1, 0x2075c8b9, 0x2073c8c5, 0x2073c8d2, 0x208a48da, 0x20cbc8e1,
+  0x20cd48e7, 0x20cf88ef, 0x20d148f8, 0x2096c8ff, 0x20a74906, 0x2075c90e,
+  0x2075c91b, 0x20a00927, 0x2081492c, 0x2075c931, 0x20b7c93c, 0x20d2c946,
+  0x208a4950, 0x20814956, 0x208a4960, 0x20cd4967, 0x20814970, 0x20d2c97a,
+  0x20cbc980, 0x2073c989, 0x20cd4993, 0x20cbc9a1, 0x208149a8, 0x2096c9b1,
+  0x20d449b9, 0x20a009c0, 0x20d789c8, 0x2075c9ce, 0x2073c9d4, 0x20a009e0,
+  0x2077c9e7, 0x2075c9f0, 0x2077c9fa, 0x20a20a06, 0x20d90a0e, 0x20814a15,
+  0x2096ca23, 0x24dc4a2b, 0x24428a32, 0x24e40a3a, 0x24ea8a41, 0x24e40a4c,
+  0x24e40a52, 0x24000a5a, 0x24638a64, 0x24000a72, 0x24284a7c, 0x28ec4a84,
+  0x28f40a8d, 0x28ec4a96, 0x287a0aa2, 0x28f60aa9, 0x28f88ab0, 0x287a0ab6,
+  0x28f40abd, 0x28fbcac6, 0x287a0ad0, 0x29050ada, 0x287a0ae0, 0x2c000ae7,
+  0x2c000aeb, 0x2cea8af1, 0x2d06caf7, 0x2d08cafe, 0x2d0acb05, 0x2c638b0c,
+  0x2c284b12, 0x2c2c8b18, 0x2c2e4b1e, 0x2d0ccb24, 0x2d0e8b2a, 0x2d104b30,
+  0x2d120b36, 0x2c000b3c, 0x2c0ecb42, 0x2c77cb48, 0x2ccd4b4f, 0x2c948b56,
+  0x2d13cb5d, 0x2d160b64, 0x2d184b6b, 0x2c8a4b71, 0x2c96cb77, 0x2c814b7d,
+  0x2ca00b83, 0x2c75cb89, 0x2c73cb8f, 0x2ca20b95, 0x2c000b9b, 0x2c000ba0,
+  0x2d1a4baa, 0x2d1a4bae, 0x2d1a4bb8, 0x2d1a4bbc, 0x3010cbc1, 0x3010cbcb,
+  0x3096cbd3, 0x30a74bdd, 0x3010cbe4, 0x3010cbed, 0x3010cbf4, 0x3010cbff,
+  0x30a74c08, 0x3010cc12, 0x3010cc1b, 0x311b8c24, 0x3010cc2d, 0x31224c38,
+  0x3010cc3f, 0x31290c49, 0x30a74c52, 0x31290c5b, 0x308a4c67, 0x31290c70,
+  0x30194c77, 0x30a74c83, 0x312f4c88, 0x30e40c8e, 0x3010cc95, 0x31290c9f,
+  0x3010cca6, 0x3010ccb1, 0x3010ccb8, 0x30a74cbe, 0x308a4cc8, 0x3010ccce,
+  0x312f4cd5, 0x3010ccdc, 0x3010cce1, 0x3010cce7, 0x3010ccf1, 0x30a74cf8,
+  0x3010ccfd, 0x3096cd02, 0x3010cd09, 0x3010cd14, 0x3096cd1d, 0x312f4d25,
+  0x3010cd30, 0x30a74d37, 0x3010cd3d, 0x30a74d47, 0x3010cd4f, 0x3096cd56,
+  0x30a74d60, 0x3010cd69, 0x3010cd6f, 0x3010cd77, 0x30a74d7e, 0x312f4d86,
+  0x3010cd90, 0x3010cd97, 0x30a74d9e, 0x3010cda9, 0x34014db0, 0x34a00dbd,
+  0x3475cdc4, 0x34d90dce, 0x34014dd4, 0x34814ddb, 0x3496cde5, 0x34814dea,
+  0x3496cdf3, 0x34014dfd, 0x3496ce05, 0x3913ce0d, 0x38834e12, 0x38cd4e1b,
+  0x3930ce28, 0x3877ce30, 0x393c0e36, 0x38cd4e3d, 0x3913ce43, 0x3913ce4d,
+  0x38948e55, 0x38948e5a, 0x390cce63, 0x39120e6d, 0x38cd4e75, 0x39440e81,
+  0x39460e86, 0x39160e8f, 0x38cd4e9a, 0x38948ea1, 0x38948eab, 0x39478eb2,
+  0x394a8ebc, 0x38948ec3, 0x3908cec9, 0x394c0ece, 0x38cd4ed6, 0x394a8edd,
+  0x38a20ee7, 0x39104eed, 0x38cd4ef6, 0x3877cefe, 0x3906cf0b, 0x39440f15,
+  0x3906cf1c, 0x38948f23, 0x3913cf2a, 0x38948f34, 0x38948f39
+};
+
+#endif
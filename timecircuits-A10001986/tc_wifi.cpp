@@ -65,6 +65,7 @@
 #endif
 
 #include "tcddisplay.h"
+#include "i2cbus.h"
 #include "tc_main.h"
 #include "tc_audio.h"
 #include "tc_settings.h"
@@ -89,6 +90,8 @@ unsigned long mqttInitialConnectNow = 0;
 #endif
 
 static const char R_updateacdone[] = "/uac";
+static const char R_tzlist[]       = "/tzl";
+static const char R_i2cstats[]     = "/i2c";
 
 static const char acul_part1[]  = "</style>";
 static const char acul_part3[]  = "</head><body><div id='wrap'><h1 id='h1'>";
@@ -350,7 +353,7 @@ WiFiManagerParameter custom_mode24("md24", "24-hour clock", settings.mode24, "",
 WiFiManagerParameter custom_ttrp("ttrp", "Make time travel persistent", settings.timesPers, "", WFM_LABEL_AFTER|WFM_IS_CHKBOX);
 #endif
 
-WiFiManagerParameter custom_timeZone("tzx", "Time zone (in <a href='https://tz.out-a-ti.me' target=_blank>Posix</a> format)", settings.timeZone, 63, "placeholder='Example: CST6CDT,M3.2.0,M11.1.0' list='tzlist'", WFM_LABEL_BEFORE|WFM_SECTS);
+WiFiManagerParameter custom_timeZone("tzx", "Time zone (<a href='https://tz.out-a-ti.me' target=_blank>Posix</a> or zone name)", settings.timeZone, 63, "placeholder='Example: CST6CDT,M3.2.0,M11.1.0' list='tzlist'", WFM_LABEL_BEFORE|WFM_SECTS);
 WiFiManagerParameter custom_ntpServer("ntps", "NTP server", settings.ntpServer, 63, "pattern='[a-zA-Z0-9\\.\\-]+' placeholder='Example: pool.ntp.org'");
 WiFiManagerParameter custom_NTPLUF(wmBuildNTPLUF);
 #ifdef TC_HAVEGPS
@@ -643,6 +646,8 @@ static void evalCB(char *sv, WiFiManagerParameter *el);
 static void setCBVal(WiFiManagerParameter *el, char *sv);
 
 static void setupWebServerCallback();
+static void handleTzList();
+static void handleI2CStats();
 static void handleUploadDone();
 static void handleUploading();
 static void handleUploadDone();
@@ -655,6 +660,9 @@ static bool mqttReconnect(bool force = false);
 static void mqttLooper();
 static void mqttCallback(char *topic, byte *payload, unsigned int length);
 static void mqttSubscribe();
+static void mqttPublishI2CStats();
+static void mqttPublishAudioStats();
+static void mqttPublishBTTFNStats();
 #endif
 
 #ifdef TC_HAVEMQTT
@@ -2028,8 +2036,6 @@ static int menuOutLenCallback()
     uint8_t type;
     int mySize = 0;
 
-    if(numCli > 6) numCli = 6;
-
     if(numCli) {
         bool hdr = false;
 
@@ -2071,8 +2077,6 @@ static void menuOutCallback(String& page, unsigned int ssize)
     if(!strBuf) return;
 
     strBuf[0] = 0;
-    
-    if(numCli > 6) numCli = 6;
 
     if(numCli) {
 
@@ -2140,6 +2144,7 @@ static void wifiDelayReplacement(unsigned int mydel)
     if((mydel > 30) && audioInitDone) {
         unsigned long startNow = millis();
         while(millis() - startNow < mydel) {
+            i2cSched.newSlice();
             audio_loop();
             delay(20);
             audio_loop();
@@ -2411,15 +2416,20 @@ static const char *wmBuildTzlist(const char *dest, int op)
 
 #define TZLISTLEN 844   // Don't waste space calculating this   
 
+    // Full zone list is fetched from R_tzlist and appended; the option
+    // label shows the keypad code for selecting the zone (44xxxx)
+    static const char tzlScript[] = "<script>fetch('/tzl').then(r=>r.text()).then(t=>{d=ge('tzlist');i=0;t.split('\\n').forEach(n=>{if(n){o=document.createElement('option');o.value=n;o.text='Keypad 44'+(''+(1e4+i++)).slice(1);d.appendChild(o)}})})</script>";
+
     if(op == WM_CP_LEN) {
-        wmLenBuf = TZLISTLEN;
+        wmLenBuf = TZLISTLEN + STRLEN(tzlScript);
         return (const char *)&wmLenBuf;
     }
 
-    char *str = (char *)malloc(TZLISTLEN);
+    char *str = (char *)malloc(TZLISTLEN + STRLEN(tzlScript));
 
     sprintf(str, "<datalist id='tzlist'><option value='PST8PDT,M3.2.0,M11.1.0'>Pacific%sMST7MDT,M3.2.0,M11.1.0'>Mountain%sCST6CDT,M3.2.0,M11.1.0'>Central%sEST5EDT,M3.2.0,M11.1.0'>Eastern%sGMT0BST,M3.5.0/1,M10.5.0'>Western European%sCET-1CEST,M3.5.0,M10.5.0/3'>Central European%sEET-2EEST,M3.5.0/3,M10.5.0/4'>Eastern European%sMSK-3'>Moscow%sAWST-8'>Australia Western%sACST-9:30'>Australia Central/NT%sACST-9:30ACDT,M10.1.0,M4.1.0/3'>Australia Central/SA%sAEST-10AEDT,M10.1.0,M4.1.0/3'>Australia Eastern VIC/NSW%sAEST-10'>Australia Eastern QL%sJST-9'>Japan</option></datalist>",
         ooe, ooe, ooe, ooe, ooe, ooe, ooe, ooe, ooe, ooe, ooe, ooe, ooe);
+    strcat(str, tzlScript);
 
     return str;
 }
@@ -2789,6 +2799,75 @@ static const char *wmBuildMQTTTM(const char *dest, int op)
 static void setupWebServerCallback()
 {
     wm.server->on(R_updateacdone, HTTP_POST, &handleUploadDone, &handleUploading);
+    wm.server->on(R_tzlist, HTTP_GET, &handleTzList);
+    wm.server->on(R_i2cstats, HTTP_GET, &handleI2CStats);
+}
+
+/*
+ * Zone names from built-in table, one per line, in table order.
+ * Sent in chunks, the list is never in RAM as a whole.
+ */
+static void handleTzList()
+{
+    char buf[512];
+    int l = 0;
+
+    wm.server->setContentLength(CONTENT_LENGTH_UNKNOWN);
+    wm.server->send(200, "text/plain", "");
+
+    for(int i = 0; i < tzdbCount(); i++) {
+        if(l > (int)sizeof(buf) - (TZ_NAMEBUF_LEN + 1)) {
+            wm.server->sendContent(buf, l);
+            l = 0;
+        }
+        tzdbGetName(i, buf + l);
+        l += strlen(buf + l);
+        buf[l++] = '\n';
+    }
+    if(l) wm.server->sendContent(buf, l);
+
+    wm.server->sendContent("");
+}
+
+// Bytes a display did not send thanks to its shadow buffer
+static uint32_t i2cBytesSaved(uint8_t addr)
+{
+    uint32_t s = 0;
+
+    if(destinationTime.getAddress() == addr) s += destinationTime.getI2CBytesSaved();
+    if(presentTime.getAddress() == addr)     s += presentTime.getI2CBytesSaved();
+    if(departedTime.getAddress() == addr)    s += departedTime.getI2CBytesSaved();
+    if(speedo.haveSpeedoDisplay() && speedo.getAddress() == addr)
+        s += speedo.getI2CBytesSaved();
+
+    return s;
+}
+
+/*
+ * i2c bus statistics, plain text, one device per line
+ */
+static void handleI2CStats()
+{
+    char buf[192];
+    const i2cDevStats *st;
+    int l;
+
+    wm.server->setContentLength(CONTENT_LENGTH_UNKNOWN);
+    wm.server->send(200, "text/plain", "");
+
+    wm.server->sendContent("addr  xfers     bytes      usecs   errors     saved  histogram (<64us, <128us, ... >=16ms)\n");
+    
+    for(int i = 0; (st = i2cBus.getDevStats(i)); i++) {
+        l = sprintf(buf, "0x%02x %6u %9u %10u %8u %9u ", st->addr, st->count, st->bytes, st->usecs, st->errors,
+                    i2cBytesSaved(st->addr));
+        for(int j = 0; j < I2CS_HIST_BINS; j++) {
+            l += sprintf(buf + l, " %u", st->hist[j]);
+        }
+        buf[l++] = '\n';
+        wm.server->sendContent(buf, l);
+    }
+
+    wm.server->sendContent("");
 }
 
 static void doReboot()
@@ -3415,6 +3494,10 @@ static void mqttCallback(char *topic, byte *payload, unsigned int length)
       "\x0b" "VOLUME_DOWN",      // 28
       "\x0b" "VOLUME_SET_",      // 29                                VOLUME_SET_0 .. VOLUME_SET_100
       "\xcc" "MP_REQSTATUS",     // 30 !!! also when CSF_OFF or AL or TT or MA etc.
+      "\x09" "TIMEZONE_",        // 31                                TIMEZONE_Europe/Vienna etc
+      "\xc9" "I2C_STATS",        // 32 also when CSF_OFF or AL
+      "\xcb" "AUDIO_STATS",      // 33 also when CSF_OFF or AL
+      "\xcb" "BTTFN_STATS",      // 34 also when CSF_OFF or AL
       NULL
     };
 
@@ -3598,6 +3681,20 @@ static void mqttCallback(char *topic, byte *payload, unsigned int length)
         case 30:
             mp_sendStatus(1);
             break;
+        case 31:
+            if(tempBufLen > j) {
+                tzdbSelect(tzdbFind(&tempBuf[j]));
+            }
+            break;
+        case 32:
+            mqttPublishI2CStats();
+            break;
+        case 33:
+            mqttPublishAudioStats();
+            break;
+        case 34:
+            mqttPublishBTTFNStats();
+            break;
         }
             
     } else {
@@ -3764,4 +3861,78 @@ bool mqttPublish(const char *topic, const char *pl, unsigned int len)
     return true;
 }
 
+/*
+ * Publish i2c bus statistics to bttf/tcd/i2cstats,
+ * one message per device
+ */
+static void mqttPublishI2CStats()
+{
+    char msg[256];
+    const i2cDevStats *st;
+    int l;
+
+    for(int i = 0; (st = i2cBus.getDevStats(i)); i++) {
+        l = sprintf(msg, 
+                "{\"A\":\"%02x\",\"N\":\"%u\",\"B\":\"%u\",\"US\":\"%u\",\"E\":\"%u\",\"S\":\"%u\",\"H\":\"", 
+                st->addr, st->count, st->bytes, st->usecs, st->errors, i2cBytesSaved(st->addr));
+        for(int j = 0; j < I2CS_HIST_BINS; j++) {
+            l += sprintf(msg + l, j ? ",%u" : "%u", st->hist[j]);
+        }
+        strcpy(msg + l, "\"}");
+        mqttPublish("bttf/tcd/i2cstats", msg, strlen(msg) + 1);
+    }
+}
+
+/*
+ * Publish audio ring buffer statistics to bttf/tcd/audiostats
+ */
+static void mqttPublishAudioStats()
+{
+    char msg[416];
+    Aud_Stats st;
+
+    getAudioStats(&st);
+    sprintf(msg, "{\"U\":\"%u\",\"MIN\":\"%u\",\"MAX\":\"%u\",\"SZ\":\"%u\","
+                 "\"L\":\"%u\",\"LM\":\"%u\",\"G\":\"%u\",\"GM\":\"%u\","
+                 "\"CH\":\"%u\",\"CM\":\"%u\",\"CU\":\"%u\",\"CB\":\"%u\","
+                 "\"RF\":\"%u\",\"RA\":\"%u\",\"RS\":\"%u\",\"RT\":\"%u\",\"RD\":\"%u\","
+                 "\"MF\":\"%u\",\"MI\":\"%u\",\"MD\":\"%u\",\"MS\":\"%u\"}", 
+                 st.underruns, st.minFill, st.maxFill, st.ringSize,
+                 st.lastLatency, st.maxLatency, st.lastGap, st.maxGap,
+                 st.cacheHits, st.cacheMisses, st.cacheUsed, st.cacheBudget,
+                 st.raFills, st.raAvoided, st.raStalls, st.raStallUs, st.raDirect,
+                 st.mp3Frames, st.mp3Input, st.mp3Decode, st.mp3Synth);
+    mqttPublish("bttf/tcd/audiostats", msg, strlen(msg) + 1);
+}
+
+/*
+ * Publish BTTFN packet handling statistics to bttf/tcd/bttfnstats,
+ * and clock sync data to bttf/tcd/bttfnclients, one message per client
+ */
+static void mqttPublishBTTFNStats()
+{
+    char msg[256];
+    BTTFN_Stats st;
+    char *id;
+    uint8_t *ip, type;
+    int32_t offset;
+    uint16_t rtt;
+
+    bttfnGetStats(&st);
+    sprintf(msg, "{\"C\":\"%u\",\"P\":\"%u\",\"MC\":\"%u\",\"Q\":\"%u\","
+                 "\"BP\":\"%u\",\"BT\":\"%u\",\"US\":\"%u\",\"N\":\"%d\","
+                 "\"ND\":\"%u\",\"NC\":\"%u\",\"NH\":\"%u\",\"NL\":\"%u\",\"NLM\":\"%u\"}", 
+                 st.calls, st.packets, st.mcPackets, st.maxPerCall,
+                 st.pktLimit, st.timeLimit, st.maxUs, bttfnNumClients(),
+                 st.ndPackets, st.ndChanged, st.ndPerHour, st.ndLatAvg, st.ndLatMax);
+    mqttPublish("bttf/tcd/bttfnstats", msg, strlen(msg) + 1);
+
+    for(int i = 0; bttfnGetClientInfo(i, &id, &ip, &type); i++) {
+        bool synced = bttfnGetClientSync(i, &offset, &rtt);
+        sprintf(msg, "{\"ID\":\"%s\",\"T\":\"%d\",\"S\":\"%d\",\"O\":\"%d\",\"R\":\"%d\"}",
+                 id, type, synced ? 1 : 0, synced ? (int)offset : 0, synced ? (int)rtt : 0);
+        mqttPublish("bttf/tcd/bttfnclients", msg, strlen(msg) + 1);
+    }
+}
+
 #endif
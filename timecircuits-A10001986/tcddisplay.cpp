@@ -59,6 +59,7 @@
 
 #include <Arduino.h>
 #include <Wire.h>
+#include "i2cbus.h"
 
 #include "tcddisplay.h"
 #include "tc_font.h"
@@ -144,6 +145,8 @@ tcdDisplay::tcdDisplay(unsigned int did, uint8_t address)
 void tcdDisplay::begin()
 {
     _rtc = (_did == DISP_PRES);
+
+    _shadowValid = false;
     
     directCmd(0x20 | 1); // turn on oscillator
 
@@ -175,6 +178,7 @@ void tcdDisplay::onBlink(uint8_t blink)
 // Turn off the display
 void tcdDisplay::off()
 {
+    if(!_animBusy) _anim = NULL;
     directCmd(0x80);
 }
 
@@ -348,6 +352,76 @@ bool tcdDisplay::showAnimate3(int mystep)
 }
 #endif // IS_ACAR_DISPLAY
 
+// Animation engine ------------------------------------------------------------
+
+#ifndef TC_NO_MONTH_ANIM
+static bool animMonth(tcdDisplay *disp, int stage)
+{
+    disp->showAnimate(!stage);
+    return true;
+}
+
+// Month animation: All but month, then all
+const tcdAnimStep tcdAnimMonth[] = {
+    { animMonth, 0, 80 },
+    { animMonth, 1, 0 },
+    { NULL }
+};
+#endif
+
+#ifndef IS_ACAR_DISPLAY
+static bool animDate(tcdDisplay *disp, int step)
+{
+    return disp->showAnimate3(step);
+}
+
+// Date entry animation: Fields one by one
+const tcdAnimStep tcdAnimDate[] = {
+    { animDate, 0, 5 }, { animDate, 1, 5 }, { animDate, 2, 5 },
+    { animDate, 3, 5 }, { animDate, 4, 5 }, { animDate, 5, 5 },
+    { animDate, 6, 5 }, { animDate, 7, 5 }, { animDate, 8, 5 },
+    { animDate, 9, 5 }, { animDate, 10, 5 }, { animDate, 11, 5 },
+    { NULL }
+};
+#endif
+
+// Start animation sequence; first step is
+// executed immediately, the rest is driven
+// by animLoop().
+// While an animation is running, show() and
+// showAlt() are ignored; writing directly to
+// the display or switching it off ends it.
+void tcdDisplay::startAnim(const tcdAnimStep *seq)
+{
+    _anim = seq;
+    _animDur = 0;
+    animLoop();
+}
+
+void tcdDisplay::animLoop()
+{
+    bool ok;
+    
+    if(!_anim || (millis() - _animNow < _animDur))
+        return;
+
+    // Execute all steps that are due; steps with zero
+    // duration are followed by the next one at once
+    do {
+        _animBusy = true;
+        ok = _anim->func(this, _anim->parm);
+        _animBusy = false;
+        _animDur = _anim->dur;
+        _anim++;
+        if(!ok || !_anim->func) {
+            _anim = NULL;
+            break;
+        }
+    } while(!_animDur);
+
+    _animNow = millis();
+}
+
 void tcdDisplay::showAlt()
 {
     showInt(false, true);
@@ -993,6 +1067,9 @@ void tcdDisplay::showInt(bool animate, bool Alt)
     uint16_t *dbuf; 
     uint16_t db[CD_BUF_SIZE];
 
+    if(_anim && !_animBusy)
+        return;
+
     if(!handleNM())
         return;
 
@@ -1063,29 +1140,106 @@ void tcdDisplay::clearDisplay()
 
 void tcdDisplay::directCmd(uint8_t val)
 {
-    Wire.beginTransmission(_address);
-    Wire.write(val);
-    Wire.endTransmission();
+    // Commands must not overtake a pending frame
+    sendFrame();
+    
+    i2cBus.beginTransmission(_address);
+    i2cBus.write(val);
+    i2cBus.endTransmission();
 }
 
+// Write buffer to display RAM. If a frame is held,
+// only store it in the back buffer; it is sent
+// upon flushFrame().
 void tcdDisplay::directBuf(uint16_t *db, int len)
 {
-    Wire.beginTransmission(_address);
-    Wire.write(0x00);
-    for(int i = 0; i < len; i++) {
-        Wire.write(db[i] & 0xff);
-        Wire.write(db[i] >> 8);
+    if(!_animBusy) _anim = NULL;
+
+    if(_frameHeld && len == CD_BUF_SIZE) {
+        memcpy(_frameBuffer, db, sizeof(_frameBuffer));
+        _frameDirty = true;
+        return;
+    }
+
+    sendFrame();
+
+    writeBuf(db, len);
+}
+
+// Send pending frame (if any) and release hold.
+// Returns number of bytes sent.
+int tcdDisplay::flushFrame()
+{
+    _frameHeld = false;
+
+    return sendFrame();
+}
+
+int tcdDisplay::sendFrame()
+{
+    if(!_frameDirty)
+        return 0;
+
+    _frameDirty = false;
+
+    return writeBuf(_frameBuffer, CD_BUF_SIZE);
+}
+
+// Write buffer to display RAM; only the range that
+// differs from what was last sent is transmitted.
+// Returns number of bytes sent.
+int tcdDisplay::writeBuf(uint16_t *db, int len)
+{
+    int first = 0, last = len - 1;
+
+    if(_shadowValid) {
+        while(first < len && db[first] == _shadowBuffer[first]) first++;
+        if(first == len) {
+            _i2cSaved += 1 + (len * 2);
+            return 0;
+        }
+        while(db[last] == _shadowBuffer[last]) last--;
+        _i2cSaved += (first + (len - 1 - last)) * 2;
+    }
+    
+    i2cBus.beginTransmission(_address);
+    i2cBus.write(first * 2);
+    for(int i = first; i <= last; i++) {
+        i2cBus.write(db[i] & 0xff);
+        i2cBus.write(db[i] >> 8);
+        _shadowBuffer[i] = db[i];
+    }
+    if(i2cBus.endTransmission()) {
+        // Failed, display RAM content unknown
+        _shadowValid = false;
+    } else if(len == CD_BUF_SIZE) {
+        _shadowValid = true;
     }
-    Wire.endTransmission();
+
+    return 1 + ((last - first + 1) * 2);
 }
 
 // Directly write to a column with supplied segments
 // (leave buffer intact, directly write to display)
 void tcdDisplay::directCol(int col, int segments)
 {
-    Wire.beginTransmission(_address);
-    Wire.write(col * 2);
-    Wire.write(segments & 0xff);
-    Wire.write(segments >> 8);
-    Wire.endTransmission();
+    if(!_animBusy) _anim = NULL;
+
+    sendFrame();
+    
+    if(_shadowValid) {
+        if(_shadowBuffer[col] == (uint16_t)segments) {
+            _i2cSaved += 3;
+            return;
+        }
+        _shadowBuffer[col] = segments;
+    }
+    
+    i2cBus.beginTransmission(_address);
+    i2cBus.write(col * 2);
+    i2cBus.write(segments & 0xff);
+    i2cBus.write(segments >> 8);
+    if(i2cBus.endTransmission()) {
+        _shadowValid = false;
+    }
 }
@@ -84,13 +84,32 @@ struct dateStruct {
 #define _AM 0x0080
 #define _PM 0x8000
 
+class tcdDisplay;
+
+// Animation sequence step: Function to call (NULL terminates
+// sequence; returning false aborts it), its parameter, and
+// time (ms) until the next step.
+typedef bool (*tcdAnimFunc)(tcdDisplay *disp, int parm);
+struct tcdAnimStep {
+    tcdAnimFunc func;
+    int16_t     parm;
+    uint16_t    dur;
+};
+
+#ifndef TC_NO_MONTH_ANIM
+extern const tcdAnimStep tcdAnimMonth[];
+#endif
+#ifndef IS_ACAR_DISPLAY
+extern const tcdAnimStep tcdAnimDate[];
+#endif
+
 class tcdDisplay {
 
     public:
 
         tcdDisplay(unsigned int did, uint8_t address);
         #ifdef IS_ACAR_DISPLAY
-        void setAddress(uint8_t address) { _address = address; }
+        void setAddress(uint8_t address) { _address = address; _shadowValid = false; }
         #endif
         void begin();
         void on();
@@ -107,6 +126,17 @@ class tcdDisplay {
         uint8_t setBrightnessDirect(uint8_t level);
         uint8_t getBrightness() { return _brightness; }
 
+        uint32_t getI2CBytesSaved() { return _i2cSaved; }
+        uint8_t  getAddress() { return _address; }
+
+        void holdFrame() { _frameHeld = true; }
+        int  flushFrame();
+
+        void startAnim(const tcdAnimStep *seq);
+        void stopAnim()    { _anim = NULL; }
+        bool animRunning() { return (_anim != NULL); }
+        void animLoop();
+
         void set1224(bool hours24) { _mode24 = hours24; }
         bool get1224()             { return _mode24; }
 
@@ -219,10 +249,23 @@ class tcdDisplay {
 
         void directCmd(uint8_t val);
         void directBuf(uint16_t *db, int len = CD_BUF_SIZE);
+        int  sendFrame();
+        int  writeBuf(uint16_t *db, int len);
         void directCol(int col, int segments);
 
         uint16_t _displayBuffer[CD_BUF_SIZE];
         uint16_t _displayBufferAlt[CD_BUF_SIZE];
+        uint16_t _shadowBuffer[CD_BUF_SIZE];   // Display RAM as last sent
+        bool     _shadowValid = false;
+        uint32_t _i2cSaved = 0;
+        uint16_t _frameBuffer[CD_BUF_SIZE];    // Back buffer while frame held
+        bool     _frameHeld = false;
+        bool     _frameDirty = false;
+
+        const tcdAnimStep *_anim = NULL;       // Running animation sequence
+        unsigned long _animNow = 0;
+        uint16_t _animDur = 0;
+        bool     _animBusy = false;            // Executing animation step
         
         unsigned int _did = 0;
         uint8_t  _address = 0;
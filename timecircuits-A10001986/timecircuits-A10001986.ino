@@ -1795,19 +1795,15 @@ void loop()
     audio_loop();
     scanKeypad();
     ntp_loop();
-    audio_loop();
     bttfn_loop(BNLP_SK_MC|BNLP_SK_NOTDATA|BNLP_SK_EXPIRE);
-    audio_loop();
     main_loop();
     audio_loop();
     wifi_loop();
-    audio_loop();
     bttfn_loop();
     bttfn_loop_ex();
-    audio_loop();
 }
 #endif
 
-#if defined(TC_DBG_TIME) || defined(TC_DBG_NET) || defined(TC_DBG_GPS)
+#if defined(TC_DBG_TIME) || defined(TC_DBG_NET) || defined(TC_DBG_GPS) || defined(TC_DBG_TZCHECK)
 #warning "Debug output is enabled. Binary not suitable for release."
 #endif
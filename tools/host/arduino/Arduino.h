@@ -0,0 +1,38 @@
+/*
+ * -------------------------------------------------------------------
+ * CircuitSetup.us Time Circuits Display
+ * (C) 2022-2026 Thomas Winischhofer (A10001986)
+ * https://github.com/realA10001986/Time-Circuits-Display
+ * https://tcd.out-a-ti.me
+ *
+ * Host test support: Minimal Arduino.h for the audio library
+ * -------------------------------------------------------------------
+ * License: Modified MIT NON-AI
+ * (See timecircuits-A10001986/tc_main.cpp for full license text)
+ */
+
+#ifndef _TC_HOST_ARDUINO_H
+#define _TC_HOST_ARDUINO_H
+
+#include "../host.h"
+#include <math.h>
+#include "pgmspace.h"
+
+static inline void yield() { }
+
+class Print {
+    public:
+        virtual ~Print() { }
+        virtual size_t write(uint8_t) = 0;
+        int printf_P(const char *fmt, ...) { return 0; }
+        int printf(const char *fmt, ...) { return 0; }
+};
+
+// "Cycles" are nanoseconds on the host
+class EspClass {
+    public:
+        uint32_t getCycleCount() { return (uint32_t)host_ns(); }
+};
+static EspClass ESP;
+
+#endif
@@ -0,0 +1,82 @@
+/*
+ * -------------------------------------------------------------------
+ * CircuitSetup.us Time Circuits Display
+ * (C) 2022-2026 Thomas Winischhofer (A10001986)
+ * https://github.com/realA10001986/Time-Circuits-Display
+ * https://tcd.out-a-ti.me
+ *
+ * Host test support: IPAddress and the UDP interface as in the
+ * ESP32 core. WiFiUDP is inert; tests derive their own sockets
+ * from UDP.
+ * -------------------------------------------------------------------
+ * License: Modified MIT NON-AI
+ * (See timecircuits-A10001986/tc_main.cpp for full license text)
+ */
+
+#ifndef _TC_HOST_WIFIUDP_H
+#define _TC_HOST_WIFIUDP_H
+
+#include "Arduino.h"
+
+class IPAddress {
+    public:
+        IPAddress() { _ip.dword = 0; }
+        IPAddress(uint32_t ip) { _ip.dword = ip; }
+        IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+        {
+            _ip.bytes[0] = a; _ip.bytes[1] = b; _ip.bytes[2] = c; _ip.bytes[3] = d;
+        }
+        operator uint32_t() const { return _ip.dword; }
+        uint8_t operator[](int i) const { return _ip.bytes[i]; }
+
+    private:
+        union {
+            uint8_t  bytes[4];
+            uint32_t dword;
+        } _ip;
+};
+
+class UDP {
+    public:
+        virtual ~UDP() { }
+        virtual uint8_t begin(uint16_t port) = 0;
+        virtual uint8_t beginMulticast(IPAddress ip, uint16_t port) = 0;
+        virtual void stop() = 0;
+        virtual int beginPacket(IPAddress ip, uint16_t port) = 0;
+        virtual int beginPacket(const char *host, uint16_t port) = 0;
+        virtual int endPacket() = 0;
+        virtual size_t write(uint8_t c) = 0;
+        virtual size_t write(const uint8_t *buf, size_t size) = 0;
+        virtual int parsePacket() = 0;
+        virtual int available() = 0;
+        virtual int read() = 0;
+        virtual int read(unsigned char *buf, size_t len) = 0;
+        virtual int read(char *buf, size_t len) = 0;
+        virtual int peek() = 0;
+        virtual void flush() = 0;
+        virtual IPAddress remoteIP() = 0;
+        virtual uint16_t remotePort() = 0;
+};
+
+class WiFiUDP : public UDP {
+    public:
+        uint8_t begin(uint16_t port) { return 1; }
+        uint8_t beginMulticast(IPAddress ip, uint16_t port) { return 1; }
+        void stop() { }
+        int beginPacket(IPAddress ip, uint16_t port) { return 1; }
+        int beginPacket(const char *host, uint16_t port) { return 1; }
+        int endPacket() { return 1; }
+        size_t write(uint8_t c) { return 1; }
+        size_t write(const uint8_t *buf, size_t size) { return size; }
+        int parsePacket() { return 0; }
+        int available() { return 0; }
+        int read() { return -1; }
+        int read(unsigned char *buf, size_t len) { return 0; }
+        int read(char *buf, size_t len) { return 0; }
+        int peek() { return -1; }
+        void flush() { }
+        IPAddress remoteIP() { return IPAddress(); }
+        uint16_t remotePort() { return 0; }
+};
+
+#endif
@@ -0,0 +1,90 @@
+/*
+ * -------------------------------------------------------------------
+ * CircuitSetup.us Time Circuits Display
+ * (C) 2022-2026 Thomas Winischhofer (A10001986)
+ * https://github.com/realA10001986/Time-Circuits-Display
+ * https://tcd.out-a-ti.me
+ *
+ * Host test support: Simulated I2C bus
+ *
+ * Every transfer advances the simulated clock (HOST_SIMCLOCK) by
+ * the time its bytes, plus address byte, take at 400kHz. Reads
+ * return 0xff. All transfers are recorded in hostWireLog. Writes to
+ * hostWireErrAddr are recorded, but report an error (as if the ACK
+ * was lost), so the caller cannot rely on the device's state.
+ * -------------------------------------------------------------------
+ * License: Modified MIT NON-AI
+ * (See timecircuits-A10001986/tc_main.cpp for full license text)
+ */
+
+#ifndef _TC_HOST_WIRE_H
+#define _TC_HOST_WIRE_H
+
+#include "Arduino.h"
+
+#define HOST_WIRE_US_PER_BYTE   23      // 9 bits at 400kHz
+#define HOST_WIRE_LOGLEN        4096
+#define HOST_WIRE_MAXDATA       32
+
+struct hostWireXfer {
+    uint8_t  addr;
+    bool     isRead;
+    uint8_t  len;
+    uint8_t  data[HOST_WIRE_MAXDATA];   // Written data (first bytes)
+};
+
+static hostWireXfer hostWireLog[HOST_WIRE_LOGLEN];
+static int          hostWireLogLen = 0;     // Entries, wraps around
+static uint64_t     hostWireBytes = 0;      // Incl. address bytes
+static uint8_t      hostWireErrAddr = 0xff;
+
+class TwoWire {
+    public:
+        void beginTransmission(uint8_t address) { _addr = address; _len = 0; }
+        size_t write(uint8_t val)
+        {
+            if(_len < HOST_WIRE_MAXDATA) _buf[_len] = val;
+            _len++;
+            return 1;
+        }
+        uint8_t endTransmission(bool sendStop = true)
+        {
+            xfer(_addr, false, _len);
+            return (_addr == hostWireErrAddr) ? 3 : 0;      // Data NACK
+        }
+        uint8_t requestFrom(uint8_t address, uint8_t len)
+        {
+            xfer(address, true, len);
+            _avail = len;
+            return len;
+        }
+        uint8_t requestFrom(int address, int len) { return requestFrom((uint8_t)address, (uint8_t)len); }
+        int read()
+        {
+            if(!_avail) return -1;
+            _avail--;
+            return 0xff;
+        }
+
+    private:
+        void xfer(uint8_t addr, bool isRead, uint32_t len)
+        {
+            hostWireXfer *x = &hostWireLog[hostWireLogLen++ % HOST_WIRE_LOGLEN];
+            x->addr = addr;
+            x->isRead = isRead;
+            x->len = len;
+            if(!isRead) memcpy(x->data, _buf, (len < HOST_WIRE_MAXDATA) ? len : HOST_WIRE_MAXDATA);
+            hostWireBytes += len + 1;
+            #ifdef HOST_SIMCLOCK
+            host_simUs += (len + 1) * HOST_WIRE_US_PER_BYTE;
+            #endif
+        }
+
+        uint8_t  _addr = 0;
+        uint32_t _len = 0;
+        uint8_t  _buf[HOST_WIRE_MAXDATA];
+        uint32_t _avail = 0;
+};
+static TwoWire Wire;
+
+#endif
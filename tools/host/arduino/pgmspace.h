@@ -0,0 +1,19 @@
+/*
+ * Host test support: PROGMEM is plain memory on the host
+ */
+
+#ifndef _TC_HOST_PGMSPACE_H
+#define _TC_HOST_PGMSPACE_H
+
+#include <string.h>
+
+#define PROGMEM
+#define PSTR(s)             (s)
+#define pgm_read_byte(a)    (*(const unsigned char *)(a))
+#define pgm_read_word(a)    (*(const unsigned short *)(a))
+#define pgm_read_dword(a)   (*(const unsigned int *)(a))
+#define memcpy_P            memcpy
+#define strcpy_P            strcpy
+#define snprintf_P          snprintf
+
+#endif
@@ -0,0 +1,632 @@
+/*
+ * -------------------------------------------------------------------
+ * CircuitSetup.us Time Circuits Display
+ * (C) 2022-2026 Thomas Winischhofer (A10001986)
+ * https://github.com/realA10001986/Time-Circuits-Display
+ * https://tcd.out-a-ti.me
+ *
+ * Host test: BTTFN load test
+ *
+ * Simulates LT_PERTYPE clients of every device type through a
+ * loopback UDP shim in place of the sockets: Discover packets (with
+ * right and wrong host name hash), polls with random requests in
+ * batches, clock sync with random clock offsets and network delays,
+ * a scheduled event, remote commands with sequence numbers,
+ * notifications, expiry, a full registry and change-driven NOT_DATA.
+ * Checks every response field and prints throughput and response
+ * latency (from queueing the request to sending the reply).
+ *
+ * Switching the remote to speed master only sets the flags here;
+ * its effects on displays and sound are not part of BTTFN.
+ * -------------------------------------------------------------------
+ * License: Modified MIT NON-AI
+ * (See timecircuits-A10001986/tc_main.cpp for full license text)
+ */
+
+#include "Arduino.h"
+#include "WiFiUdp.h"
+#include "i2cbus.cpp"
+#include "tcddisplay.cpp"
+
+#include "tc_main_bttfn_h.inc"
+#include "tc_audio_pa.inc"
+#include "tc_keypad_eef.inc"
+
+// Not used by the tested functions
+bool     alarmOnOff = false;
+uint64_t timeDifference = 0;
+bool     timeDiffUp = false;
+bool snoozeRunning() { return false; }
+bool tempInCelsius() { return false; }
+bool gpsHaveFix() { return false; }
+int  gpsGetDM() { return 0; }
+int  daysInMonth(int month, int year) { return 31; }
+uint16_t loadClockState(int16_t& yoffs) { return 0; }
+bool saveClockState(uint16_t curYear, int16_t yearoffset) { return true; }
+void getClockDataP(uint64_t& timeDifference, bool &timeDiffUp) { }
+dateStruct *getClockDataDL(unsigned int did, int slot) { return NULL; }
+void updateClockDataP() { }
+bool saveClockDataP(bool force) { return true; }
+void updateClockDataDL(unsigned int did, int slot, uint16_t year, uint8_t month, uint8_t day, uint8_t hour, uint8_t minute) { }
+bool saveClockDataDL(bool force, unsigned int did, uint16_t year, uint8_t month, uint8_t day, uint8_t hour, uint8_t minute) { return true; }
+
+// State the BTTFN code reads
+uint32_t csf = 0, sgf = 0, eef = 0;
+
+static int      timeTravelP0Speed = 0;
+static uint16_t timeTravelP0stalled = 0;
+static int      fakeSpeed = 0;
+static bool     bttfnRemStop = false;
+static int      bttfnRemoteSpeed = 0;
+static int      bttfnRemCurSpd = 0;
+static bool     bttfnRemOffSpd = false;
+
+int           doorSnd = 0, door2Snd = 0;
+uint32_t      doorFlags = 0, door2Flags = 0;
+unsigned long doorSndDelay = 0, doorSndNow = 0;
+unsigned long door2SndDelay = 0, door2SndNow = 0;
+
+static struct { int getSpeed() { return 42; } } myGPS;
+static struct { int16_t readLastTempT100() { return 2150; } } tempSens;
+static struct { int32_t readLux() { return 300; } } lightSens;
+
+tcdDisplay destinationTime(DISP_DEST, 0x71);
+tcdDisplay presentTime(DISP_PRES, 0x72);
+tcdDisplay departedTime(DISP_LAST, 0x74);
+
+void injectKeypadKey(char key, int kaction) { }
+void wifiRestartPSTimer() { }
+
+unsigned long millisNonZero()
+{
+    unsigned long now = millis();
+    return now ? now : 1;
+}
+
+static void bttfnMakeRemoteSpeedMaster(bool doit, bool isPwrMaster)
+{
+    if(isPwrMaster) csf |= CSF_RPM;
+    else            csf &= ~CSF_RPM;
+    if(doit)        csf |= CSF_RSM;
+    else            csf &= ~CSF_RSM;
+}
+
+#include "tc_bttfn.inc"
+
+#define LT_PERTYPE   2
+#define LT_ROUNDS  250
+#define LT_SYNCRNDS 30
+#define LT_MINDLY    5    // Simulated network delay (ms)
+#define LT_MAXDLY   45
+#define LT_QLEN     32
+#define LT_LATS   2048
+
+typedef struct {
+    uint8_t       buf[BTTF_PACKET_SIZE];
+    uint32_t      ip;
+    uint16_t      port;
+    unsigned long t;
+    unsigned long ms;
+} bttfnLTPkt;
+
+static unsigned long bttfnLTCurT;
+
+class bttfnLoopUDP : public UDP {
+  public:
+    bttfnLTPkt    in[LT_QLEN];
+    bttfnLTPkt    out[LT_QLEN];
+    int           inHead = 0, inCnt = 0, outCnt = 0;
+    bttfnLTPkt    cur;
+    int           curPos = 0;
+    uint32_t      outIP = 0;
+    uint16_t      outPort = 0;
+    int           outLen = 0;
+    uint8_t       outBuf[BTTF_PACKET_SIZE];
+
+    bool inject(const uint8_t *buf, uint32_t ip)
+    {
+        if(inCnt >= LT_QLEN) return false;
+        bttfnLTPkt *p = &in[(inHead + inCnt++) % LT_QLEN];
+        memcpy(p->buf, buf, BTTF_PACKET_SIZE);
+        p->ip = ip;
+        p->t = micros();
+        return true;
+    }
+
+    uint8_t begin(uint16_t port) { return 1; }
+    uint8_t beginMulticast(IPAddress ip, uint16_t port) { return 1; }
+    void stop() { }
+    int beginPacket(IPAddress ip, uint16_t port)
+    {
+        outIP = ip;
+        outPort = port;
+        outLen = 0;
+        return 1;
+    }
+    int beginPacket(const char *host, uint16_t port) { return 0; }
+    int endPacket()
+    {
+        HOST_CHECK(outLen == BTTF_PACKET_SIZE, "packet of %d bytes", outLen);
+        HOST_CHECK(outCnt < LT_QLEN, "more than %d packets sent", LT_QLEN);
+        if(outCnt < LT_QLEN) {
+            bttfnLTPkt *p = &out[outCnt++];
+            memcpy(p->buf, outBuf, BTTF_PACKET_SIZE);
+            p->ip = outIP;
+            p->port = outPort;
+            p->t = micros() - bttfnLTCurT;
+            p->ms = millis();
+        }
+        return 1;
+    }
+    size_t write(uint8_t c) { return write(&c, 1); }
+    size_t write(const uint8_t *buf, size_t size)
+    {
+        if(size > (size_t)(BTTF_PACKET_SIZE - outLen)) size = BTTF_PACKET_SIZE - outLen;
+        memcpy(outBuf + outLen, buf, size);
+        outLen += size;
+        return size;
+    }
+    int parsePacket()
+    {
+        if(!inCnt) return 0;
+        cur = in[inHead];
+        inHead = (inHead + 1) % LT_QLEN;
+        inCnt--;
+        curPos = 0;
+        bttfnLTCurT = cur.t;
+        return BTTF_PACKET_SIZE;
+    }
+    int available() { return BTTF_PACKET_SIZE - curPos; }
+    int read() { return (curPos < BTTF_PACKET_SIZE) ? cur.buf[curPos++] : -1; }
+    int read(unsigned char *buf, size_t len)
+    {
+        if(len > (size_t)available()) len = available();
+        memcpy(buf, cur.buf + curPos, len);
+        curPos += len;
+        return len;
+    }
+    int read(char *buf, size_t len) { return read((unsigned char *)buf, len); }
+    int peek() { return (curPos < BTTF_PACKET_SIZE) ? cur.buf[curPos] : -1; }
+    void flush() { }
+    IPAddress remoteIP() { return IPAddress(cur.ip); }
+    uint16_t remotePort() { return BTTF_DEFAULT_LOCAL_PORT; }
+};
+
+static bttfnLoopUDP ltUDP, ltMcUDP;
+
+static uint32_t bttfnLTLat[LT_LATS];
+static int32_t  bttfnLTOffs[LT_QLEN];
+static uint32_t bttfnLTT4[LT_QLEN], bttfnLTSer[LT_QLEN];
+static int      bttfnLTNumLat;
+
+// As bttfn_setup(), on the loopback sockets
+static void ltSetup(const char *hostName)
+{
+    hostNameHash = 0;
+    for(const unsigned char *s = (const unsigned char *)hostName; *s; ++s) {
+        hostNameHash = 37 * hostNameHash + tolower(*s);
+    }
+
+    bttfn_initClients();
+
+    tcdUDP = &ltUDP;
+    tcdmcUDP = &ltMcUDP;
+
+    memcpy(BTTFDataBuf, BTTFUDPHD, BTTF_PACKET_SIZE);
+    BTTFDataBuf[5] = BTTFN_NOT_DATA | 0x51;
+
+    do {
+        bttfnSessionID = esp_random() ^ esp_random() ^ esp_random();
+    } while(!bttfnSessionID);
+
+    bttfn_setup_sensors();
+    bttfnlastExpire = millis();
+}
+
+static uint32_t ltDelay()
+{
+    return LT_MINDLY + esp_random() % (LT_MAXDLY - LT_MINDLY + 1);
+}
+
+static uint32_t ltIP(int type, int num)
+{
+    // 10.88.<type>.<num+1> in network byte order
+    return 10 | (88 << 8) | (type << 16) | ((uint32_t)(num + 1) << 24);
+}
+
+static void ltMakePkt(uint8_t *buf, int type, int num, uint8_t cflags)
+{
+    memcpy(buf, BTTFUDPHD, BTTF_PACKET_SIZE);
+    buf[4] = BTTFN_VERSION | (cflags << 6);
+    SET32(buf, 6, esp_random());
+    sprintf((char *)buf + 10, "LT%d-%d", type, num);
+    buf[10+13] = type;
+}
+
+static void ltSend(bttfnLoopUDP *u, uint8_t *buf, uint32_t ip)
+{
+    buf[BTTF_PACKET_SIZE - 1] = bttfn_checksum(buf);
+    u->inject(buf, ip);
+}
+
+static void ltDrain()
+{
+    while(bttfn_loop(BNLP_SK_NOTDATA|BNLP_SK_EXPIRE)) { }
+}
+
+static int ltZero(const uint8_t *buf, int from, int to)
+{
+    for(int i = from; i < to; i++) {
+        if(buf[i]) return 1;
+    }
+    return 0;
+}
+
+// Check reply against request; returns bitmask of bad fields
+static uint32_t ltCheckReply(const uint8_t *req, const uint8_t *rep)
+{
+    uint32_t bad = 0;
+    uint8_t  rq = req[5], parm = req[24], tbuf[8], a = 0;
+
+    if(memcmp(rep, BTTFUDPHD, 4))                        bad |= 0x001;
+    if(rep[4] != (BTTFN_VERSION | 0x80))                 bad |= 0x002;
+    if(bttfn_checksum((uint8_t *)rep) != rep[BTTF_PACKET_SIZE - 1])
+                                                         bad |= 0x004;
+    if(memcmp(rep + 6, req + 6, 4))                      bad |= 0x008;
+
+    if(rq & 0x01) {
+        if(memcmp(rep + 10, bttfnDateBuf, 7) ||
+           rep[17] != (bttfnDateBuf[7] | bttfnData17))   bad |= 0x010;
+        if(parm & 0x80) {
+            destinationTime.getCompressed(&tbuf[0], a);
+            a <<= 2;
+            departedTime.getCompressed(&tbuf[4], a);
+            if(memcmp(rep + 32, tbuf, 8) ||
+               (rep[40] & 0x0f) != a)                    bad |= 0x020;
+        } else {
+            bad |= ltZero(rep, 32, 47) << 5;
+        }
+    } else {
+        bad |= ltZero(rep, 10, 18) << 4;
+        bad |= ltZero(rep, 32, 47) << 5;
+    }
+    if(!(rq & 0x02)) bad |= ltZero(rep, 18, 20) << 6;
+    if(!(rq & 0x04)) bad |= ltZero(rep, 20, 22) << 6;
+    if(!(rq & 0x08)) bad |= ltZero(rep, 22, 26) << 6;
+
+    if((rep[26] & 0x1f) != ((rq & 0x10) ? (csf & CSF_BTTFN_STATUS_MASK) : 0))
+                                                         bad |= 0x080;
+
+    if(rq & 0x20) {
+        _bttfnClient *c = NULL;
+        for(int i = 0; i < bttfnNumCli && (parm & 0x0f); i++) {
+            if(bttfnClient[bttfnOrder[i]].Type == (parm & 0x0f)) {
+                c = &bttfnClient[bttfnOrder[i]];
+                break;
+            }
+        }
+        if(c) {
+            if(!(rep[5] & 0x20) || memcmp(rep + 27, c->IP, 4)) bad |= 0x100;
+        } else if((rep[5] & 0x20) || ltZero(rep, 27, 31)) bad |= 0x100;
+    } else if(ltZero(rep, 27, 31))                       bad |= 0x100;
+
+    if((rep[5] & ~0x20) != (rq & ~0x20))                 bad |= 0x200;
+    if(rep[31] != 0xfd)                                  bad |= 0x400;
+
+    return bad;
+}
+
+static int ltCmpU32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+int main()
+{
+    static uint8_t reqs[LT_QLEN][BTTF_PACKET_SIZE];
+    uint32_t baseCSF;
+    uint8_t  buf[BTTF_PACKET_SIZE];
+    uint8_t  cflags[BTTFN_TYPE__MAX + 1][LT_PERTYPE];
+    int      numCli = LT_PERTYPE * BTTFN_TYPE__MAX;
+    int      maxOffsErr = 0;
+    int      numReqs = 0, cnt, i, j, k;
+    uint32_t fieldErr = 0;
+    unsigned long startUs, pollUs = 0;
+
+    host_srand();
+
+    sgf = SGF_UGPS|SGF_GPS2BTTFN|SGF_UTemp|SGF_TempCelsius|SGF_ULightSens;
+    baseCSF = csf;
+    destinationTime.setFromParms(1985, 10, 26, 1, 21);
+    presentTime.setFromParms(2026, 10, 18, 13, 7);
+    departedTime.setFromParms(1955, 11, 5, 6, 38);
+    // As the time loop fills it: 2026-10-18 13:07:42, Sunday
+    bttfnDateBuf[0] = 2026 & 0xff;
+    bttfnDateBuf[1] = 0;
+    bttfnDateBuf[2] = 10;
+    bttfnDateBuf[3] = 18;
+    bttfnDateBuf[4] = 13;
+    bttfnDateBuf[5] = 7;
+    bttfnDateBuf[6] = 42;
+    bttfnDateBuf[7] = 0;
+    bttfnData17 = 0x80;
+
+    ltSetup("timecircuits");
+
+    // Discover: Right hash gets reply and registers, wrong one is ignored
+    for(i = BTTFN_TYPE__MIN; i <= BTTFN_TYPE__MAX; i++) {
+        for(j = 0; j < LT_PERTYPE; j++) {
+            cflags[i][j] = esp_random() & 0x03;
+            ltMakePkt(buf, i, j, cflags[i][j]);
+            buf[5] = 0x80;
+            SET32(buf, 31, hostNameHash + 1);
+            ltSend(&ltMcUDP, buf, ltIP(i, j + 100));
+            SET32(buf, 31, hostNameHash);
+            ltSend(&ltMcUDP, buf, ltIP(i, j));
+            ltUDP.outCnt = 0;
+            ltDrain();
+            HOST_CHECK(ltUDP.outCnt == 1 && ltUDP.out[0].ip == ltIP(i, j) &&
+                       ltUDP.out[0].port == BTTF_DEFAULT_LOCAL_PORT,
+                "discover type %d #%d: %d replies", i, j, ltUDP.outCnt);
+            if(ltUDP.outCnt) {
+                uint32_t bad = ltCheckReply(buf, ltUDP.out[0].buf);
+                HOST_CHECK(!bad, "discover type %d #%d: bad fields 0x%03x", i, j, bad);
+            }
+        }
+    }
+    HOST_CHECK(bttfnNumCli == numCli, "discover: %d clients, expected %d", bttfnNumCli, numCli);
+
+    // Polls: All clients in one batch, random requests
+    for(k = 0; k < LT_ROUNDS; k++) {
+        cnt = 0;
+        for(i = BTTFN_TYPE__MIN; i <= BTTFN_TYPE__MAX; i++) {
+            for(j = 0; j < LT_PERTYPE && cnt < LT_QLEN; j++, cnt++) {
+                uint32_t r = esp_random();
+                ltMakePkt(reqs[cnt], i, j, cflags[i][j]);
+                reqs[cnt][5] = r & 0x3f;
+                reqs[cnt][24] = ((r >> 8) % (BTTFN_TYPE__MAX + 1)) | ((r >> 16) & 0x80);
+                ltSend(&ltUDP, reqs[cnt], ltIP(i, j));
+            }
+        }
+        ltUDP.outCnt = 0;
+        startUs = micros();
+        ltDrain();
+        pollUs += micros() - startUs;
+        numReqs += cnt;
+        HOST_CHECK(ltUDP.outCnt == cnt, "poll round %d: %d replies to %d requests", k, ltUDP.outCnt, cnt);
+        if(ltUDP.outCnt != cnt) continue;
+        for(i = 0; i < cnt; i++) {
+            fieldErr |= ltCheckReply(reqs[i], ltUDP.out[i].buf);
+            if(bttfnLTNumLat < LT_LATS) {
+                bttfnLTLat[bttfnLTNumLat++] = ltUDP.out[i].t;
+            }
+        }
+    }
+    HOST_CHECK(!fieldErr, "poll: bad fields 0x%03x", fieldErr);
+    HOST_CHECK(bttfnNumCli == numCli, "poll: %d clients, expected %d", bttfnNumCli, numCli);
+
+    // Clock sync: Random client clocks, random delay each way. The
+    // offset error is half the delay asymmetry of the exchange used.
+    for(i = 0; i < numCli; i++) {
+        bttfnLTOffs[i] = esp_random();
+        bttfnLTT4[i] = bttfnLTSer[i] = 0;
+    }
+    for(k = 0; k < LT_SYNCRNDS; k++) {
+        cnt = 0;
+        for(i = BTTFN_TYPE__MIN; i <= BTTFN_TYPE__MAX; i++) {
+            for(j = 0; j < LT_PERTYPE; j++, cnt++) {
+                ltMakePkt(buf, i, j, cflags[i][j]);
+                buf[5] = 0x01;
+                buf[24] = 0x10;
+                SET32(buf, 6, millis() + bttfnLTOffs[cnt] - ltDelay());
+                SET32(buf, 39, bttfnLTT4[cnt]);
+                SET32(buf, 43, bttfnLTSer[cnt]);
+                ltSend(&ltUDP, buf, ltIP(i, j));
+            }
+        }
+        ltUDP.outCnt = 0;
+        ltDrain();
+        HOST_CHECK(ltUDP.outCnt == cnt, "sync round %d: %d replies to %d requests", k, ltUDP.outCnt, cnt);
+        for(i = 0; i < ltUDP.outCnt; i++) {
+            bttfnLTSer[i] = GET32(ltUDP.out[i].buf, 6);
+            bttfnLTT4[i] = ltUDP.out[i].ms + bttfnLTOffs[i] + ltDelay();
+        }
+    }
+    cnt = 0;
+    for(i = BTTFN_TYPE__MIN; i <= BTTFN_TYPE__MAX; i++) {
+        for(j = 0; j < LT_PERTYPE; j++, cnt++) {
+            _bttfnClient *c = bttfn_findClient(ltIP(i, j));
+            HOST_CHECK(c && bttfn_syncValid(c), "sync type %d #%d: no valid offset", i, j);
+            if(!c || !bttfn_syncValid(c)) continue;
+            int e = abs((int32_t)((uint32_t)c->Offset - (uint32_t)bttfnLTOffs[cnt]));
+            if(e > maxOffsErr) maxOffsErr = e;
+            // +1 for ms granularity
+            HOST_CHECK(e <= (LT_MAXDLY - LT_MINDLY) / 2 + 1, "sync type %d #%d: offset off by %d ms", i, j, e);
+        }
+    }
+
+    // Scheduled event: Unicast, in each client's time
+    {
+        unsigned long execAt = millis() + 1000;
+        ltUDP.outCnt = 0;
+        bttfn_notify(BTTFN_TYPE_ANY, BTTFN_NOT_TT, 1000, 0, 0, execAt);
+        HOST_CHECK(ltUDP.outCnt == bttfnNumCli, "event: %d packets for %d clients", ltUDP.outCnt, bttfnNumCli);
+        for(j = 0; j < ltUDP.outCnt; j++) {
+            uint8_t *b = ltUDP.out[j].buf;
+            _bttfnClient *c = bttfn_findClient(ltUDP.out[j].ip);
+            HOST_CHECK(c && b[5] == BTTFN_NOT_TT && b[16] == 0x01 &&
+                       (uint32_t)GET32(b, 12) == (uint32_t)(execAt + c->Offset) &&
+                       bttfn_checksum(b) == b[BTTF_PACKET_SIZE - 1],
+                "event: bad packet #%d", j);
+        }
+    }
+
+    // Sync expiry: First client misses its sync intervals, gets
+    // the event without execution time
+    {
+        _bttfnClient *x = &bttfnClient[bttfnOrder[0]];
+        x->SyncLast = millis() - BTTFN_SYNC_MAXMISS * x->SyncIntv - 1;
+        ltUDP.outCnt = 0;
+        bttfn_notify(BTTFN_TYPE_ANY, BTTFN_NOT_TT, 1000, 0, 0, millis() + 1000);
+        HOST_CHECK(ltUDP.outCnt == bttfnNumCli, "sync expiry: %d packets for %d clients", ltUDP.outCnt, bttfnNumCli);
+        for(j = 0; j < ltUDP.outCnt; j++) {
+            uint8_t *b = ltUDP.out[j].buf;
+            bool expired = (ltUDP.out[j].ip == x->IP32);
+            HOST_CHECK(b[16] == (expired ? 0 : 0x01) && !(expired && GET32(b, 12)),
+                "sync expiry: bad packet #%d", j);
+        }
+        HOST_CHECK(!x->SyncCnt, "sync expiry: sync count %d", x->SyncCnt);
+    }
+
+    #ifdef TC_HAVE_REMOTE
+    // Remote commands: Registration, sequence, foreign remote, unregister
+    {
+        uint32_t remID = esp_random() | 1;
+        uint32_t ip = ltIP(BTTFN_TYPE_REMOTE, 0);
+        uint8_t  cmds[][4] = {
+            { BTTFN_REMCMD_PING,     1,  0,    0 },
+            { BTTFN_REMCMD_COMBINED, 5,  0,   20 },
+            { BTTFN_REMCMD_COMBINED, 4,  0,   30 },   // out of sequence
+            { BTTFN_REMCMD_COMBINED, 6,  0, 0x80 },   // stopped
+        };
+        int spds[] = { 0, 20, 20, 0 };
+
+        removeRemote();
+        csf |= CSF_REMALLOW;
+        ltUDP.outCnt = 0;
+        for(i = 0; i < 4; i++) {
+            ltMakePkt(buf, BTTFN_TYPE_REMOTE, 0, 0);
+            SET32(buf, 6, cmds[i][1]);
+            buf[25] = cmds[i][0];
+            buf[26] = cmds[i][2];
+            buf[27] = cmds[i][3];
+            SET32(buf, 35, remID);
+            ltSend(&ltUDP, buf, ip);
+            ltDrain();
+            HOST_CHECK(registeredRemID == remID && bttfnRemoteSpeed == spds[i],
+                "remote command %d: id %08x speed %d", i, registeredRemID, bttfnRemoteSpeed);
+        }
+        // Another remote must be refused
+        ltMakePkt(buf, BTTFN_TYPE_REMOTE, 1, 0);
+        SET32(buf, 6, 7);
+        buf[25] = BTTFN_REMCMD_COMBINED;
+        buf[27] = 40;
+        SET32(buf, 35, remID + 1);
+        ltSend(&ltUDP, buf, ltIP(BTTFN_TYPE_REMOTE, 1));
+        ltDrain();
+        HOST_CHECK(registeredRemID == remID && !bttfnRemoteSpeed, "remote: foreign remote accepted");
+        // Unregister
+        ltMakePkt(buf, BTTFN_TYPE_REMOTE, 0, 0);
+        SET32(buf, 6, 8);
+        buf[25] = BTTFN_REMCMD_BYE;
+        SET32(buf, 35, remID);
+        ltSend(&ltUDP, buf, ip);
+        ltDrain();
+        HOST_CHECK(!registeredRemID, "remote: still registered after BYE");
+        // Commands never get a reply
+        HOST_CHECK(!ltUDP.outCnt, "remote: %d replies to commands", ltUDP.outCnt);
+        removeRemote();
+        csf = baseCSF;
+    }
+    #endif
+
+    // Notifications: Targeted ones go to clients of that type only,
+    // others by multicast unless a client does not support it.
+    for(i = BTTFN_TYPE_ANY; i <= BTTFN_TYPE__MAX; i++) {
+        int exp = 0;
+        for(j = 0; j < bttfnNumCli; j++) {
+            if(!i || bttfnClient[bttfnOrder[j]].Type == i) exp++;
+        }
+        if(!i && !bttfnNotAllSupportMC) exp = 1;
+        ltUDP.outCnt = 0;
+        bttfn_notify(i, BTTFN_NOT_INFO, 0x1234, 0x5678, 0x9abc);
+        HOST_CHECK(ltUDP.outCnt == exp, "notify type %d: %d packets, expected %d", i, ltUDP.outCnt, exp);
+        for(j = 0; j < ltUDP.outCnt; j++) {
+            uint8_t *b = ltUDP.out[j].buf;
+            HOST_CHECK(!memcmp(b, BTTFUDPHD, 5) && b[5] == BTTFN_NOT_INFO &&
+                       GET32(b, 6) == 0x56781234 && b[10] == 0xbc && b[11] == 0x9a &&
+                       bttfn_checksum(b) == b[BTTF_PACKET_SIZE - 1],
+                "notify type %d: bad packet #%d", i, j);
+            if(exp == 1 && !i) {
+                HOST_CHECK(ltUDP.out[j].ip == (uint32_t)bttfnMcIP &&
+                           ltUDP.out[j].port == BTTF_DEFAULT_LOCAL_PORT + 2,
+                    "notify type %d: not sent by multicast", i);
+            } else {
+                HOST_CHECK(bttfn_findClient(ltUDP.out[j].ip), "notify type %d: sent to unknown client", i);
+            }
+        }
+    }
+
+    // Expiry: Age the older half of the clients
+    cnt = bttfnNumCli / 2;
+    for(i = bttfnLRUHead, j = 0; j < cnt; i = bttfnClient[i].next, j++) {
+        bttfnClient[i].ALIVE -= 6*60*1000;
+    }
+    bttfnlastExpire = millis() - 60*1000;
+    k = bttfnNumCli - cnt;
+    bttfn_expire_clients();
+    HOST_CHECK(bttfnNumCli == k && bttfnHaveClients == k,
+        "expiry: %d clients left, expected %d", bttfnNumCli, k);
+    for(i = bttfnLRUHead; i != BTTFN_NIL; i = bttfnClient[i].next) {
+        HOST_CHECK(millis() - bttfnClient[i].ALIVE <= 5*60*1000, "expiry: expired client %d kept", i);
+    }
+
+    // Full registry: Newcomer only replaces an expired client
+    for(i = 0; bttfnNumCli < BTTFN_MAX_CLIENTS; i++) {
+        ltMakePkt(buf, BTTFN_TYPE_AUX, 0, 0);
+        ltSend(&ltUDP, buf, ltIP(BTTFN_TYPE__MAX + 1, i));
+        ltDrain();
+    }
+    ltMakePkt(buf, BTTFN_TYPE_AUX, 0, 0);
+    ltSend(&ltUDP, buf, ltIP(BTTFN_TYPE__MAX + 2, 0));
+    ltDrain();
+    HOST_CHECK(!bttfn_findClient(ltIP(BTTFN_TYPE__MAX + 2, 0)), "full registry: newcomer accepted");
+    bttfnClient[bttfnLRUHead].ALIVE -= 6*60*1000;
+    ltSend(&ltUDP, buf, ltIP(BTTFN_TYPE__MAX + 2, 0));
+    ltDrain();
+    HOST_CHECK(bttfn_findClient(ltIP(BTTFN_TYPE__MAX + 2, 0)) && bttfnNumCli == BTTFN_MAX_CLIENTS,
+        "full registry: newcomer did not replace expired client");
+
+    // NOT_DATA: First one, none without change, then a status change
+    // and back; all with changed-fields mask
+    bttfn_initClients();
+    ltMakePkt(buf, BTTFN_TYPE_FLUX, 0, 0x01);
+    buf[5] = 0x01;
+    buf[24] = 0x20;
+    ltSend(&ltUDP, buf, ltIP(BTTFN_TYPE_FLUX, 0));
+    ltDrain();
+    bttfnLastDataNot = 0;
+    for(k = 0; k < 4; k++) {
+        if(k == 2) csf ^= CSF_NM;
+        if(k == 3) csf = baseCSF;
+        ltUDP.outCnt = 0;
+        bttfnLastDataCheck = millis() - BTTFN_ND_CHECK;
+        bttfn_notify_data();
+        HOST_CHECK(ltUDP.outCnt == ((k == 1) ? 0 : 1), "NOT_DATA #%d: %d packets", k, ltUDP.outCnt);
+        if(ltUDP.outCnt == 1) {
+            uint8_t *b = ltUDP.out[0].buf;
+            // No speed in NOT_DATA; mask marked valid in byte 40
+            HOST_CHECK(!(b[5] & 0x02) && (b[40] & BTTFN_NDC_VALID) &&
+                       (b[17] & 0x78) == ((k ? 0 : 0x38) | BTTFN_NDC_STAT) &&
+                       ltUDP.out[0].port == BTTF_DEFAULT_LOCAL_PORT + 2 &&
+                       bttfn_checksum(b) == b[BTTF_PACKET_SIZE - 1],
+                "NOT_DATA #%d: bad packet", k);
+        }
+    }
+
+    // Results
+    printf("%d clients, %d requests, %d req/s\n",
+        numCli, numReqs, (int)((uint64_t)numReqs * 1000000 / (pollUs ? pollUs : 1)));
+    if(bttfnLTNumLat) {
+        qsort(bttfnLTLat, bttfnLTNumLat, sizeof(uint32_t), ltCmpU32);
+        printf("latency (us) p50 %u p90 %u p99 %u max %u\n",
+            bttfnLTLat[bttfnLTNumLat / 2], bttfnLTLat[bttfnLTNumLat * 9 / 10],
+            bttfnLTLat[bttfnLTNumLat * 99 / 100], bttfnLTLat[bttfnLTNumLat - 1]);
+    }
+    printf("%u loop calls, max %u packets per call, budget hit %u/%u times\n",
+        bttfnStats.calls, bttfnStats.maxPerCall, bttfnStats.pktLimit, bttfnStats.timeLimit);
+    printf("clock sync max offset error %d ms\n", maxOffsErr);
+
+    return host_result("bttfn");
+}
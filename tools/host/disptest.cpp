@@ -0,0 +1,191 @@
+/*
+ * -------------------------------------------------------------------
+ * CircuitSetup.us Time Circuits Display
+ * (C) 2022-2026 Thomas Winischhofer (A10001986)
+ * https://github.com/realA10001986/Time-Circuits-Display
+ * https://tcd.out-a-ti.me
+ *
+ * Host test: Display shadow buffer (tcdDisplay) on a recording bus
+ *
+ * Two displays get the same random sequence of operations (date/
+ * time, text, direct fields, colon, held frames, animations). On
+ * the reference display, every transfer reports an error, so its
+ * shadow buffer is never valid and it always sends in full. The
+ * display RAM of both, rebuilt from the recorded transfers, must
+ * be identical after each operation; and bytes sent plus
+ * getI2CBytesSaved() must add up to what the reference sent.
+ * -------------------------------------------------------------------
+ * License: Modified MIT NON-AI
+ * (See timecircuits-A10001986/tc_main.cpp for full license text)
+ */
+
+#define HOST_SIMCLOCK
+#include "Arduino.h"
+#include "i2cbus.cpp"
+#include "tcddisplay.cpp"
+
+// Not used by the tested functions
+bool     alarmOnOff = false;
+uint64_t timeDifference = 0;
+bool     timeDiffUp = false;
+bool snoozeRunning() { return false; }
+bool tempInCelsius() { return false; }
+bool gpsHaveFix() { return false; }
+int  gpsGetDM() { return 0; }
+int  daysInMonth(int month, int year) { return 31; }
+uint16_t loadClockState(int16_t& yoffs) { return 0; }
+bool saveClockState(uint16_t curYear, int16_t yearoffset) { return true; }
+void getClockDataP(uint64_t& timeDifference, bool &timeDiffUp) { }
+dateStruct *getClockDataDL(unsigned int did, int slot) { return NULL; }
+void updateClockDataP() { }
+bool saveClockDataP(bool force) { return true; }
+void updateClockDataDL(unsigned int did, int slot, uint16_t year, uint8_t month, uint8_t day, uint8_t hour, uint8_t minute) { }
+bool saveClockDataDL(bool force, unsigned int did, uint16_t year, uint8_t month, uint8_t day, uint8_t hour, uint8_t minute) { return true; }
+
+#define ADDR_TEST   0x71
+#define ADDR_REF    0x72
+
+// HT16K33 display RAM, rebuilt from transfers
+struct dispModel {
+    uint8_t  addr;
+    uint8_t  ram[16];
+    uint64_t ramBytes;      // Sent to RAM, incl. RAM address byte
+};
+
+static dispModel model[2] = { { ADDR_TEST }, { ADDR_REF } };
+static int       logPos = 0;
+
+// Apply transfers recorded since last call
+static void replay()
+{
+    HOST_CHECK(hostWireLogLen - logPos <= HOST_WIRE_LOGLEN, "wire log overflow");
+
+    for(; logPos < hostWireLogLen; logPos++) {
+        hostWireXfer *x = &hostWireLog[logPos % HOST_WIRE_LOGLEN];
+        // RAM writes start with RAM address (0x00-0x0f);
+        // commands (oscillator, display, dimming) are above
+        if(x->isRead || !x->len || x->data[0] >= 0x10) continue;
+        for(int m = 0; m < 2; m++) {
+            if(model[m].addr != x->addr) continue;
+            HOST_CHECK(x->len <= HOST_WIRE_MAXDATA && x->data[0] + x->len - 1 <= 16,
+                "0x%02x: write of %d bytes at %d", x->addr, x->len - 1, x->data[0]);
+            memcpy(model[m].ram + x->data[0], x->data + 1, x->len - 1);
+            model[m].ramBytes += x->len;
+        }
+    }
+}
+
+static void randomText(char *buf)
+{
+    static const char chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789 -.";
+    int len = esp_random() % 14;
+
+    for(int i = 0; i < len; i++) {
+        buf[i] = chars[esp_random() % (sizeof(chars) - 1)];
+    }
+    buf[len] = 0;
+}
+
+static const char *opName[] = {
+    "show", "showText", "directFields", "colon", "frame", "anim", "onoff"
+};
+
+// Same operation on both displays
+static int randomOp(tcdDisplay *d[2])
+{
+    int op = esp_random() % 7;
+    int year = esp_random() % 10000, month = 1 + esp_random() % 12, day = 1 + esp_random() % 28;
+    int hour = esp_random() % 24, minute = esp_random() % 60;
+    bool col = esp_random() & 1;
+    uint16_t flags = esp_random() & (CDT_CLEAR|CDT_COLON|CDT_YRDOT);
+    char text[16];
+
+    randomText(text);
+
+    for(int i = 0; i < 2; i++) {
+        switch(op) {
+        case 0:
+            d[i]->setFromParms(year, month, day, hour, minute);
+            d[i]->setColon(col);
+            d[i]->show();
+            break;
+        case 1:
+            d[i]->showTextDirect(text, flags);
+            break;
+        case 2:
+            d[i]->showMonthDirect(month);
+            d[i]->showDayDirect(day);
+            d[i]->showYearDirect(year);
+            d[i]->showHourDirect(hour);
+            d[i]->showMinuteDirect(minute);
+            break;
+        case 3:
+            d[i]->setColon(col);
+            d[i]->show();
+            break;
+        case 4:
+            d[i]->holdFrame();
+            d[i]->setFromParms(year, month, day, hour, minute);
+            d[i]->show();
+            d[i]->showTextDirect(text, flags);
+            d[i]->flushFrame();
+            break;
+        case 5:
+            d[i]->setFromParms(year, month, day, hour, minute);
+            d[i]->startAnim(tcdAnimDate);
+            while(d[i]->animRunning()) {
+                host_simUs += 10000;
+                d[i]->animLoop();
+            }
+            break;
+        case 6:
+            d[i]->off();
+            d[i]->on();
+            break;
+        }
+    }
+
+    return op;
+}
+
+int main()
+{
+    tcdDisplay test(DISP_DEST, ADDR_TEST), ref(DISP_DEST, ADDR_REF);
+    tcdDisplay *d[2] = { &test, &ref };
+    int opCount[7] = { 0 };
+
+    host_srand();
+
+    hostWireErrAddr = ADDR_REF;
+    host_simUs = 1000000;
+
+    test.begin();
+    ref.begin();
+    replay();
+
+    for(int i = 0; i < 5000; i++) {
+        uint64_t sent = model[0].ramBytes, refSent = model[1].ramBytes;
+        uint32_t saved = test.getI2CBytesSaved();
+        int op = randomOp(d);
+
+        opCount[op]++;
+        replay();
+
+        HOST_CHECK(!memcmp(model[0].ram, model[1].ram, 16), "%s (#%d): display RAM differs", opName[op], i);
+        HOST_CHECK((model[0].ramBytes - sent) + (test.getI2CBytesSaved() - saved) == model[1].ramBytes - refSent,
+            "%s (#%d): %llu sent + %u saved, reference sent %llu", opName[op], i,
+            (unsigned long long)(model[0].ramBytes - sent), test.getI2CBytesSaved() - saved,
+            (unsigned long long)(model[1].ramBytes - refSent));
+        if(host_fails) break;
+    }
+
+    HOST_CHECK(ref.getI2CBytesSaved() == 0, "reference saved %u bytes", ref.getI2CBytesSaved());
+
+    for(int i = 0; i < 7; i++) printf("%s %d, ", opName[i], opCount[i]);
+    printf("\n");
+    printf("RAM bytes: %llu sent, %u saved; reference %llu sent (%.0f%% saved)\n",
+        (unsigned long long)model[0].ramBytes, test.getI2CBytesSaved(), (unsigned long long)model[1].ramBytes,
+        model[1].ramBytes ? test.getI2CBytesSaved() * 100.0 / model[1].ramBytes : 0.0);
+
+    return host_result("disp");
+}
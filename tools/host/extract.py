@@ -0,0 +1,83 @@
+#!/usr/bin/env python3
+#
+# Time Circuits Display
+# (C) 2022-2026 Thomas Winischhofer (A10001986)
+#
+# Copy regions of a firmware source file into an include file for
+# the host test programs, so these compile the very code that runs
+# on the device.
+#
+# Usage: python3 tools/host/extract.py <src> <out> <start> <end> [<start> <end> ...]
+#
+# <start> and <end> are regular expressions matched against single
+# lines. A region starts at the first line matching <start> and ends
+# before the next line matching <end>; prefix <end> with '+' to
+# include that line. If a matching line is part of a comment block
+# (" * ..."), the region boundary moves up to the line opening that
+# comment, so leading comments stay with their code.
+#
+# Fails if a region is not found, so the build breaks instead of
+# silently testing nothing when the firmware source is reorganized.
+
+import os
+import re
+import sys
+
+
+def comment_start(lines, i):
+    if not lines[i].startswith(" *"):
+        return i
+    j = i
+    while j > 0 and not lines[j].startswith("/*"):
+        j -= 1
+    return j
+
+
+def main():
+    if len(sys.argv) < 5 or (len(sys.argv) - 3) % 2:
+        sys.exit("usage: extract.py <src> <out> <start> <end> [<start> <end> ...]")
+
+    src, out = sys.argv[1], sys.argv[2]
+    with open(src, encoding="utf-8", errors="replace") as f:
+        lines = f.read().split("\n")
+
+    res = ["// Generated by tools/host/extract.py from %s - do not edit." % os.path.basename(src)]
+    for k in range(3, len(sys.argv), 2):
+        sre, ere = sys.argv[k], sys.argv[k + 1]
+        incl = ere.startswith("+")
+        if incl:
+            ere = ere[1:]
+        sp, ep = re.compile(sre), re.compile(ere)
+
+        s = next((i for i in range(len(lines)) if sp.search(lines[i])), None)
+        if s is None:
+            sys.exit("%s: start '%s' not found" % (src, sre))
+        e = next((i for i in range(s if incl else s + 1, len(lines)) if ep.search(lines[i])), None)
+        if e is None:
+            sys.exit("%s: end '%s' not found" % (src, ere))
+
+        b = comment_start(lines, s)
+        if incl:
+            e += 1
+        else:
+            e = comment_start(lines, e)
+
+        res.append('#line %d "%s"' % (b + 1, os.path.abspath(src)))
+        res.extend(lines[b:e])
+
+    data = "\n".join(res) + "\n"
+
+    # Keep timestamp if unchanged to avoid needless rebuilds
+    try:
+        with open(out, encoding="utf-8") as f:
+            if f.read() == data:
+                return
+    except OSError:
+        pass
+
+    with open(out, "w", encoding="utf-8") as f:
+        f.write(data)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,101 @@
+/*
+ * -------------------------------------------------------------------
+ * CircuitSetup.us Time Circuits Display
+ * (C) 2022-2026 Thomas Winischhofer (A10001986)
+ * https://github.com/realA10001986/Time-Circuits-Display
+ * https://tcd.out-a-ti.me
+ *
+ * Host test support: Minimal stand-ins for the Arduino/ESP32 bits
+ * used by the firmware code extracted by extract.py
+ * -------------------------------------------------------------------
+ * License: Modified MIT NON-AI
+ * (See timecircuits-A10001986/tc_main.cpp for full license text)
+ */
+
+#ifndef _TC_HOST_H
+#define _TC_HOST_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+
+typedef uint8_t byte;
+
+class hostSerial {
+    public:
+        int printf(const char *fmt, ...) __attribute__((format(printf, 2, 3)))
+        {
+            va_list ap;
+            va_start(ap, fmt);
+            int r = vprintf(fmt, ap);
+            va_end(ap);
+            return r;
+        }
+};
+static hostSerial Serial;
+
+static inline uint64_t host_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+#ifdef HOST_SIMCLOCK
+// Simulated time, advanced by the test (and the simulated bus)
+static uint64_t host_simUs = 0;
+static inline unsigned long micros() { return (unsigned long)host_simUs; }
+static inline unsigned long millis() { return (unsigned long)(host_simUs / 1000); }
+#else
+static inline unsigned long micros() { return (unsigned long)(host_ns() / 1000); }
+static inline unsigned long millis() { return (unsigned long)(host_ns() / 1000000); }
+#endif
+
+// Reproducible "random" numbers; seed from $TCD_SEED
+static uint32_t host_rseed = 0x2c9277b5;
+
+static inline void host_srand()
+{
+    const char *s = getenv("TCD_SEED");
+    if(s && *s) host_rseed = (uint32_t)strtoul(s, NULL, 0);
+    if(!host_rseed) host_rseed = 1;
+    printf("seed 0x%08x (set TCD_SEED to repeat)\n", host_rseed);
+}
+
+static inline uint32_t esp_random()
+{
+    // xorshift32
+    host_rseed ^= host_rseed << 13;
+    host_rseed ^= host_rseed >> 17;
+    host_rseed ^= host_rseed << 5;
+    return host_rseed;
+}
+
+#define HOST_CHECK(c, ...) \
+    do { \
+        if(!(c)) { \
+            if(++host_fails <= 20) { \
+                printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+                printf(__VA_ARGS__); \
+                printf("\n"); \
+            } \
+        } \
+    } while(0)
+
+static int host_fails = 0;
+
+static inline int host_result(const char *name)
+{
+    if(host_fails) {
+        printf("%s: %d failure(s)\n", name, host_fails);
+        return 1;
+    }
+    printf("%s: OK\n", name);
+    return 0;
+}
+
+#endif
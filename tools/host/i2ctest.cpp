@@ -0,0 +1,271 @@
+/*
+ * -------------------------------------------------------------------
+ * CircuitSetup.us Time Circuits Display
+ * (C) 2022-2026 Thomas Winischhofer (A10001986)
+ * https://github.com/realA10001986/Time-Circuits-Display
+ * https://tcd.out-a-ti.me
+ *
+ * Host test: I2C bus scheduling (tcI2CSched) on a simulated bus
+ *
+ * Keypad scans, display updates and the bulk jobs (GPS, temperature,
+ * light) talk to the simulated bus through tcI2CBus, in the order
+ * and with roughly the sizes the firmware uses:
+ * - main_loop() iterations with keypad input now and then
+ * - mydelay() rounds (slice per round)
+ * - a delay loop that does not start slices
+ * Checks that jobs are never run past their deadline (plus one
+ * round), not within budget while keypad input is in progress,
+ * never on top of an exhausted budget, and not ahead of a higher
+ * priority job waiting in the same slice; and that delay loops do
+ * not hold GPS reads until the deadline.
+ * -------------------------------------------------------------------
+ * License: Modified MIT NON-AI
+ * (See timecircuits-A10001986/tc_main.cpp for full license text)
+ */
+
+#define HOST_SIMCLOCK
+#include "Arduino.h"
+#include "i2cbus.cpp"
+
+#define BUDGET      3000
+
+enum { J_GPS = 0, J_TEMP, J_LIGHT, J_NUM };
+
+static const uint16_t deadline[J_NUM] = { 100, 2000, 1000 };
+static const uint32_t period[J_NUM]   = { 250, 2000, 3000 };     // ms
+static const char    *jobName[J_NUM]  = { "GPS", "temp", "light" };
+
+static uint64_t due[J_NUM];             // ms
+static bool     keyActive = false;
+
+// Per phase
+static uint32_t maxLate[J_NUM];
+static uint64_t sumLate[J_NUM];
+static uint32_t runs[J_NUM];
+
+// Per slice, for checks: Deferred jobs, bus time, jobs run
+static bool     sliceDeferred[J_NUM];
+static uint32_t sliceUs;
+static int      sliceJobs;
+
+static void newSliceShadow()
+{
+    memset(sliceDeferred, 0, sizeof(sliceDeferred));
+    sliceUs = 0;
+    sliceJobs = 0;
+}
+
+static void idle(uint32_t us)
+{
+    host_simUs += us;
+}
+
+static void keypadScan()
+{
+    unsigned long t0 = micros();
+
+    // Row/column reads through port expander
+    for(int i = 0; i < 2; i++) {
+        i2cBus.requestFrom(0x20, 1);
+        i2cBus.read();
+    }
+    sliceUs += micros() - t0;
+}
+
+static void displayWrite(int n)
+{
+    unsigned long t0 = micros();
+
+    for(int d = 0; d < n; d++) {
+        i2cBus.beginTransmission(0x70 + d);
+        i2cBus.write(0);
+        for(int i = 0; i < 16; i++) i2cBus.write(i);
+        i2cBus.endTransmission();
+    }
+    sliceUs += micros() - t0;
+}
+
+static void jobTraffic(int job)
+{
+    switch(job) {
+    case J_GPS:
+        // Command, then chunked reads with delays
+        i2cBus.beginTransmission(0x10);
+        for(int i = 0; i < 12; i++) i2cBus.write('$');
+        i2cBus.endTransmission();
+        for(int i = 0; i < 8; i++) {
+            i2cBus.requestFrom(0x10, 32);
+            idle(250);
+        }
+        break;
+    case J_TEMP:
+        i2cBus.beginTransmission(0x18);
+        i2cBus.write(5);
+        i2cBus.endTransmission();
+        i2cBus.requestFrom(0x18, 2);
+        break;
+    case J_LIGHT:
+        i2cBus.beginTransmission(0x29);
+        i2cBus.write(0xb4);
+        i2cBus.endTransmission();
+        i2cBus.requestFrom(0x29, 4);
+        idle(100);
+        break;
+    }
+}
+
+static void runJob(int job)
+{
+    uint64_t now = millis();
+    unsigned long late;
+
+    if(now < due[job]) return;
+    late = now - due[job];
+
+    const i2cJobStats *st = i2cSched.getJobStats(job);
+    uint32_t forcedBefore = st->forced, cost = st->cost;
+    uint32_t slices = i2cSched.getSlices();
+    bool higherWaits = false;
+
+    i2cSched.setForeground(keyActive);
+
+    bool granted = i2cSched.grant(job, late);
+
+    // Slice ended in grant() (I2CS_SLICE_MAX)
+    if(i2cSched.getSlices() != slices) newSliceShadow();
+
+    for(int i = 0; i < job; i++) {
+        if(sliceDeferred[i]) higherWaits = true;
+    }
+
+    if(!granted) {
+        sliceDeferred[job] = true;
+        return;
+    }
+
+    if(st->forced == forcedBefore) {
+        HOST_CHECK(!keyActive, "%s granted during keypad input, %lums late", jobName[job], late);
+        HOST_CHECK(!higherWaits, "%s granted while higher priority job waits", jobName[job]);
+        HOST_CHECK(!sliceJobs || sliceUs + cost <= BUDGET, "%s granted with %uus used, cost %uus",
+            jobName[job], sliceUs, cost);
+    }
+    HOST_CHECK(late < (unsigned long)deadline[job] + 25, "%s ran %lums late", jobName[job], late);
+
+    if(late > maxLate[job]) maxLate[job] = late;
+    sumLate[job] += late;
+    runs[job]++;
+
+    // Like i2cJobStart()/i2cJobDone()
+    unsigned long t0 = micros();
+    i2cSched.start(job);
+    jobTraffic(job);
+    i2cSched.done(job, micros() - t0);
+    sliceUs += micros() - t0;
+    sliceJobs++;
+
+    due[job] += period[job];
+}
+
+static void resetPhase()
+{
+    uint64_t now = millis();
+
+    for(int i = 0; i < J_NUM; i++) {
+        maxLate[i] = 0;
+        sumLate[i] = 0;
+        runs[i] = 0;
+        // Keep schedule, but do not start phase with a backlog
+        if(due[i] < now) due[i] = now;
+    }
+}
+
+static void printPhase(const char *name)
+{
+    printf("%s:", name);
+    for(int i = 0; i < J_NUM; i++) {
+        printf(" %s %u runs, late avg %.1f max %u ms;", jobName[i], runs[i],
+            runs[i] ? (double)sumLate[i] / runs[i] : 0.0, maxLate[i]);
+    }
+    printf("\n");
+}
+
+static void newSlice()
+{
+    i2cSched.newSlice();
+    newSliceShadow();
+}
+
+// time_loop(): Slice, keypad scan, bulk jobs, display flush at end
+static void mainLoop(uint32_t ms)
+{
+    uint64_t end = millis() + ms;
+    uint64_t keyUntil = 0, nextKey = millis() + 500 + esp_random() % 3000;
+    int lastSec = -1;
+
+    while(millis() < end) {
+        newSlice();
+        // Keypad input: Bursts of 0.2-2s, every 0.5-3.5s
+        if(millis() >= nextKey) {
+            keyUntil = millis() + 200 + esp_random() % 1800;
+            nextKey = keyUntil + 500 + esp_random() % 3000;
+        }
+        keyActive = (millis() < keyUntil);
+        keypadScan();
+        for(int j = 0; j < J_NUM; j++) runJob(j);
+        // Other work (audio, network, ...)
+        idle(1000 + esp_random() % 4000);
+        // Displays: Every second, or keypad echo
+        if((int)(millis() / 1000) != lastSec || (keyActive && !(esp_random() % 4))) {
+            lastSec = millis() / 1000;
+            displayWrite(3);
+        }
+    }
+    keyActive = false;
+}
+
+// mydelay(): Slice per round, display animation, GPS only
+static void delayLoop(uint32_t ms, bool slices)
+{
+    uint64_t end = millis() + ms;
+
+    while(millis() < end) {
+        if(slices) newSlice();
+        if(!(esp_random() % 3)) displayWrite(1);
+        runJob(J_GPS);
+        idle(2000 + esp_random() % 3000);
+    }
+}
+
+int main()
+{
+    host_srand();
+
+    i2cSched.begin(BUDGET);
+    for(int i = 0; i < J_NUM; i++) {
+        HOST_CHECK(i2cSched.addJob(deadline[i]) == i, "addJob %d", i);
+    }
+    host_simUs = 1000000;
+
+    resetPhase();
+    mainLoop(120000);
+    printPhase("main loop");
+
+    resetPhase();
+    delayLoop(30000, true);
+    printPhase("mydelay");
+    HOST_CHECK(maxLate[J_GPS] < deadline[J_GPS] / 2, "mydelay: GPS up to %ums late", maxLate[J_GPS]);
+
+    resetPhase();
+    delayLoop(30000, false);
+    printPhase("delay w/o slices");
+    HOST_CHECK(maxLate[J_GPS] < deadline[J_GPS] / 2, "delay loop: GPS up to %ums late", maxLate[J_GPS]);
+
+    for(int i = 0; i < J_NUM; i++) {
+        const i2cJobStats *s = i2cSched.getJobStats(i);
+        printf("%s: cost %uus, granted %u, forced %u, deferred %u (keypad) %u (budget)\n",
+            jobName[i], s->cost, s->granted, s->forced, s->deferFg, s->deferBudget);
+    }
+    printf("%u slices, %u over budget\n", i2cSched.getSlices(), i2cSched.getOverruns());
+
+    return host_result("i2c");
+}
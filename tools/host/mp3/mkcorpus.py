@@ -0,0 +1,62 @@
+#!/usr/bin/env python3
+#
+# Time Circuits Display
+# (C) 2022-2026 Thomas Winischhofer (A10001986)
+#
+# Build the MP3 test corpus for tools/host/mp3test from the sounds
+# in install/alt_sound: Short frame-aligned excerpts, one with an
+# ID3v2 tag, one damaged.
+#
+# Usage: python3 tools/host/mp3/mkcorpus.py
+#
+# Run mp3test with --update afterwards to refresh golden.txt.
+
+import os
+
+BITRATES = [0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320]
+RATES = [44100, 48000, 32000]
+
+here = os.path.dirname(os.path.abspath(__file__))
+snd = os.path.join(here, "..", "..", "..", "install", "alt_sound")
+
+
+def frames(data):
+    # MPEG-1 Layer III only, as in install/alt_sound
+    res, p = [], 0
+    while p + 4 <= len(data):
+        h = data[p:p + 4]
+        if h[0] != 0xff or (h[1] & 0xfe) != 0xfa:
+            raise ValueError("no frame at %d" % p)
+        br = BITRATES[h[2] >> 4] * 1000
+        sr = RATES[(h[2] >> 2) & 3]
+        n = 144 * br // sr + ((h[2] >> 1) & 1)
+        res.append(data[p:p + n])
+        p += n
+    return res
+
+
+def excerpt(name, first, count):
+    with open(os.path.join(snd, name), "rb") as f:
+        return b"".join(frames(f.read())[first:first + count])
+
+
+def id3v2(title, pad):
+    body = title.encode("latin-1")
+    fr = b"TIT2" + (len(body) + 1).to_bytes(4, "big") + b"\0\0" + b"\0" + body
+    size = len(fr) + pad
+    ss = bytes([(size >> 21) & 0x7f, (size >> 14) & 0x7f, (size >> 7) & 0x7f, size & 0x7f])
+    return b"ID3\x03\x00\x00" + ss + fr + b"\0" * pad
+
+
+def write(name, data):
+    with open(os.path.join(here, name), "wb") as f:
+        f.write(data)
+    print("%s: %d bytes" % (name, len(data)))
+
+
+write("jstereo.mp3", excerpt("hour.mp3", 20, 50))
+write("mono.mp3", excerpt("ha-alert.mp3", 10, 50))
+write("id3.mp3", id3v2("Time Circuits", 300) + excerpt("ttcancel.mp3", 0, 40))
+
+d = excerpt("alarm.mp3", 0, 50)
+write("damaged.mp3", d[:8000] + bytes((i * 37) & 0xff for i in range(200)) + d[8000:-150])
@@ -0,0 +1,388 @@
+/*
+ * -------------------------------------------------------------------
+ * CircuitSetup.us Time Circuits Display
+ * (C) 2022-2026 Thomas Winischhofer (A10001986)
+ * https://github.com/realA10001986/Time-Circuits-Display
+ * https://tcd.out-a-ti.me
+ *
+ * Host test: MP3 decoder (libmad through AudioGeneratorMP3)
+ *
+ * Decodes each file from a stdio file source
+ * - into a null sink, stereo and mono (SetMono); checks PCM
+ *   checksums against golden values
+ * - into a stub I2S sink modelled after AudioOutputI2S (gain and
+ *   packing, non-blocking writes into a limited DMA queue), once
+ *   through ConsumeSample() per frame and once through the block
+ *   ConsumeSamples(); both must yield the same PCM
+ * - gapless into the next file (SetNextSource, as the music
+ *   player does); after the first frame of the next file, the
+ *   PCM must be the same as when decoding that file alone
+ * and reports frames/s, time per stage (input/decode/synth), the
+ * cost of mono relative to stereo output, and output path speed.
+ *
+ * Usage: mp3test [--update] <golden.txt> <file.mp3> ...
+ * --update rewrites golden.txt from the current decoder.
+ * -------------------------------------------------------------------
+ * License: Modified MIT NON-AI
+ * (See timecircuits-A10001986/tc_main.cpp for full license text)
+ */
+
+#include <Arduino.h>
+#include "src/ESP8266Audio/AudioGeneratorMP3.h"
+
+static uint32_t crcTab[256];
+
+static void crcInit()
+{
+    for(uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+        for(int k = 0; k < 8; k++) c = (c & 1) ? 0xedb88320 ^ (c >> 1) : c >> 1;
+        crcTab[i] = c;
+    }
+}
+
+static inline uint32_t crcSample(uint32_t crc, int16_t s)
+{
+    crc = crcTab[(crc ^ s) & 0xff] ^ (crc >> 8);
+    return crcTab[(crc ^ (s >> 8)) & 0xff] ^ (crc >> 8);
+}
+
+class hostFileSource : public AudioFileSource
+{
+    public:
+        hostFileSource(const char *name) { open(name); }
+        virtual ~hostFileSource() override { close(); }
+        virtual bool open(const char *name) override
+        {
+            f = fopen(name, "rb");
+            if(!f) return false;
+            fseek(f, 0, SEEK_END);
+            size = ftell(f);
+            fseek(f, 0, SEEK_SET);
+            return true;
+        }
+        virtual uint32_t read(void *data, uint32_t len) override { return f ? fread(data, 1, len, f) : 0; }
+        virtual bool seek(int32_t pos, int dir) override { return f && !fseek(f, pos, dir); }
+        virtual bool close() override { if(f) fclose(f); f = NULL; return true; }
+        virtual bool isOpen() override { return f != NULL; }
+        virtual uint32_t getSize() override { return size; }
+        virtual uint32_t getPos() override { return f ? ftell(f) : 0; }
+    private:
+        FILE *f = NULL;
+        uint32_t size = 0;
+};
+
+// Takes everything
+class nullSink : public AudioOutput
+{
+    public:
+        virtual bool begin() override { return true; }
+        virtual bool stop() override { return true; }
+        virtual uint16_t ConsumeSamples(const int16_t *sL, const int16_t *sR, int step, uint16_t count) override
+        {
+            for(uint16_t i = 0; i < count; i++, sL += step, sR += step) {
+                crc = crcSample(crc, *sL);
+                if(channels == 2) crc = crcSample(crc, *sR);
+                if(samples + i >= tailFrom) {
+                    tailCrc = crcSample(tailCrc, *sL);
+                    if(channels == 2) tailCrc = crcSample(tailCrc, *sR);
+                }
+            }
+            samples += count;
+            return count;
+        }
+        uint32_t crc = 0;
+        uint64_t samples = 0;
+        uint64_t tailFrom = ~0ULL;      // Separate crc from this sample on
+        uint32_t tailCrc = 0;
+        int chans() { return channels; }
+};
+
+// Stand-in for i2s_write() with timeout 0: Copies what fits into
+// a DMA queue of 8 * 64 frames
+static uint32_t i2sDMA[8 * 64];
+static uint32_t i2sFill = 0;
+
+__attribute__((noinline)) static void i2s_write_stub(const void *src, size_t size, size_t *written)
+{
+    size_t n = size / sizeof(uint32_t);
+
+    if(n > (sizeof(i2sDMA) / sizeof(uint32_t)) - i2sFill) n = (sizeof(i2sDMA) / sizeof(uint32_t)) - i2sFill;
+    memcpy(i2sDMA + i2sFill, src, n * sizeof(uint32_t));
+    i2sFill += n;
+    *written = n * sizeof(uint32_t);
+}
+
+// Like AudioOutputI2S (TWESP32). With block = false, only has
+// ConsumeSample(), so the generator's frames go through the base
+// class' per-frame loop, as before block output. loop() plays one
+// DMA buffer.
+class i2sStubSink : public nullSink
+{
+    public:
+        i2sStubSink(bool blk) : block(blk) { }
+        virtual bool begin() override { i2sFill = 0; SetGain(1.0); return true; }
+        virtual size_t ConsumeSample(int16_t sL, int16_t sR) override
+        {
+            uint32_t s32;
+            size_t written;
+            uint64_t t0 = host_ns();
+            AmplifyL(sL);
+            s32 = ((uint32_t)AmplifyR(sR)) | (sL & 0xffff);
+            i2s_write_stub(&s32, sizeof(uint32_t), &written);
+            if(written) nullSink::ConsumeSamples(&sL, &sR, 1, 1);
+            ns += host_ns() - t0;
+            return written;
+        }
+        virtual uint16_t ConsumeSamples(const int16_t *sL, const int16_t *sR, int step, uint16_t count) override
+        {
+            uint32_t blk[64];
+            uint16_t done = 0, n;
+            size_t written;
+
+            if(!block) return AudioOutput::ConsumeSamples(sL, sR, step, count);
+
+            uint64_t t0 = host_ns();
+            while(done < count) {
+                n = count - done;
+                if(n > 64) n = 64;
+                PackSamples(blk, sL, sR, step, n);
+                i2s_write_stub(blk, n * sizeof(uint32_t), &written);
+                written /= sizeof(uint32_t);
+                nullSink::ConsumeSamples(sL, sR, step, written);
+                done += written;
+                if(written < n) break;
+                sL += n * step;
+                sR += n * step;
+            }
+            ns += host_ns() - t0;
+
+            return done;
+        }
+        virtual bool loop() override
+        {
+            uint32_t n = (i2sFill > 64) ? 64 : i2sFill;
+            memmove(i2sDMA, i2sDMA + n, (i2sFill - n) * sizeof(uint32_t));
+            i2sFill -= n;
+            return true;
+        }
+        uint64_t ns = 0;
+    private:
+        bool block;
+};
+
+typedef struct {
+    uint32_t frames;
+    uint64_t samples;
+    uint32_t crc;
+    uint64_t ns;
+    AudioGeneratorMP3::Profile prof;
+} decodeResult;
+
+static bool decode(const char *name, bool mono, nullSink& sink, decodeResult& r)
+{
+    hostFileSource src(name);
+    AudioGeneratorMP3 mp3;
+    uint64_t t0;
+
+    if(!src.isOpen()) {
+        printf("%s: can't open\n", name);
+        return false;
+    }
+
+    AudioGeneratorMP3::resetProfile();
+    mp3.SetMono(mono);
+    if(!mp3.begin(&src, &sink)) {
+        printf("%s: begin() failed\n", name);
+        return false;
+    }
+
+    t0 = host_ns();
+    while(mp3.loop()) { }
+    r.ns = host_ns() - t0;
+    mp3.stop();
+
+    AudioGeneratorMP3::getProfile(&r.prof);
+    r.frames = r.prof.frames;
+    r.samples = sink.samples;
+    r.crc = sink.crc;
+
+    return true;
+}
+
+// Position at first frame, like readID3() in the firmware
+static void skipTag(hostFileSource& src)
+{
+    uint8_t h[10];
+    int32_t pos = 0;
+
+    if(src.read(h, 10) == 10 && !memcmp(h, "ID3", 3) && !(h[5] & 0x80)) {
+        pos = ((h[6] << 21) | (h[7] << 14) | (h[8] << 7) | h[9]) + 10;
+    }
+    src.seek(pos, SEEK_SET);
+}
+
+// Decode "name", then "next" through SetNextSource(); PCM of
+// "next" from its second frame on goes to sink.tailCrc
+static bool decodeGapless(const char *name, const char *next, uint32_t frames, nullSink& sink, decodeResult& r)
+{
+    hostFileSource src(name), nsrc(next);
+    AudioGeneratorMP3 mp3;
+
+    if(!src.isOpen() || !nsrc.isOpen()) return false;
+
+    skipTag(src);
+    skipTag(nsrc);
+
+    AudioGeneratorMP3::resetProfile();
+    sink.tailFrom = (uint64_t)(frames + 1) * 1152;
+    if(!mp3.begin(&src, &sink)) return false;
+    mp3.SetNextSource(&nsrc);
+
+    // Sink takes everything, so this is a single loop() call
+    while(mp3.loop()) { }
+    bool switched = mp3.SourceSwitched();
+    mp3.stop();
+
+    AudioGeneratorMP3::getProfile(&r.prof);
+    r.frames = r.prof.frames;
+    r.samples = sink.samples;
+    r.crc = sink.crc;
+
+    return switched;
+}
+
+static void printProfile(const char *what, decodeResult& r)
+{
+    uint32_t f = r.frames ? r.frames : 1;
+
+    printf("  %-7s %5u frames, %7.0f frames/s; per frame: input %5.0f ns, decode %6.0f ns, synth %6.0f ns\n",
+        what, r.frames, r.frames * 1e9 / (r.ns ? r.ns : 1),
+        (double)r.prof.input / f, (double)r.prof.decode / f, (double)r.prof.synth / f);
+}
+
+typedef struct {
+    char     name[64];
+    uint32_t frames;
+    uint32_t crcStereo;
+    uint32_t crcMono;
+} golden;
+
+int main(int argc, char **argv)
+{
+    static golden gold[64];
+    int  numGold = 0, arg = 1;
+    bool update = false;
+    uint64_t synthS = 0, synthM = 0, nsS = 0, nsM = 0;
+    uint64_t outP = 0, outB = 0, outS = 0;
+    FILE *f;
+
+    if(argc > 1 && !strcmp(argv[1], "--update")) {
+        update = true;
+        arg++;
+    }
+    if(argc - arg < 2) {
+        printf("Usage: %s [--update] <golden.txt> <file.mp3> ...\n", argv[0]);
+        return 2;
+    }
+
+    const char *goldName = argv[arg++];
+    if(!update && (f = fopen(goldName, "r"))) {
+        char line[160];
+        while(fgets(line, sizeof(line), f) && numGold < 64) {
+            golden *g = &gold[numGold];
+            if(line[0] == '#') continue;
+            if(sscanf(line, "%63s %u %x %x", g->name, &g->frames, &g->crcStereo, &g->crcMono) == 4) numGold++;
+        }
+        fclose(f);
+    }
+
+    crcInit();
+
+    if(update) {
+        if(!(f = fopen(goldName, "w"))) {
+            printf("Can't write %s\n", goldName);
+            return 1;
+        }
+        fprintf(f, "# Generated by mp3test --update: <file> <frames> <crc32 stereo> <crc32 mono>\n");
+    }
+
+    uint32_t prevFrames = 0;
+    const char *prevName = NULL;
+
+    for(int i = arg; i < argc; i++) {
+        const char *base = strrchr(argv[i], '/') ? strrchr(argv[i], '/') + 1 : argv[i];
+        decodeResult rs, rm, rp, rb, rg = { 0 };
+        nullSink ns, nm, ng, nt;
+        i2sStubSink ip(false), ib(true);
+
+        nt.tailFrom = 1152;
+        if(!decode(argv[i], false, nt, rs) || !decode(argv[i], false, ns, rs) || !decode(argv[i], true, nm, rm) ||
+           !decode(argv[i], false, ip, rp) || !decode(argv[i], false, ib, rb)) {
+            host_fails++;
+            prevName = NULL;
+            continue;
+        }
+
+        // Previous file, gapless into this one
+        if(prevName) {
+            HOST_CHECK(decodeGapless(prevName, argv[i], prevFrames, ng, rg), "%s: gapless switch failed", base);
+            HOST_CHECK(rg.frames == prevFrames + rs.frames, "%s: gapless: %u frames, expected %u + %u",
+                base, rg.frames, prevFrames, rs.frames);
+            HOST_CHECK(ng.tailCrc == nt.tailCrc, "%s: gapless: crc %08x after first frame, expected %08x",
+                base, ng.tailCrc, nt.tailCrc);
+        }
+        prevName = argv[i];
+        prevFrames = rs.frames;
+
+        printf("%s: %llu samples, crc %08x (stereo), %08x (mono)\n", base,
+            (unsigned long long)rs.samples, rs.crc, rm.crc);
+        printProfile("stereo", rs);
+        printProfile("mono", rm);
+        printf("  i2s stub output: %.1f Msamples/s per frame, %.1f Msamples/s block\n",
+            rp.samples * 1e3 / (ip.ns ? ip.ns : 1), rb.samples * 1e3 / (ib.ns ? ib.ns : 1));
+
+        HOST_CHECK(ns.chans() == 2 || ns.chans() == 1, "%s: %d channels", base, ns.chans());
+        HOST_CHECK(nm.chans() == 1, "%s: mono: %d channels", base, nm.chans());
+        HOST_CHECK(rs.samples == rm.samples, "%s: mono: %llu samples, stereo %llu", base,
+            (unsigned long long)rm.samples, (unsigned long long)rs.samples);
+        HOST_CHECK(rp.crc == rs.crc && rp.samples == rs.samples, "%s: i2s stub per frame: crc %08x, %llu samples",
+            base, rp.crc, (unsigned long long)rp.samples);
+        HOST_CHECK(rb.crc == rs.crc && rb.samples == rs.samples, "%s: i2s stub block: crc %08x, %llu samples",
+            base, rb.crc, (unsigned long long)rb.samples);
+        HOST_CHECK(rs.frames > 0 && rs.samples == (uint64_t)rs.frames * 1152, "%s: %u frames, %llu samples",
+            base, rs.frames, (unsigned long long)rs.samples);
+
+        synthS += rs.prof.synth; synthM += rm.prof.synth;
+        nsS += rs.ns; nsM += rm.ns;
+        outP += ip.ns; outB += ib.ns; outS += rs.samples;
+
+        if(update) {
+            fprintf(f, "%s %u %08x %08x\n", base, rs.frames, rs.crc, rm.crc);
+            continue;
+        }
+
+        golden *g = NULL;
+        for(int j = 0; j < numGold; j++) {
+            if(!strcmp(gold[j].name, base)) g = &gold[j];
+        }
+        HOST_CHECK(g, "%s: no golden values", base);
+        if(g) {
+            HOST_CHECK(g->frames == rs.frames, "%s: %u frames, expected %u", base, rs.frames, g->frames);
+            HOST_CHECK(g->crcStereo == rs.crc, "%s: stereo crc %08x, expected %08x", base, rs.crc, g->crcStereo);
+            HOST_CHECK(g->crcMono == rm.crc, "%s: mono crc %08x, expected %08x", base, rm.crc, g->crcMono);
+        }
+    }
+
+    if(update) {
+        fclose(f);
+        printf("%s written\n", goldName);
+    }
+
+    printf("mono vs stereo: synth %.0f%%, total %.0f%%\n",
+        synthS ? synthM * 100.0 / synthS : 0.0, nsS ? nsM * 100.0 / nsS : 0.0);
+    printf("i2s stub output: %.1f Msamples/s per frame, %.1f Msamples/s block\n",
+        outS * 1e3 / (outP ? outP : 1), outS * 1e3 / (outB ? outB : 1));
+
+    return host_result("mp3");
+}
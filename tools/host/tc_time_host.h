@@ -0,0 +1,52 @@
+/*
+ * -------------------------------------------------------------------
+ * CircuitSetup.us Time Circuits Display
+ * (C) 2022-2026 Thomas Winischhofer (A10001986)
+ * https://github.com/realA10001986/Time-Circuits-Display
+ * https://tcd.out-a-ti.me
+ *
+ * Host test support: Date/time and TZ code from tc_main.cpp
+ * -------------------------------------------------------------------
+ * License: Modified MIT NON-AI
+ * (See timecircuits-A10001986/tc_main.cpp for full license text)
+ */
+
+#ifndef _TC_TIME_HOST_H
+#define _TC_TIME_HOST_H
+
+#include "host.h"
+#include "rtc.h"
+
+#include "tcddisplay_h.inc"     // dateStruct
+
+#define write_settings()
+
+struct {
+    char timeZone[64]       = "";
+    char timeZoneDest[64]   = "";
+    char timeZoneDep[64]    = "";
+} settings;
+
+static bool hostMiniMode = false;
+bool isMiniMode() { return hostMiniMode; }
+
+void myrtcnow(DateTime& dt) { dt.set(2024, 1, 1); }
+
+// Receives the present time from updatePresentTime()
+class hostDisplay {
+    public:
+        void setDateTime(DateTime& dt, int wd = 0)
+        {
+            d.year = dt.year(); d.month = dt.month(); d.day = dt.day();
+            d.hour = dt.hour(); d.minute = dt.minute();
+        }
+        void setFromStruct(const dateStruct *s) { d = *s; }
+        dateStruct d;
+};
+static hostDisplay presentTime;
+
+#include "tc_main_h.inc"        // Prototypes
+#include "tc_tzdb.h"
+#include "tc_time.inc"          // The code under test
+
+#endif
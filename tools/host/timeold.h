@@ -0,0 +1,457 @@
+/*
+ * -------------------------------------------------------------------
+ * CircuitSetup.us Time Circuits Display
+ * (C) 2022-2026 Thomas Winischhofer (A10001986)
+ * https://github.com/realA10001986/Time-Circuits-Display
+ * https://tcd.out-a-ti.me
+ *
+ * Host test support: The year-by-year dateToMins()/minsToDate() 
+ * (and isLeapYear()) as they were before the closed-form versions,
+ * kept verbatim as reference for equivalence and speed.
+ * -------------------------------------------------------------------
+ * License: Modified MIT NON-AI
+ * (See timecircuits-A10001986/tc_main.cpp for full license text)
+ */
+
+#ifndef _TC_TIMEOLD_H
+#define _TC_TIMEOLD_H
+
+// Verbatim, warnings and all
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wsign-compare"
+
+namespace timeold {
+
+static const uint8_t monthDays[] =
+{
+    31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31
+};
+static const unsigned int mon_yday[2][13] =
+{
+    { 0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334, 365 },
+    { 0, 31, 60, 91, 121, 152, 182, 213, 244, 274, 305, 335, 366 }
+};
+static const unsigned int mon_ydayt24t60[2][13] =
+{
+    { 0, 31*24*60,  59*24*60,  90*24*60, 120*24*60, 151*24*60, 181*24*60, 
+        212*24*60, 243*24*60, 273*24*60, 304*24*60, 334*24*60, 365*24*60 },
+    { 0, 31*24*60,  60*24*60,  91*24*60, 121*24*60, 152*24*60, 182*24*60, 
+        213*24*60, 244*24*60, 274*24*60, 305*24*60, 335*24*60, 366*24*60 }
+};
+static const uint64_t mins1kYears[] =
+{
+#ifndef TC_JULIAN_CAL  
+             0,  262975680,  525949920,  788924160, 1051898400,
+    1314874080, 1577848320, 1840822560, 2103796800, 2366772480,
+    2629746720, 2892720960, 3155695200, 3418670880, 3681645120,
+    3944619360, 4207593600, 4470569280, 4733543520, 4996517760,
+    5259492000, 5522467680
+#elif !defined(JSWITCH_1582)
+             0,   52596000,  105192000,  157788000,  210384000, 
+     262980000,  315576000,  368172000,  420768000,  473364000, 
+     525960000,  578556000,  631152000,  683748000,  736344000, 
+     788940000,  841536000,  894132000,  946712160,  999306720, 
+    1051901280, 1104497280, 1157091840, 1209686400, 1262280960, 
+    1314876960, 1367471520, 1420066080, 1472660640, 1525256640, 
+    1577851200, 1630445760, 1683040320, 1735636320, 1788230880, 
+    1840825440, 1893420000, 1946016000, 1998610560, 2051205120, 
+    2103799680, 2156395680, 2208990240, 2261584800, 2314179360, 
+    2366775360, 2419369920, 2471964480, 2524559040, 2577155040, 
+    2629749600, 2682344160, 2734938720, 2787534720, 2840129280, 
+    2892723840, 2945318400, 2997914400, 3050508960, 3103103520, 
+    3155698080, 3208294080, 3260888640, 3313483200, 3366077760, 
+    3418673760, 3471268320, 3523862880, 3576457440, 3629053440, 
+    3681648000, 3734242560, 3786837120, 3839433120, 3892027680, 
+    3944622240, 3997216800, 4049812800, 4102407360, 4155001920, 
+    4207596480, 4260192480, 4312787040, 4365381600, 4417976160, 
+    4470572160, 4523166720, 4575761280, 4628355840, 4680951840, 
+    4733546400, 4786140960, 4838735520, 4891331520, 4943926080, 
+    4996520640, 5049115200, 5101711200, 5154305760, 5206900320,
+    5259494880, 5312090880, 5364685440, 5417280000, 5469874560, 
+    5522470560, 5575065120, 5627659680, 5680254240, 5732850240   
+#else
+             0,   52596000,  105192000,  157788000,  210384000, 
+     262980000,  315576000,  368172000,  420768000,  473364000, 
+     525960000,  578556000,  631152000,  683748000,  736344000, 
+     788940000,  841521600,  894117600,  946712160,  999306720, 
+    1051901280, 1104497280, 1157091840, 1209686400, 1262280960, 
+    1314876960, 1367471520, 1420066080, 1472660640, 1525256640, 
+    1577851200, 1630445760, 1683040320, 1735636320, 1788230880, 
+    1840825440, 1893420000, 1946016000, 1998610560, 2051205120, 
+    2103799680, 2156395680, 2208990240, 2261584800, 2314179360, 
+    2366775360, 2419369920, 2471964480, 2524559040, 2577155040, 
+    2629749600, 2682344160, 2734938720, 2787534720, 2840129280, 
+    2892723840, 2945318400, 2997914400, 3050508960, 3103103520, 
+    3155698080, 3208294080, 3260888640, 3313483200, 3366077760, 
+    3418673760, 3471268320, 3523862880, 3576457440, 3629053440, 
+    3681648000, 3734242560, 3786837120, 3839433120, 3892027680, 
+    3944622240, 3997216800, 4049812800, 4102407360, 4155001920, 
+    4207596480, 4260192480, 4312787040, 4365381600, 4417976160, 
+    4470572160, 4523166720, 4575761280, 4628355840, 4680951840, 
+    4733546400, 4786140960, 4838735520, 4891331520, 4943926080, 
+    4996520640, 5049115200, 5101711200, 5154305760, 5206900320,
+    5259494880, 5312090880, 5364685440, 5417280000, 5469874560, 
+    5522470560, 5575065120, 5627659680, 5680254240, 5732850240
+#endif    
+};
+
+static const uint32_t hours1kYears[] =
+{
+#ifndef TC_JULIAN_CAL
+                0,  262975680/60,  525949920/60,  788924160/60, 1051898400/60,
+    1314874080/60, 1577848320/60, 1840822560/60, 2103796800/60, 2366772480/60, 
+    2629746720/60, 2892720960/60, 3155695200/60, 3418670880/60, 3681645120/60, 
+    3944619360/60, 4207593600/60, 4470569280/60, 4733543520/60, 4996517760/60,
+    5259492000/60, 5522467680/60 
+#elif !defined(JSWITCH_1582)
+                0,   52596000/60,  105192000/60,  157788000/60,  210384000/60, 
+     262980000/60,  315576000/60,  368172000/60,  420768000/60,  473364000/60, 
+     525960000/60,  578556000/60,  631152000/60,  683748000/60,  736344000/60, 
+     788940000/60,  841536000/60,  894132000/60,  946712160/60,  999306720/60, 
+    1051901280/60, 1104497280/60, 1157091840/60, 1209686400/60, 1262280960/60, 
+    1314876960/60, 1367471520/60, 1420066080/60, 1472660640/60, 1525256640/60, 
+    1577851200/60, 1630445760/60, 1683040320/60, 1735636320/60, 1788230880/60, 
+    1840825440/60, 1893420000/60, 1946016000/60, 1998610560/60, 2051205120/60, 
+    2103799680/60, 2156395680/60, 2208990240/60, 2261584800/60, 2314179360/60, 
+    2366775360/60, 2419369920/60, 2471964480/60, 2524559040/60, 2577155040/60, 
+    2629749600/60, 2682344160/60, 2734938720/60, 2787534720/60, 2840129280/60, 
+    2892723840/60, 2945318400/60, 2997914400/60, 3050508960/60, 3103103520/60, 
+    3155698080/60, 3208294080/60, 3260888640/60, 3313483200/60, 3366077760/60, 
+    3418673760/60, 3471268320/60, 3523862880/60, 3576457440/60, 3629053440/60, 
+    3681648000/60, 3734242560/60, 3786837120/60, 3839433120/60, 3892027680/60, 
+    3944622240/60, 3997216800/60, 4049812800/60, 4102407360/60, 4155001920/60, 
+    4207596480/60, 4260192480/60, 4312787040/60, 4365381600/60, 4417976160/60, 
+    4470572160/60, 4523166720/60, 4575761280/60, 4628355840/60, 4680951840/60, 
+    4733546400/60, 4786140960/60, 4838735520/60, 4891331520/60, 4943926080/60, 
+    4996520640/60, 5049115200/60, 5101711200/60, 5154305760/60, 5206900320/60,
+    5259494880/60, 5312090880/60, 5364685440/60, 5417280000/60, 5469874560/60, 
+    5522470560/60, 5575065120/60, 5627659680/60, 5680254240/60, 5732850240/60
+#else
+             0/60,   52596000/60,  105192000/60,  157788000/60,  210384000/60, 
+     262980000/60,  315576000/60,  368172000/60,  420768000/60,  473364000/60, 
+     525960000/60,  578556000/60,  631152000/60,  683748000/60,  736344000/60, 
+     788940000/60,  841521600/60,  894117600/60,  946712160/60,  999306720/60, 
+    1051901280/60, 1104497280/60, 1157091840/60, 1209686400/60, 1262280960/60, 
+    1314876960/60, 1367471520/60, 1420066080/60, 1472660640/60, 1525256640/60, 
+    1577851200/60, 1630445760/60, 1683040320/60, 1735636320/60, 1788230880/60, 
+    1840825440/60, 1893420000/60, 1946016000/60, 1998610560/60, 2051205120/60, 
+    2103799680/60, 2156395680/60, 2208990240/60, 2261584800/60, 2314179360/60, 
+    2366775360/60, 2419369920/60, 2471964480/60, 2524559040/60, 2577155040/60, 
+    2629749600/60, 2682344160/60, 2734938720/60, 2787534720/60, 2840129280/60, 
+    2892723840/60, 2945318400/60, 2997914400/60, 3050508960/60, 3103103520/60, 
+    3155698080/60, 3208294080/60, 3260888640/60, 3313483200/60, 3366077760/60, 
+    3418673760/60, 3471268320/60, 3523862880/60, 3576457440/60, 3629053440/60, 
+    3681648000/60, 3734242560/60, 3786837120/60, 3839433120/60, 3892027680/60, 
+    3944622240/60, 3997216800/60, 4049812800/60, 4102407360/60, 4155001920/60, 
+    4207596480/60, 4260192480/60, 4312787040/60, 4365381600/60, 4417976160/60, 
+    4470572160/60, 4523166720/60, 4575761280/60, 4628355840/60, 4680951840/60, 
+    4733546400/60, 4786140960/60, 4838735520/60, 4891331520/60, 4943926080/60, 
+    4996520640/60, 5049115200/60, 5101711200/60, 5154305760/60, 5206900320/60,
+    5259494880/60, 5312090880/60, 5364685440/60, 5417280000/60, 5469874560/60, 
+    5522470560/60, 5575065120/60, 5627659680/60, 5680254240/60, 5732850240/60
+#endif    
+};
+
+#ifdef TC_JULIAN_CAL
+#ifndef JSWITCH_1582
+static const int jCentStart   = 1700;      // Start of century when switch took place
+static const int jCentEnd     = 1799;      // Last year of century when switch took place
+static const int jSwitchYear  = 1752;      // Year in which switch to Gregorian Cal took place
+static const int jSwitchMon   = 9;         // Month in which switch to Gregorian Cal took place
+static const int jSwitchDay   = 2;         // Last day of Julian Cal
+static const int jSwitchSkipD = 11;        // Number of days skipped
+static const int jSwitchSkipH = 11 * 24;   // Num hours skipped
+#else
+static const int jCentStart   = 1500;      // Start of century when switch took place
+static const int jCentEnd     = 1599;      // Last year of century when switch took place
+static const int jSwitchYear  = 1582;      // Year in which switch to Gregorian Cal took place
+static const int jSwitchMon   = 10;        // Month in which switch to Gregorian Cal took place
+static const int jSwitchDay   = 4;         // Last day of Julian Cal
+static const int jSwitchSkipD = 10;        // Number of days skipped
+static const int jSwitchSkipH = 10 * 24;   // Num hours skipped
+#endif
+static int mon_yday_jSwitch[13];     // Accumulated days per month in year of Switch
+static int mon_ydayt24t60J[13];      // Accumulated mins per month in year of Switch
+static int jSwitchYrHrs;
+static uint32_t jSwitchHash = 0;
+#endif
+
+/* 
+ * Determine if provided year is a leap year 
+ */
+#ifndef TC_JULIAN_CAL 
+bool isLeapYear(int year)
+{
+    if((year & 3) == 0) { 
+        if((year % 100) == 0) {
+            if((year % 400) == 0) {
+                return true;
+            } else {
+                return false;
+            }
+        } else {
+            return true;
+        }
+    } else {
+        return false;
+    }
+}
+#else
+bool isLeapYear(int year)
+{
+    if((year & 3) == 0) {
+        if((year > jSwitchYear) && ((year % 100) == 0)) {
+            if((year % 400) == 0) {
+                return true;
+            } else {
+                return false;
+            }
+        } else {
+            return true;
+        }
+    } else {
+        return false;
+    }
+}
+#endif
+
+/*
+ *  Convert a date into "minutes since 1/1/0 0:0"
+ */
+#ifndef TC_JULIAN_CAL 
+uint64_t dateToMins(int year, int month, int day, int hour, int minute)
+{
+    uint64_t total64 = 0;
+    uint32_t total32 = 0;
+    int c = year, d = 0;        // ny0: d=1
+
+    if(year < 11000) {
+        total32 = hours1kYears[year / 500];
+        if(total32) d = (year / 500) * 500;
+    } else {
+        total32 = hours1kYears[(sizeof(hours1kYears)/sizeof(hours1kYears[0]))-1];
+        d = ((sizeof(hours1kYears)/sizeof(hours1kYears[0]))-1) * 500;
+    }
+
+    while(c-- > d) {
+        total32 += (isLeapYear(c) ? (8760+24) : 8760);
+    }
+    total32 += (mon_yday[isLeapYear(year) ? 1 : 0][month - 1] * 24);
+    total32 += (day - 1) * 24;
+    total32 += hour;
+    total64 = (uint64_t)total32 * 60;
+    total64 += minute;
+    return total64;
+}
+#else
+uint64_t dateToMins(int year, int month, int day, int hour, int minute)
+{
+    uint64_t total64 = 0;
+    uint32_t total32 = 0;
+    int c = year, d = 0;        // ny0: d=1
+
+    if(year < 11000) {
+        total32 = hours1kYears[year / 100];
+        if(total32) d = (year / 100) * 100;
+    } else {
+        total32 = hours1kYears[(sizeof(hours1kYears)/sizeof(hours1kYears[0]))-1];
+        d = ((sizeof(hours1kYears)/sizeof(hours1kYears[0]))-1) * 100;
+    }
+
+    if(c < jCentStart || c > jCentEnd) {
+        while(c-- > d) {
+            total32 += (isLeapYear(c) ? (8760+24) : 8760);
+        }
+        total32 += (mon_yday[isLeapYear(year) ? 1 : 0][month - 1] * 24);
+        total32 += (day - 1) * 24;
+    } else {
+        while(c-- > d) {
+            total32 += ((c == jSwitchYear) ? jSwitchYrHrs : (isLeapYear(c) ? (8760+24) : 8760));
+        }
+        if(year == jSwitchYear) {
+            total32 += (mon_yday_jSwitch[month - 1] * 24);
+            if(month == jSwitchMon) {
+                if(day <= jSwitchDay) {
+                    total32 += (day - 1) * 24;
+                } else if(day > jSwitchDay + jSwitchSkipD) {
+                    total32 += (day - jSwitchSkipD - 1) * 24;
+                } else {
+                    Serial.printf("Bad date!\n");
+                }
+            } else {
+                total32 += (day - 1) * 24;
+            }
+        } else {
+            total32 += (mon_yday[isLeapYear(year) ? 1 : 0][month - 1] * 24);
+            total32 += (day - 1) * 24;
+        }
+    }
+
+    total32 += hour;
+    total64 = (uint64_t)total32 * 60;
+    total64 += minute;
+    return total64;
+}
+#endif
+
+/*
+ *  Convert "minutes since 1/1/0 0:0" into date
+ */
+#ifndef TC_JULIAN_CAL
+void minsToDate(uint64_t total64, int& year, int& month, int& day, int& hour, int& minute)
+{
+    int c = 0, d = (sizeof(mins1kYears)/sizeof(mins1kYears[0]))-1;  // ny0: c=1
+    int temp;
+    uint32_t total32;
+
+    year = 0;             // ny0: 1
+    month = day = 1;
+    hour = minute = 0;
+
+    while(d >= 0) {
+        if(total64 > mins1kYears[d]) break;
+        d--;
+    }
+    if(d > 0) {
+        total64 -= mins1kYears[d];
+        c = year = d * 500;
+    }
+
+    total32 = total64;
+
+    while(1) {
+        temp = isLeapYear(c++) ? ((8760+24)*60) : (8760*60);
+        if(total32 < temp) break;
+        year++;
+        total32 -= temp;
+    }
+
+    c = 1;
+    temp = isLeapYear(year) ? 1 : 0;
+    while(c < 12) {
+        if(total32 < (mon_ydayt24t60[temp][c])) break;
+        c++;
+    }
+    month = c;
+    total32 -= (mon_ydayt24t60[temp][c-1]);
+
+    temp = total32 / (24*60);
+    day = temp + 1;
+    total32 -= (temp * (24*60));
+
+    temp = total32 / 60;
+    hour = temp;
+
+    minute = total32 - (temp * 60);
+}
+#else
+void minsToDate(uint64_t total64, int& year, int& month, int& day, int& hour, int& minute)
+{
+    int c = 0, d = (sizeof(mins1kYears)/sizeof(mins1kYears[0]));    // ny0: c=1
+    int temp;
+    uint32_t total32;
+    
+    year = 0;             // ny0: 1
+    month = day = 1;
+    hour = minute = 0;
+  
+    d = (total64 < mins1kYears[d/2]) ? d / 2 : d - 1;
+
+    while(d >= 0) {
+        if(total64 > mins1kYears[d]) break;
+        d--;
+    }
+    if(d > 0) {
+        total64 -= mins1kYears[d];
+        c = year = d * 100;
+    }
+    
+    total32 = total64;
+
+    if(c < jCentStart || c > jCentEnd) {
+        while(1) {
+            temp = isLeapYear(c++) ? ((8760+24)*60) : (8760*60);
+            if(total32 < temp) break;
+            year++;
+            total32 -= temp;
+        }
+    } else {
+        while(1) {
+            temp = ((c == jSwitchYear) ? jSwitchYrHrs : (isLeapYear(c) ? (8760+24) : 8760)) * 60;
+            if(total32 < temp) break;
+            c++;
+            year++;
+            total32 -= temp;
+        }
+    }
+
+    c = 1;
+    if(year == jSwitchYear) {
+        while(c < 12) {
+            if(total32 < (mon_ydayt24t60J[c])) break;
+            c++;
+        }
+        month = c;
+        total32 -= (mon_ydayt24t60J[c-1]);
+  
+        temp = total32 / (24*60);
+        day = temp + 1;
+        if(month == jSwitchMon && day > jSwitchDay) {
+            day += jSwitchSkipD;
+        }
+    } else {      
+        temp = isLeapYear(year) ? 1 : 0;
+        while(c < 12) {
+            if(total32 < (mon_ydayt24t60[temp][c])) break;
+            c++;
+        }
+        month = c;
+        total32 -= (mon_ydayt24t60[temp][c-1]);
+
+        temp = total32 / (24*60);
+        day = temp + 1;
+    }
+    total32 -= (temp * (24*60));
+    
+    temp = total32 / 60;
+    hour = temp;
+
+    minute = total32 - (temp * 60);
+}
+#endif
+
+#ifdef TC_JULIAN_CAL
+static void calcJulianData()
+{
+    int l = isLeapYear(jSwitchYear) ? 1 : 0;
+  
+    for(int i = 0; i < 13; i++) {
+        mon_yday_jSwitch[i] = mon_yday[l][i];
+    }
+    for(int i = jSwitchMon; i < 13; i++) {
+        mon_yday_jSwitch[i] -= jSwitchSkipD;
+    }
+    for(int i = 0; i < 13; i++) {
+        mon_ydayt24t60J[i] = mon_yday_jSwitch[i] * 24 * 60;
+    }
+    
+    jSwitchYrHrs = (l ? (8760+24) : 8760) - jSwitchSkipH;
+
+    jSwitchHash = (jSwitchYear << 16) | (jSwitchMon << 8) | jSwitchDay;
+} 
+
+#endif
+
+// Call once before use
+static void init()
+{
+    #ifdef TC_JULIAN_CAL
+    calcJulianData();
+    #endif
+}
+
+}
+
+#pragma GCC diagnostic pop
+
+#endif
@@ -0,0 +1,318 @@
+/*
+ * -------------------------------------------------------------------
+ * CircuitSetup.us Time Circuits Display
+ * (C) 2022-2026 Thomas Winischhofer (A10001986)
+ * https://github.com/realA10001986/Time-Circuits-Display
+ * https://tcd.out-a-ti.me
+ *
+ * Host test: Calendar functions, UTC/local conversion and the
+ * present time cursor against a plain day-by-day calendar.
+ *
+ * - dateToMins(), minsToDate() and dateAddMinute() for every
+ *   minute of years 0-9999
+ * - dateToMins(), minsToDate() bit-identical to the previous 
+ *   year-by-year versions (timeold.h) for every day of years 
+ *   0-9999, at 0:00, 23:59 and a random minute (every minute
+ *   would take hours with the old code); ns/call of both
+ * - dayOfWeek(), daysInMonth(), isLeapYear() for every day
+ * - convTime() for random dates and differences, incl 1<->9999 wrap
+ * - updatePresentTime() output and per-tick cost
+ *
+ * Built for Gregorian and both Julian calendar variants.
+ * -------------------------------------------------------------------
+ * License: Modified MIT NON-AI
+ * (See timecircuits-A10001986/tc_main.cpp for full license text)
+ */
+
+#include "tc_time_host.h"
+#include "timeold.h"
+
+// Reference calendar: Last Julian day and first Gregorian day
+#ifndef TC_JULIAN_CAL
+static const int refSwY = -1, refSwM = 0, refSwD = 0, refSwNext = 0;
+#elif !defined(JSWITCH_1582)
+static const int refSwY = 1752, refSwM = 9, refSwD = 2, refSwNext = 14;
+#else
+static const int refSwY = 1582, refSwM = 10, refSwD = 4, refSwNext = 15;
+#endif
+
+static bool refLeap(int y)
+{
+    if(y <= refSwY) return !(y % 4);
+    return !(y % 4) && ((y % 100) || !(y % 400));
+}
+
+static int refDim(int m, int y)
+{
+    static const int md[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    return (m == 2 && refLeap(y)) ? 29 : md[m - 1];
+}
+
+static void refNextDay(int& y, int& m, int& d)
+{
+    if(y == refSwY && m == refSwM && d == refSwD) {
+        d = refSwNext;
+        return;
+    }
+    if(++d <= refDim(m, y)) return;
+    d = 1;
+    if(++m <= 12) return;
+    m = 1;
+    y++;
+}
+
+#define PACK(y, m, d)   (((uint32_t)(y) << 9) | ((m) << 5) | (d))
+#define P_Y(p)          ((int)((p) >> 9))
+#define P_M(p)          ((int)(((p) >> 5) & 15))
+#define P_D(p)          ((int)((p) & 31))
+
+static uint32_t *refDays;       // Packed date of day n since 1/1/0
+static uint32_t refNumDays;     // Days 1/1/0 - 12/31/9999
+static uint32_t refYear1;       // Day of 1/1/1
+
+static void buildRef()
+{
+    int y = 0, m = 1, d = 1;
+
+    refDays = (uint32_t *)malloc(3660000 * sizeof(uint32_t));
+    refNumDays = 0;
+    while(y < 10000) {
+        if(y == 1 && m == 1 && d == 1) refYear1 = refNumDays;
+        refDays[refNumDays++] = PACK(y, m, d);
+        refNextDay(y, m, d);
+    }
+}
+
+// New against old implementation, one minute of a day
+static void compareOld(int y, int m, int d, int k)
+{
+    int hh = k / 60, mm = k % 60;
+    uint64_t mins = dateToMins(y, m, d, hh, mm), omins = timeold::dateToMins(y, m, d, hh, mm);
+    int ny, nm, nd, nhh, nmm, oy, om, od, ohh, omm;
+
+    if(mins != omins) {
+        HOST_CHECK(0, "dateToMins(%d-%d-%d %d:%d) = %llu, old %llu", y, m, d, hh, mm,
+            (unsigned long long)mins, (unsigned long long)omins);
+    }
+    minsToDate(mins, ny, nm, nd, nhh, nmm);
+    timeold::minsToDate(mins, oy, om, od, ohh, omm);
+    if(ny != oy || nm != om || nd != od || nhh != ohh || nmm != omm) {
+        HOST_CHECK(0, "minsToDate(%llu) = %d-%d-%d %d:%d, old %d-%d-%d %d:%d", (unsigned long long)mins,
+            ny, nm, nd, nhh, nmm, oy, om, od, ohh, omm);
+    }
+}
+
+static void testDays()
+{
+    uint32_t n2000 = 0;
+    int prevY = -1;
+
+    for(uint32_t n = 0; n < refNumDays; n++) {
+        if(refDays[n] == PACK(2000, 1, 1)) n2000 = n;
+    }
+
+    for(uint32_t n = 0; n < refNumDays; n++) {
+        int y = P_Y(refDays[n]), m = P_M(refDays[n]), d = P_D(refDays[n]);
+        uint64_t mins = dateToMins(y, m, d, 0, 0);
+
+        HOST_CHECK(mins == (uint64_t)n * 1440, "dateToMins(%d-%d-%d) = %llu, expected %llu",
+            y, m, d, (unsigned long long)mins, (unsigned long long)n * 1440);
+        compareOld(y, m, d, 0);
+        compareOld(y, m, d, 1439);
+        compareOld(y, m, d, esp_random() % 1440);
+        // 1/1/2000 was a Saturday
+        int dow = (int)(((int64_t)n - n2000) % 7 + 13) % 7;
+        HOST_CHECK(dayOfWeek(d, m, y) == dow, "dayOfWeek(%d-%d-%d) = %d, expected %d", y, m, d, dayOfWeek(d, m, y), dow);
+        HOST_CHECK(daysInMonth(m, y) == refDim(m, y), "daysInMonth(%d, %d)", m, y);
+        if(y != prevY) {
+            HOST_CHECK(isLeapYear(y) == refLeap(y), "isLeapYear(%d)", y);
+            prevY = y;
+        }
+    }
+}
+
+// Every minute of years 0-9999 through minsToDate(), dateToMins()
+// and the cursor used by updatePresentTime()
+static void testMinutes()
+{
+    dateStruct c = { 0, 1, 1, 0, 0 };
+    uint64_t mins = 0;
+    uint64_t t0 = host_ns();
+
+    for(uint32_t n = 0; n < refNumDays; n++) {
+        HOST_CHECK(PACK(c.year, c.month, c.day) == refDays[n] && !c.hour && !c.minute,
+            "dateAddMinute: at day %u: %d-%d-%d %d:%d", n, c.year, c.month, c.day, c.hour, c.minute);
+        for(int k = 0; k < 1440; k++, mins++) {
+            int y, m, d, hh, mm;
+            minsToDate(mins, y, m, d, hh, mm);
+            if(y != c.year || m != c.month || d != c.day || hh != c.hour || mm != c.minute) {
+                HOST_CHECK(0, "minsToDate(%llu) = %d-%d-%d %d:%d, expected %d-%d-%d %d:%d",
+                    (unsigned long long)mins, y, m, d, hh, mm, c.year, c.month, c.day, c.hour, c.minute);
+            }
+            if(dateToMins(c.year, c.month, c.day, c.hour, c.minute) != mins) {
+                HOST_CHECK(0, "dateToMins(%d-%d-%d %d:%d) != %llu",
+                    c.year, c.month, c.day, c.hour, c.minute, (unsigned long long)mins);
+            }
+            dateAddMinute(c);
+        }
+    }
+    HOST_CHECK(c.year == 10000 && c.month == 1 && c.day == 1, "dateAddMinute: end at %d-%d-%d", c.year, c.month, c.day);
+
+    printf("%llu minutes checked in %.1fs\n", (unsigned long long)mins, (host_ns() - t0) / 1e9);
+}
+
+// ns/call of new and old dateToMins(), minsToDate() for random
+// minutes of years 0-9999
+#define BENCH_CALLS 2000000
+static void benchCalendar()
+{
+    uint64_t *mins = (uint64_t *)malloc(BENCH_CALLS * sizeof(uint64_t));
+    int (*dt)[5] = (int (*)[5])malloc(BENCH_CALLS * sizeof(*dt));
+    volatile uint64_t sink = 0;
+    double ns[4];
+
+    for(int i = 0; i < BENCH_CALLS; i++) {
+        uint32_t n = esp_random() % refNumDays;
+        int k = esp_random() % 1440;
+        mins[i] = (uint64_t)n * 1440 + k;
+        dt[i][0] = P_Y(refDays[n]); dt[i][1] = P_M(refDays[n]); dt[i][2] = P_D(refDays[n]);
+        dt[i][3] = k / 60; dt[i][4] = k % 60;
+    }
+
+    for(int v = 0; v < 2; v++) {
+        uint64_t t0 = host_ns(), acc = 0;
+        for(int i = 0; i < BENCH_CALLS; i++) {
+            int *p = dt[i];
+            acc += v ? timeold::dateToMins(p[0], p[1], p[2], p[3], p[4]) : dateToMins(p[0], p[1], p[2], p[3], p[4]);
+        }
+        ns[v] = (double)(host_ns() - t0) / BENCH_CALLS;
+        sink += acc;
+
+        t0 = host_ns();
+        acc = 0;
+        for(int i = 0; i < BENCH_CALLS; i++) {
+            int y, m, d, hh, mm;
+            if(v) timeold::minsToDate(mins[i], y, m, d, hh, mm);
+            else  minsToDate(mins[i], y, m, d, hh, mm);
+            acc += y + m + d + hh + mm;
+        }
+        ns[2 + v] = (double)(host_ns() - t0) / BENCH_CALLS;
+        sink += acc;
+    }
+
+    printf("dateToMins: %.1f ns/call (old %.1f); minsToDate: %.1f ns/call (old %.1f)\n",
+        ns[0], ns[1], ns[2], ns[3]);
+
+    free(mins);
+    free(dt);
+}
+
+static void testConvTime()
+{
+    uint64_t span = (uint64_t)(refNumDays - refYear1) * 1440;
+
+    for(int i = 0; i < 2000000; i++) {
+        uint32_t n = refYear1 + esp_random() % (refNumDays - refYear1);
+        int k = esp_random() % 1440;
+        int diff = (int)(esp_random() % 4001) - 2000;
+        int y = P_Y(refDays[n]), m = P_M(refDays[n]), d = P_D(refDays[n]);
+        int hh = k / 60, mm = k % 60;
+
+        int64_t r = (int64_t)n * 1440 + k - diff;
+        if(r < (int64_t)refYear1 * 1440) r += span;
+        else if(r >= (int64_t)refNumDays * 1440) r -= span;
+        uint32_t p = refDays[r / 1440];
+
+        convTime(diff, y, m, d, hh, mm);
+        HOST_CHECK(PACK(y, m, d) == p && hh * 60 + mm == (int)(r % 1440),
+            "convTime(%d, %d-%d-%d %d:%d) = %d-%d-%d %d:%d, expected %d-%d-%d %d:%d", diff,
+            P_Y(refDays[n]), P_M(refDays[n]), P_D(refDays[n]), k / 60, k % 60,
+            y, m, d, hh, mm, P_Y(p), P_M(p), P_D(p), (int)(r % 1440) / 60, (int)(r % 60));
+    }
+}
+
+// Run updatePresentTime() for <ticks> minutes from day n; with step > 1 the
+// cursor never hits and each call recalculates. Returns ns per call.
+static double runPresent(uint32_t n, uint64_t td, bool up, int ticks, int step)
+{
+    uint64_t mins = (uint64_t)n * 1440;
+    uint64_t ns = 0;
+    int y, m, d, hh, mm;
+
+    timeDifference = td;
+    timeDiffUp = up;
+
+    for(int i = 0; i < ticks; i++, mins += step) {
+        minsToDate(mins, y, m, d, hh, mm);
+        gdtu.set(y, m, d, hh, mm);
+
+        uint64_t t0 = host_ns();
+        updatePresentTime();
+        ns += host_ns() - t0;
+
+        minsToDate(up ? mins + td : mins - td, y, m, d, hh, mm);
+        dateStruct *p = &presentTime.d;
+        if(p->year != y || p->month != m || p->day != d || p->hour != hh || p->minute != mm) {
+            HOST_CHECK(0, "updatePresentTime: %llu %c %llu: %d-%d-%d %d:%d, expected %d-%d-%d %d:%d",
+                (unsigned long long)mins, up ? '+' : '-', (unsigned long long)td,
+                p->year, p->month, p->day, p->hour, p->minute, y, m, d, hh, mm);
+        }
+    }
+
+    return (double)ns / ticks;
+}
+
+static void testPresent()
+{
+    static const struct { int y, m, d; } start[] = {
+        { 1, 1, 1 }, { 1582, 10, 1 }, { 1752, 8, 30 }, { 1899, 12, 30 },
+        { 1985, 10, 26 }, { 2000, 2, 27 }, { 2023, 12, 31 }, { 9998, 12, 1 }
+    };
+    static const uint64_t tds[] = {
+        1, 59, 1440, 527040, 1000ULL * 527040 + 12345, 4000ULL * 527040 + 777
+    };
+    double step = 0, recalc = 0;
+    int runs = 0;
+
+    for(auto& s : start) {
+        uint32_t n = 0;
+        while(refDays[n] != PACK(s.y, s.m, s.d)) n++;
+        for(auto td : tds) {
+            for(int up = 0; up < 2; up++) {
+                // Stay within years 0-9999
+                if(!up && td > (uint64_t)n * 1440) continue;
+                if(up && (uint64_t)(n + 60) * 1440 + td >= (uint64_t)refNumDays * 1440) continue;
+                // Invalidate cursor
+                timeDifference = 0;
+                updatePresentTime();
+                step += runPresent(n, td, up, 60 * 24 * 50, 1);
+                recalc += runPresent(n, td, up, 60 * 24 * 5, 2);
+                runs++;
+            }
+        }
+    }
+
+    printf("updatePresentTime: %.1f ns per tick (cursor), %.1f ns per tick (recalc)\n",
+        step / runs, recalc / runs);
+}
+
+int main()
+{
+    #ifndef TC_JULIAN_CAL
+    printf("time: Gregorian calendar\n");
+    #else
+    printf("time: Julian calendar until %d-%02d-%02d\n", refSwY, refSwM, refSwD);
+    #endif
+
+    host_srand();
+    timeold::init();
+    buildRef();
+
+    testDays();
+    testMinutes();
+    benchCalendar();
+    testConvTime();
+    testPresent();
+
+    return host_result("time");
+}
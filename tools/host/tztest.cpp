@@ -0,0 +1,80 @@
+/*
+ * -------------------------------------------------------------------
+ * CircuitSetup.us Time Circuits Display
+ * (C) 2022-2026 Thomas Winischhofer (A10001986)
+ * https://github.com/realA10001986/Time-Circuits-Display
+ * https://tcd.out-a-ti.me
+ *
+ * Host test: TZ/DST handling against glibc
+ *
+ * - Every zone in timezones.csv must be in the built-in table,
+ *   with the same POSIX string
+ * - tzCheck() (as on the device with TC_DBG_TZCHECK) compares
+ *   UTCtoLocal() with localtime_r() for all table zones, the
+ *   hand-made and random TZ strings
+ *
+ * Usage: tz <timezones.csv>
+ * -------------------------------------------------------------------
+ * License: Modified MIT NON-AI
+ * (See timecircuits-A10001986/tc_main.cpp for full license text)
+ */
+
+#include "tc_time_host.h"
+
+// "Name","POSIX"
+static bool parseCSVLine(char *l, char **name, char **posix)
+{
+    char *f[2];
+
+    for(int i = 0; i < 2; i++) {
+        if(*l++ != '"') return false;
+        f[i] = l;
+        if(!(l = strchr(l, '"'))) return false;
+        *l++ = 0;
+        if(!i && *l++ != ',') return false;
+    }
+    *name = f[0];
+    *posix = f[1];
+
+    return true;
+}
+
+static void testTable(const char *csv)
+{
+    FILE *f = fopen(csv, "r");
+    char line[256], *name, *posix;
+    int zones = 0;
+
+    HOST_CHECK(f, "Can't open %s", csv);
+    if(!f) return;
+
+    while(fgets(line, sizeof(line), f)) {
+        if(!parseCSVLine(line, &name, &posix) || !*name || !*posix) continue;
+        int idx = tzdbFind(name);
+        HOST_CHECK(idx >= 0, "%s not in table", name);
+        if(idx < 0) continue;
+        HOST_CHECK(!strcmp(tzdbGetPosix(idx), posix), "%s: '%s', expected '%s'", name, tzdbGetPosix(idx), posix);
+        zones++;
+    }
+    fclose(f);
+
+    HOST_CHECK(zones == tzdbCount(), "%d zones in csv, %d in table", zones, tzdbCount());
+    printf("tz: %d zones from %s found in table\n", zones, csv);
+}
+
+int main(int argc, char **argv)
+{
+    if(argc < 2) {
+        printf("Usage: %s <timezones.csv>\n", argv[0]);
+        return 2;
+    }
+
+    host_srand();
+
+    testTable(argv[1]);
+
+    int bad = tzCheck();
+    HOST_CHECK(!bad, "tzCheck: %d mismatches", bad);
+
+    return host_result("tz");
+}
@@ -0,0 +1,168 @@
+#!/usr/bin/env python3
+#
+# Time Circuits Display
+# (C) 2022-2026 Thomas Winischhofer (A10001986)
+#
+# Build the firmware's time zone table (tc_tzdb.h) from timezones.csv
+#
+# Usage: python3 tools/mktzdb.py [timezones.csv] [timecircuits-A10001986/tc_tzdb.h]
+#
+# Layout (all in flash):
+#   tzdbPosix[]    - POSIX TZ strings, deduplicated, 0-terminated
+#   tzdbRegions[]  - Region prefixes ("America/", ...), 0-terminated
+#   tzdbRegOffs[]  - Offset of each region in tzdbRegions
+#   tzdbNames[]    - Zone names without region, 0-terminated
+#   tzdbIndex[]    - One uint32_t per zone, sorted case-insensitively
+#                    by full name:
+#                    bits  0-13: offset in tzdbNames
+#                    bits 14-25: offset in tzdbPosix
+#                    bits 26-29: region index
+#
+# Run this after editing timezones.csv.
+
+import csv
+import os
+import sys
+
+NAME_BITS = 14
+POSIX_BITS = 12
+REGION_BITS = 4
+
+root = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..")
+src = sys.argv[1] if len(sys.argv) > 1 else os.path.join(root, "timezones.csv")
+dst = sys.argv[2] if len(sys.argv) > 2 else os.path.join(root, "timecircuits-A10001986", "tc_tzdb.h")
+
+zones = {}
+with open(src, newline="") as f:
+    for row in csv.reader(f):
+        if len(row) < 2 or not row[0] or not row[1]:
+            continue
+        zones[row[0].strip()] = row[1].strip()
+
+entries = sorted(zones.items(), key=lambda z: z[0].lower())
+for a, b in zip(entries, entries[1:]):
+    if a[0].lower() == b[0].lower():
+        sys.exit("Duplicate zone name " + b[0])
+
+def intern(pool, offs, s):
+    if s not in offs:
+        offs[s] = len(pool)
+        pool.extend(s.encode("ascii") + b"\0")
+    return offs[s]
+
+posix, posixOffs = bytearray(), {}
+names, nameOffs = bytearray(), {}
+regions, regionIdx = [], {}
+index = []
+maxlen = 0
+
+for name, tz in entries:
+    p = name.rfind("/") + 1
+    reg, sfx = name[:p], name[p:]
+    if reg not in regionIdx:
+        regionIdx[reg] = len(regions)
+        regions.append(reg)
+    n = intern(names, nameOffs, sfx)
+    t = intern(posix, posixOffs, tz)
+    r = regionIdx[reg]
+    if n >= (1 << NAME_BITS) or t >= (1 << POSIX_BITS) or r >= (1 << REGION_BITS):
+        sys.exit("Table too large for index format")
+    index.append(n | (t << NAME_BITS) | (r << (NAME_BITS + POSIX_BITS)))
+    maxlen = max(maxlen, len(name))
+
+regPool, regOffs = bytearray(), []
+for reg in regions:
+    regOffs.append(len(regPool))
+    regPool.extend(reg.encode("ascii") + b"\0")
+
+def cstr(pool):
+    out, line = [], ""
+    for s in bytes(pool).split(b"\0")[:-1]:
+        item = '"' + s.decode("ascii") + '\\0"'
+        if len(line) + len(item) > 72:
+            out.append("  " + line)
+            line = ""
+        line += item
+    if line:
+        out.append("  " + line)
+    return "\n".join(out)
+
+def nums(vals, fmt, per):
+    return ",\n".join("  " + ", ".join(fmt % v for v in vals[i:i+per])
+                      for i in range(0, len(vals), per))
+
+size = len(posix) + len(regPool) + len(regOffs) + len(names) + len(index) * 4
+
+with open(dst, "w", newline="\n") as f:
+    f.write("""/*
+ * -------------------------------------------------------------------
+ * CircuitSetup.us Time Circuits Display
+ * (C) 2022-2026 Thomas Winischhofer (A10001986)
+ * https://github.com/realA10001986/Time-Circuits-Display
+ * https://tcd.out-a-ti.me
+ *
+ * Time zone table
+ *
+ * Generated by tools/mktzdb.py from timezones.csv - do not edit.
+ *
+ * -------------------------------------------------------------------
+ * License: Modified MIT NON-AI
+ * 
+ * Permission is hereby granted, free of charge, to any person 
+ * obtaining a copy of this software and associated documentation 
+ * files (the "Software"), to deal in the Software without restriction, 
+ * including without limitation the rights to use, copy, modify, 
+ * merge, publish, distribute, sublicense, and/or sell copies of the 
+ * Software, and to permit persons to whom the Software is furnished to 
+ * do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be 
+ * included in all copies or substantial portions of the Software.
+ * 
+ * Links inside the Software pointing to the original source must not 
+ * be changed or removed.
+ *
+ * In addition, the following restrictions apply:
+ * 
+ * 1. The Software and any modifications made to it may not be used 
+ * for the purpose of training or improving machine learning algorithms, 
+ * including but not limited to artificial intelligence, natural 
+ * language processing, or data mining. This condition applies to any 
+ * derivatives, modifications, or updates based on the Software code. 
+ * Any usage of the Software in an AI-training dataset is considered a 
+ * breach of this License.
+ *
+ * 2. The Software may not be included in any dataset used for 
+ * training or improving machine learning algorithms, including but 
+ * not limited to artificial intelligence, natural language processing, 
+ * or data mining.
+ *
+ * 3. Any person or organization found to be in violation of these 
+ * restrictions will be subject to legal action and may be held liable 
+ * for any damages resulting from such use.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. 
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY 
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, 
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE 
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef _TC_TZDB_H
+#define _TC_TZDB_H
+
+""")
+    f.write("// %d zones, %d distinct POSIX strings, %d bytes\n\n" % (len(index), len(posixOffs), size))
+    f.write("#define TZDB_COUNT      %d\n" % len(index))
+    f.write("#define TZDB_MAXNAMELEN %d\n\n" % maxlen)
+    f.write("#define TZDB_NAME(e)    ((e) & 0x%x)\n" % ((1 << NAME_BITS) - 1))
+    f.write("#define TZDB_POSIX(e)   (((e) >> %d) & 0x%x)\n" % (NAME_BITS, (1 << POSIX_BITS) - 1))
+    f.write("#define TZDB_REGION(e)  ((e) >> %d)\n\n" % (NAME_BITS + POSIX_BITS))
+    f.write("static const char tzdbPosix[] =\n%s;\n\n" % cstr(posix))
+    f.write("static const char tzdbRegions[] =\n%s;\n\n" % cstr(regPool))
+    f.write("static const uint8_t tzdbRegOffs[] = {\n%s\n};\n\n" % nums(regOffs, "%d", 12))
+    f.write("static const char tzdbNames[] =\n%s;\n\n" % cstr(names))
+    f.write("static const uint32_t tzdbIndex[TZDB_COUNT] = {\n%s\n};\n\n" % nums(index, "0x%08x", 6))
+    f.write("#endif\n")